@@ -1,4 +1,4 @@
-require("premake", ">=5.0.0-alpha10")
+require("premake", ">=5.0.0-alpha16")
 
 workspace ("DestroyerOfWorlds")
 
@@ -48,6 +48,7 @@ workspace ("DestroyerOfWorlds")
         project ("Tests")
             kind ("ConsoleApp")
             language ("C++")
+            cppdialect ("C++20")
             
 			
             includedirs
@@ -73,6 +74,89 @@ workspace ("DestroyerOfWorlds")
             }
           
 			
+            filter { "architecture:*86" }
+                libdirs { "lib/x32" }
+                targetdir ("bin/x32")
+
+            filter { "architecture:*64" }
+                libdirs { "lib/x64" }
+                targetdir ("bin/x64")
+
+        project ("LogDecoder")
+            kind ("ConsoleApp")
+            language ("C++")
+
+            includedirs
+            {
+                "../Code/core/include/"
+            }
+
+            files
+            {
+                "../Code/tools/src/LogDecoder.cpp",
+            }
+
+            links
+            {
+                "Core"
+            }
+
+            filter { "architecture:*86" }
+                libdirs { "lib/x32" }
+                targetdir ("bin/x32")
+
+            filter { "architecture:*64" }
+                libdirs { "lib/x64" }
+                targetdir ("bin/x64")
+
+        project ("StatisticsMonitor")
+            kind ("ConsoleApp")
+            language ("C++")
+
+            includedirs
+            {
+                "../Code/network/include/",
+                "../Code/core/include/"
+            }
+
+            files
+            {
+                "../Code/tools/src/StatisticsMonitor.cpp",
+            }
+
+            links
+            {
+                "Network",
+                "Core"
+            }
+
+            filter { "architecture:*86" }
+                libdirs { "lib/x32" }
+                targetdir ("bin/x32")
+
+            filter { "architecture:*64" }
+                libdirs { "lib/x64" }
+                targetdir ("bin/x64")
+
+        project ("AllocationReplay")
+            kind ("ConsoleApp")
+            language ("C++")
+
+            includedirs
+            {
+                "../Code/core/include/"
+            }
+
+            files
+            {
+                "../Code/tools/src/AllocationReplay.cpp",
+            }
+
+            links
+            {
+                "Core"
+            }
+
             filter { "architecture:*86" }
                 libdirs { "lib/x32" }
                 targetdir ("bin/x32")
@@ -85,6 +169,8 @@ workspace ("DestroyerOfWorlds")
         project ("Network")
             kind ("StaticLib")
             language ("C++")
+            -- The coroutine API in Async.h is only compiled with C++20
+            cppdialect ("C++20")
 
             includedirs
             {
@@ -1,17 +1,17 @@
-#pragma once
-
-#include "StandardAllocator.h"
-
-class BoundedAllocator : public StandardAllocator
-{
-public:
-
-    BoundedAllocator(size_t aMaximumAllocationSize);
-
-    virtual void* Allocate(size_t aSize) override;
-    virtual void Free(void* apData) override;
-
-private:
-
-    size_t m_availableMemory;
+#pragma once
+
+#include "StandardAllocator.h"
+
+class BoundedAllocator : public StandardAllocator
+{
+public:
+
+    BoundedAllocator(size_t aMaximumAllocationSize);
+
+    virtual void* Allocate(size_t aSize) override;
+    virtual void Free(void* apData) override;
+
+private:
+
+    size_t m_availableMemory;
 };
\ No newline at end of file
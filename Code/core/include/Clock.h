@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+
+// Monotonic nanosecond clock. Reads the TSC when it is invariant and falls back to steady_clock otherwise.
+// Tick samples the clock once per frame so that hot paths can read GetNow without touching the hardware.
+class Clock
+{
+public:
+
+    static uint64_t GetTimestamp();
+
+    static uint64_t Tick();
+    static uint64_t GetNow();
+
+    static bool IsUsingTsc();
+
+    static constexpr uint64_t Microseconds(uint64_t aValue) { return aValue * 1000; }
+    static constexpr uint64_t Milliseconds(uint64_t aValue) { return aValue * 1000 * 1000; }
+    static constexpr uint64_t Seconds(uint64_t aValue) { return aValue * 1000 * 1000 * 1000; }
+};
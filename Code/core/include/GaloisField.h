@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+// Arithmetic in GF(2^8) with the 0x11D polynomial, the bulk operation picks the widest shuffle based kernel the CPU supports.
+class GaloisField
+{
+public:
+
+    enum Kernel
+    {
+        kScalar,
+        kSsse3,
+        kAvx2
+    };
+
+    static uint8_t Multiply(uint8_t aLhs, uint8_t aRhs);
+    static uint8_t Divide(uint8_t aLhs, uint8_t aRhs);
+    // 0 has no inverse, 0 is returned
+    static uint8_t Inverse(uint8_t aValue);
+
+    // apDestination[i] ^= aFactor * apSource[i]
+    static void MultiplyAdd(uint8_t* apDestination, const uint8_t* apSource, uint8_t aFactor, size_t aLength);
+    static void MultiplyAdd(uint8_t* apDestination, const uint8_t* apSource, uint8_t aFactor, size_t aLength, Kernel aKernel);
+
+    static Kernel GetBestKernel();
+};
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+// Log-linear histogram of durations, every power of two is split in SubBuckets so the relative error stays
+// under 1 / SubBuckets. Recording is a few instructions and never allocates.
+class Histogram
+{
+public:
+
+    static constexpr size_t SubBucketBits = 3;
+    static constexpr size_t SubBuckets = size_t(1) << SubBucketBits;
+    static constexpr size_t BucketCount = (64 - SubBucketBits + 1) * SubBuckets;
+
+    Histogram();
+
+    void Record(uint64_t aValue);
+    void Reset();
+
+    uint64_t GetCount() const;
+    uint64_t GetMin() const;
+    uint64_t GetMax() const;
+    uint64_t GetMean() const;
+    // Upper bound of the bucket holding the given percentile, from 0 to 100
+    uint64_t GetPercentile(double aPercentile) const;
+
+private:
+
+    static size_t GetBucket(uint64_t aValue);
+    static uint64_t GetUpperBound(size_t aBucket);
+
+    uint64_t m_buckets[BucketCount];
+    uint64_t m_count;
+    uint64_t m_sum;
+    uint64_t m_min;
+    uint64_t m_max;
+};
\ No newline at end of file
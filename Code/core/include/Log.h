@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstring>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include "Meta.h"
+
+// Asynchronous binary logger. Call sites push a format id and raw arguments in a per thread ring,
+// a background thread writes them to disk and the format strings are only rendered by the decoder.
+class Log
+{
+public:
+
+    enum Level : uint8_t
+    {
+        kDebug,
+        kInfo,
+        kWarning,
+        kError,
+        kCount
+    };
+
+    static bool Start(const std::string& acPath);
+    static void Stop();
+    static bool IsEnabled();
+
+    // Called once per call site
+    static uint32_t Register(Level aLevel, const char* acpFile, uint32_t aLine, const char* acpFormat);
+
+    template<class... Args>
+    static void Write(uint32_t aId, Args... aArgs);
+
+    // Records lost because a thread's ring was full
+    static uint64_t GetDroppedCount();
+
+    // Renders a printf style format string with raw arguments, %s is not supported
+    static std::string Format(const char* acpFormat, const uint64_t* acpArguments, size_t aCount);
+    // Turns a binary log back into text
+    static bool Decode(const std::string& acPath, std::ostream& aOutput);
+
+    static constexpr size_t MaxArguments = 8;
+
+private:
+
+    static void Push(uint32_t aId, const uint64_t* acpArguments, size_t aCount);
+};
+
+namespace details
+{
+    template<class T>
+    uint64_t ToLogArgument(T aValue)
+    {
+        static_assert(std::is_arithmetic_v<T> || std::is_enum_v<T> || std::is_pointer_v<T>, "Only raw values can be logged");
+
+        if constexpr (std::is_floating_point_v<T>)
+        {
+            double value = aValue;
+            uint64_t result;
+            std::memcpy(&result, &value, sizeof(result));
+            return result;
+        }
+        else if constexpr (std::is_pointer_v<T>)
+            return (uint64_t)(uintptr_t)aValue;
+        else if constexpr (std::is_signed_v<T>)
+            return (uint64_t)(int64_t)aValue;
+        else
+            return (uint64_t)aValue;
+    }
+}
+
+template<class... Args>
+void Log::Write(uint32_t aId, Args... aArgs)
+{
+    static_assert(sizeof...(Args) <= MaxArguments, "Too many arguments");
+
+    const uint64_t arguments[] = { 0, details::ToLogArgument(aArgs)... };
+    Push(aId, arguments + 1, sizeof...(Args));
+}
+
+#define LOG_AT(level, format, ...) \
+    do \
+    { \
+        if (Log::IsEnabled()) \
+        { \
+            static const uint32_t s_logId = Log::Register(level, __FILE__, __LINE__, format); \
+            Log::Write(s_logId, ##__VA_ARGS__); \
+        } \
+    } while (0)
+
+#define LOG_DEBUG(format, ...) LOG_AT(Log::kDebug, format, ##__VA_ARGS__)
+#define LOG_INFO(format, ...) LOG_AT(Log::kInfo, format, ##__VA_ARGS__)
+#define LOG_WARNING(format, ...) LOG_AT(Log::kWarning, format, ##__VA_ARGS__)
+#define LOG_ERROR(format, ...) LOG_AT(Log::kError, format, ##__VA_ARGS__)
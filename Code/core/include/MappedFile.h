@@ -0,0 +1,40 @@
+#pragma once
+
+#include <string>
+#include "Meta.h"
+
+// File mapped in memory, reads and writes go through the page cache without extra copies
+class MappedFile
+{
+public:
+
+    MappedFile();
+    MappedFile(const MappedFile& acRhs) = delete;
+    ~MappedFile();
+
+    MappedFile& operator=(const MappedFile& acRhs) = delete;
+
+    bool Open(const std::string& acPath);
+    // Creates or truncates the file to aSize bytes and maps it writable, fails if the disk cannot hold it
+    bool Create(const std::string& acPath, size_t aSize);
+    void Close();
+
+    // Hints the kernel that the mapping will be read front to back
+    void AdviseSequential() const;
+
+    const uint8_t* GetData() const;
+    uint8_t* GetWriteData() const;
+    size_t GetSize() const;
+    bool IsValid() const;
+    bool IsWritable() const;
+
+private:
+
+    uint8_t* m_pData;
+    size_t m_size;
+    bool m_writable;
+#ifdef _WIN32
+    void* m_file;
+    void* m_mapping;
+#endif
+};
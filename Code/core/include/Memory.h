@@ -1,2 +1,336 @@
-#pragma once
-
+#pragma once
+
+#include "Meta.h"
+#include <vector>
+
+// Containers that link objects through a member node instead of allocating, an object can be in as many containers
+// as it has nodes. The containers don't own the objects, an object must leave them before it is destroyed or moved,
+// copies and moves of a node start unlinked.
+
+struct IntrusiveListNode
+{
+    IntrusiveListNode() noexcept = default;
+    IntrusiveListNode(const IntrusiveListNode&) noexcept {}
+    IntrusiveListNode& operator=(const IntrusiveListNode&) noexcept { return *this; }
+    ~IntrusiveListNode() { Unlink(); }
+
+    bool IsLinked() const noexcept { return m_pNext != nullptr; }
+
+    // Removes the object from whichever list holds it
+    void Unlink() noexcept
+    {
+        if (!IsLinked())
+            return;
+
+        m_pPrevious->m_pNext = m_pNext;
+        m_pNext->m_pPrevious = m_pPrevious;
+        m_pPrevious = m_pNext = nullptr;
+    }
+
+private:
+
+    template<class T, IntrusiveListNode T::*TNode>
+    friend class IntrusiveList;
+
+    IntrusiveListNode* m_pPrevious{ nullptr };
+    IntrusiveListNode* m_pNext{ nullptr };
+};
+
+// Doubly linked list, every operation but GetCount is O(1)
+template<class T, IntrusiveListNode T::*TNode>
+class IntrusiveList
+{
+public:
+
+    class Iterator
+    {
+    public:
+
+        Iterator(IntrusiveListNode* apNode) : m_pNode(apNode) {}
+
+        T& operator*() const { return *IntrusiveList::ToObject(m_pNode); }
+        T* operator->() const { return IntrusiveList::ToObject(m_pNode); }
+        // The current object can be unlinked once the iterator moved past it
+        Iterator& operator++() { m_pNode = m_pNode->m_pNext; return *this; }
+        bool operator==(const Iterator& acRhs) const { return m_pNode == acRhs.m_pNode; }
+        bool operator!=(const Iterator& acRhs) const { return m_pNode != acRhs.m_pNode; }
+
+    private:
+
+        IntrusiveListNode* m_pNode;
+    };
+
+    IntrusiveList() noexcept
+    {
+        m_head.m_pPrevious = m_head.m_pNext = &m_head;
+    }
+
+    IntrusiveList(const IntrusiveList&) = delete;
+    IntrusiveList& operator=(const IntrusiveList&) = delete;
+
+    ~IntrusiveList()
+    {
+        Clear();
+        m_head.m_pPrevious = m_head.m_pNext = nullptr;
+    }
+
+    bool IsEmpty() const noexcept { return m_head.m_pNext == &m_head; }
+
+    size_t GetCount() const noexcept
+    {
+        size_t count = 0;
+        for (auto* pNode = m_head.m_pNext; pNode != &m_head; pNode = pNode->m_pNext)
+            ++count;
+        return count;
+    }
+
+    T* GetFront() const noexcept { return IsEmpty() ? nullptr : ToObject(m_head.m_pNext); }
+    T* GetBack() const noexcept { return IsEmpty() ? nullptr : ToObject(m_head.m_pPrevious); }
+
+    // Objects already in a list are moved to this one
+    void PushFront(T& aObject) noexcept { InsertAfter(&m_head, &(aObject.*TNode)); }
+    void PushBack(T& aObject) noexcept { InsertAfter(m_head.m_pPrevious, &(aObject.*TNode)); }
+
+    T* PopFront() noexcept
+    {
+        auto* pObject = GetFront();
+        if (pObject)
+            (pObject->*TNode).Unlink();
+        return pObject;
+    }
+
+    T* PopBack() noexcept
+    {
+        auto* pObject = GetBack();
+        if (pObject)
+            (pObject->*TNode).Unlink();
+        return pObject;
+    }
+
+    static void Remove(T& aObject) noexcept { (aObject.*TNode).Unlink(); }
+
+    void Clear() noexcept
+    {
+        while (!IsEmpty())
+            m_head.m_pNext->Unlink();
+    }
+
+    Iterator begin() { return Iterator(m_head.m_pNext); }
+    Iterator end() { return Iterator(&m_head); }
+
+private:
+
+    static T* ToObject(IntrusiveListNode* apNode) noexcept
+    {
+        // Offset of the node in T, computed without an instance
+        const auto offset = reinterpret_cast<size_t>(&(reinterpret_cast<T*>(alignof(T))->*TNode)) - alignof(T);
+        return reinterpret_cast<T*>(reinterpret_cast<uint8_t*>(apNode) - offset);
+    }
+
+    static void InsertAfter(IntrusiveListNode* apPosition, IntrusiveListNode* apNode) noexcept
+    {
+        apNode->Unlink();
+
+        apNode->m_pPrevious = apPosition;
+        apNode->m_pNext = apPosition->m_pNext;
+        apPosition->m_pNext->m_pPrevious = apNode;
+        apPosition->m_pNext = apNode;
+    }
+
+    IntrusiveListNode m_head;
+};
+
+// Last in first out stack threaded through a pointer member, meant for pools of free objects
+template<class T, T* T::*TNext>
+class IntrusiveFreeList
+{
+public:
+
+    IntrusiveFreeList() noexcept = default;
+    IntrusiveFreeList(const IntrusiveFreeList&) = delete;
+    IntrusiveFreeList& operator=(const IntrusiveFreeList&) = delete;
+
+    bool IsEmpty() const noexcept { return m_pHead == nullptr; }
+    size_t GetCount() const noexcept { return m_count; }
+
+    void Push(T& aObject) noexcept
+    {
+        aObject.*TNext = m_pHead;
+        m_pHead = &aObject;
+        ++m_count;
+    }
+
+    T* Pop() noexcept
+    {
+        auto* pObject = m_pHead;
+        if (pObject)
+        {
+            m_pHead = pObject->*TNext;
+            pObject->*TNext = nullptr;
+            --m_count;
+        }
+        return pObject;
+    }
+
+    void Clear() noexcept
+    {
+        while (Pop()) {}
+    }
+
+private:
+
+    T* m_pHead{ nullptr };
+    size_t m_count{ 0 };
+};
+
+struct IntrusiveHeapNode
+{
+    static constexpr size_t Unlinked = SIZE_MAX;
+
+    IntrusiveHeapNode() noexcept = default;
+    IntrusiveHeapNode(const IntrusiveHeapNode&) noexcept {}
+    IntrusiveHeapNode& operator=(const IntrusiveHeapNode&) noexcept { return *this; }
+
+    bool IsLinked() const noexcept { return m_index != Unlinked; }
+
+private:
+
+    template<class T, IntrusiveHeapNode T::*TNode, class TLess>
+    friend class IntrusiveHeap;
+
+    size_t m_index{ Unlinked };
+};
+
+// Binary min heap of pointers, the objects remember their position so they can be removed or re-keyed in O(log n).
+// Nothing is allocated once Reserve covered the largest size.
+template<class T, IntrusiveHeapNode T::*TNode, class TLess = std::less<T>>
+class IntrusiveHeap
+{
+public:
+
+    IntrusiveHeap(TLess aLess = TLess()) : m_less(std::move(aLess)) {}
+    IntrusiveHeap(const IntrusiveHeap&) = delete;
+    IntrusiveHeap& operator=(const IntrusiveHeap&) = delete;
+
+    ~IntrusiveHeap() { Clear(); }
+
+    void Reserve(size_t aCount) { m_objects.reserve(aCount); }
+
+    bool IsEmpty() const noexcept { return m_objects.empty(); }
+    size_t GetCount() const noexcept { return m_objects.size(); }
+    T* GetTop() const noexcept { return IsEmpty() ? nullptr : m_objects.front(); }
+
+    // Objects already in the heap are re-keyed
+    void Push(T& aObject)
+    {
+        auto& node = aObject.*TNode;
+        if (node.IsLinked())
+        {
+            Update(aObject);
+            return;
+        }
+
+        node.m_index = m_objects.size();
+        m_objects.push_back(&aObject);
+        SiftUp(node.m_index);
+    }
+
+    T* Pop() noexcept
+    {
+        auto* pObject = GetTop();
+        if (pObject)
+            Remove(*pObject);
+        return pObject;
+    }
+
+    void Remove(T& aObject) noexcept
+    {
+        auto& node = aObject.*TNode;
+        if (!node.IsLinked())
+            return;
+
+        const auto index = node.m_index;
+        const auto last = m_objects.size() - 1;
+
+        node.m_index = IntrusiveHeapNode::Unlinked;
+
+        if (index != last)
+        {
+            Place(index, m_objects[last]);
+            m_objects.pop_back();
+            Restore(index);
+        }
+        else
+            m_objects.pop_back();
+    }
+
+    // Call after changing the key of an object in the heap
+    void Update(T& aObject) noexcept
+    {
+        if ((aObject.*TNode).IsLinked())
+            Restore((aObject.*TNode).m_index);
+    }
+
+    void Clear() noexcept
+    {
+        for (auto* pObject : m_objects)
+            (pObject->*TNode).m_index = IntrusiveHeapNode::Unlinked;
+        m_objects.clear();
+    }
+
+private:
+
+    void Place(size_t aIndex, T* apObject) noexcept
+    {
+        m_objects[aIndex] = apObject;
+        (apObject->*TNode).m_index = aIndex;
+    }
+
+    void Restore(size_t aIndex) noexcept
+    {
+        if (aIndex > 0 && m_less(*m_objects[aIndex], *m_objects[(aIndex - 1) / 2]))
+            SiftUp(aIndex);
+        else
+            SiftDown(aIndex);
+    }
+
+    void SiftUp(size_t aIndex) noexcept
+    {
+        auto* pObject = m_objects[aIndex];
+        while (aIndex > 0)
+        {
+            const auto parent = (aIndex - 1) / 2;
+            if (!m_less(*pObject, *m_objects[parent]))
+                break;
+
+            Place(aIndex, m_objects[parent]);
+            aIndex = parent;
+        }
+        Place(aIndex, pObject);
+    }
+
+    void SiftDown(size_t aIndex) noexcept
+    {
+        auto* pObject = m_objects[aIndex];
+        const auto count = m_objects.size();
+        for (;;)
+        {
+            auto child = aIndex * 2 + 1;
+            if (child >= count)
+                break;
+
+            if (child + 1 < count && m_less(*m_objects[child + 1], *m_objects[child]))
+                ++child;
+
+            if (!m_less(*m_objects[child], *pObject))
+                break;
+
+            Place(aIndex, m_objects[child]);
+            aIndex = child;
+        }
+        Place(aIndex, pObject);
+    }
+
+    std::vector<T*> m_objects;
+    TLess m_less;
+};
\ No newline at end of file
@@ -1,48 +1,59 @@
-#pragma once
-
-#include <cstdint>
-#include <type_traits>
-#include <utility>
-#include <cstddef>
-#include <functional>
-
-
-using std::size_t;
-
-namespace details
-{
-    template <class Default, class AlwaysVoid,
-        template<class...> class Op, class... Args>
-    struct detector {
-        using value_t = std::false_type;
-        using type = Default;
-    };
-
-    template <class Default, template<class...> class Op, class... Args>
-    struct detector<Default, std::void_t<Op<Args...>>, Op, Args...> {
-        using value_t = std::true_type;
-        using type = Op<Args...>;
-    };
-
-    struct nonesuch {
-
-        ~nonesuch() = delete;
-        nonesuch(nonesuch const&) = delete;
-        void operator=(nonesuch const&) = delete;
-    };
-
-    template <template<class...> class Op, class... Args>
-    using is_detected = typename detector<nonesuch, void, Op, Args...>::value_t;
-
-    template <template<class...> class Op, class... Args>
-    using detected_t = typename detector<nonesuch, void, Op, Args...>::type;
-
-    template< template<class...> class Op, class... Args >
-    constexpr bool is_detected_v = is_detected<Op, Args...>::value;
-}
-
-template<class T>
-void hash_combine(size_t& aSeed, const T& aValue)
-{
-    aSeed ^= std::hash<T>()(aValue) + 0x9e3779b9 + (aSeed << 6) + (aSeed >> 2);
-}
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <cstddef>
+#include <functional>
+
+
+using std::size_t;
+
+namespace details
+{
+    template <class Default, class AlwaysVoid,
+        template<class...> class Op, class... Args>
+    struct detector {
+        using value_t = std::false_type;
+        using type = Default;
+    };
+
+    template <class Default, template<class...> class Op, class... Args>
+    struct detector<Default, std::void_t<Op<Args...>>, Op, Args...> {
+        using value_t = std::true_type;
+        using type = Op<Args...>;
+    };
+
+    struct nonesuch {
+
+        ~nonesuch() = delete;
+        nonesuch(nonesuch const&) = delete;
+        void operator=(nonesuch const&) = delete;
+    };
+
+    template <template<class...> class Op, class... Args>
+    using is_detected = typename detector<nonesuch, void, Op, Args...>::value_t;
+
+    template <template<class...> class Op, class... Args>
+    using detected_t = typename detector<nonesuch, void, Op, Args...>::type;
+
+    template< template<class...> class Op, class... Args >
+    constexpr bool is_detected_v = is_detected<Op, Args...>::value;
+}
+
+template<class T>
+void hash_combine(size_t& aSeed, const T& aValue)
+{
+    aSeed ^= std::hash<T>()(aValue) + 0x9e3779b9 + (aSeed << 6) + (aSeed >> 2);
+}
+
+
+// FNV-1a, usable at compile time
+constexpr uint32_t HashString(const char* apString)
+{
+    uint32_t hash = 2166136261u;
+    for (; *apString; ++apString)
+        hash = (hash ^ uint8_t(*apString)) * 16777619u;
+
+    return hash;
+}
\ No newline at end of file
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "Allocator.h"
+#include <mutex>
+
+// Fixed size blocks carved out of a single slab allocated and touched up front, allocations then never reach the
+// system allocator. Requests larger than a block, or made once every block is taken, go to the fallback allocator
+// and are counted so that a capacity plan can be checked.
+class PoolAllocator : public Allocator
+{
+public:
+
+    PoolAllocator(size_t aBlockSize, size_t aBlockCount, Allocator* apFallback = Allocator::GetDefault());
+    virtual ~PoolAllocator();
+
+    PoolAllocator(const PoolAllocator&) = delete;
+    PoolAllocator& operator=(const PoolAllocator&) = delete;
+
+    virtual void* Allocate(size_t aSize) override;
+    virtual void Free(void* apData) override;
+    virtual size_t Size(void* apData) override;
+    virtual size_t GetUsedMemory() const override;
+
+    size_t GetBlockSize() const;
+    size_t GetBlockCount() const;
+    size_t GetFreeCount() const;
+    size_t GetFallbackCount() const;
+    bool IsValid() const;
+
+private:
+
+    struct FreeBlock
+    {
+        FreeBlock* pNext;
+    };
+
+    bool Owns(void* apData) const;
+
+    Allocator* m_pFallback;
+    size_t m_blockSize;
+    size_t m_blockCount;
+    uint8_t* m_pSlab;
+    FreeBlock* m_pFree;
+    size_t m_freeCount;
+    size_t m_fallbackCount;
+    size_t m_fallbackMemory;
+    mutable std::mutex m_lock;
+};
\ No newline at end of file
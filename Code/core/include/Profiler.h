@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <ostream>
+#include <vector>
+
+// Accumulates wall time per named zone, and on Linux the hardware counters of the threads that opened them. Zones
+// cost a branch while disabled. With counters enabled, entering and leaving a zone each read the counter group with
+// one syscall, so only zones worth well over a microsecond should be measured that way.
+class Profiler
+{
+public:
+
+    enum Counter
+    {
+        kCycles,
+        kInstructions,
+        kCacheMisses,
+        kBranchMisses,
+        kCounterCount
+    };
+
+    struct Zone
+    {
+        const char* Name;
+        uint64_t Calls;
+        // Nanoseconds, nested zones are included in their parent
+        uint64_t Time;
+        // Units of work reported by the zone, packets for the network zones, so costs can be shown per item
+        uint64_t Items;
+        uint64_t Counters[kCounterCount];
+    };
+
+    static constexpr size_t MaxZones = 128;
+
+    static void Enable(bool aEnabled);
+    static bool IsEnabled();
+
+    // Opens the counters for the calling thread, fails without perf_event_open, hardware counters or permission
+    static bool EnableCounters();
+    static void DisableCounters();
+    static bool HasCounters();
+
+    // Called once per call site by PROFILE_ZONE, returns MaxZones once the table is full
+    static uint32_t Register(const char* acpName);
+
+    // Totals over every thread, in registration order
+    static std::vector<Zone> GetZones();
+    static void Reset();
+    // Prints one line per zone with its averages per call and per item
+    static void Print(std::ostream& aOutput);
+
+private:
+
+    friend class ProfileZone;
+
+    static bool ReadCounters(uint64_t* apValues);
+    static void Accumulate(uint32_t aZone, uint64_t aTime, uint64_t aItems, const uint64_t* apCounters);
+};
+
+#define PROFILE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_IMPL(a, b)
+
+// Declares a ProfileZone named variable that measures the rest of the enclosing scope
+#define PROFILE_ZONE(variable, name) \
+    static const uint32_t PROFILE_CONCAT(s_profileZone, __LINE__) = Profiler::Register(name); \
+    ProfileZone variable(PROFILE_CONCAT(s_profileZone, __LINE__))
+
+class ProfileZone
+{
+public:
+
+    ProfileZone(uint32_t aZone);
+    ~ProfileZone();
+
+    ProfileZone(const ProfileZone&) = delete;
+    ProfileZone& operator=(const ProfileZone&) = delete;
+
+    void AddItems(uint64_t aCount);
+
+private:
+
+    uint32_t m_zone;
+    bool m_active;
+    bool m_counting;
+    uint64_t m_items;
+    uint64_t m_start;
+    uint64_t m_counters[Profiler::kCounterCount];
+};
\ No newline at end of file
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+// Process and thread settings for latency sensitive loops
+class Realtime
+{
+public:
+
+    // Restricts the calling thread to a single core
+    static bool PinCurrentThread(uint32_t aCore);
+    static uint32_t GetCoreCount();
+
+    // Keeps every current and future page in RAM, usually needs privileges or a raised memlock limit
+    static bool LockMemory();
+    static void UnlockMemory();
+
+    // Touches aSize bytes of the calling thread's stack so they are mapped before the hot loop needs them
+    static void PrefaultStack(size_t aSize);
+
+    // Hint for spin loops
+    static void Relax();
+};
\ No newline at end of file
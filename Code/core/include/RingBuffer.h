@@ -0,0 +1,74 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include "Meta.h"
+
+// Single producer, single consumer queue of variable sized messages.
+// The ring lives in caller provided memory so it can be placed in a shared memory segment.
+class RingBuffer
+{
+public:
+
+    RingBuffer();
+    // aCapacity must be a power of two, aInitialize is false when attaching to an existing ring
+    RingBuffer(void* apMemory, size_t aCapacity, bool aInitialize);
+
+    // Includes the room to align the header on a cache line, apMemory can have any alignment
+    static size_t GetRequiredSize(size_t aCapacity);
+
+    bool Push(const uint8_t* apData, size_t aLength);
+
+    // Calls aVisitor(const uint8_t*, size_t) with the next message, the data is only valid during the call
+    template<class T>
+    bool Pop(T&& aVisitor);
+
+    bool IsEmpty() const;
+    bool IsValid() const;
+    size_t GetCapacity() const;
+    size_t GetUsedSize() const;
+
+private:
+
+    static constexpr uint32_t kPadding = 0xFFFFFFFF;
+
+    struct Header
+    {
+        alignas(64) std::atomic<uint64_t> Head;
+        alignas(64) std::atomic<uint64_t> Tail;
+        alignas(64) uint64_t Capacity;
+    };
+
+    static size_t GetRecordSize(size_t aLength);
+
+    Header* m_pHeader;
+    uint8_t* m_pData;
+    uint64_t m_mask;
+};
+
+template<class T>
+bool RingBuffer::Pop(T&& aVisitor)
+{
+    auto tail = m_pHeader->Tail.load(std::memory_order_relaxed);
+    const auto head = m_pHeader->Head.load(std::memory_order_acquire);
+
+    if (tail == head)
+        return false;
+
+    auto offset = tail & m_mask;
+    auto length = *(const uint32_t*)(m_pData + offset);
+
+    // The producer skipped the end of the ring
+    if (length == kPadding)
+    {
+        tail += m_pHeader->Capacity - offset;
+        offset = 0;
+        length = *(const uint32_t*)m_pData;
+    }
+
+    aVisitor((const uint8_t*)(m_pData + offset + sizeof(uint32_t)), (size_t)length);
+
+    m_pHeader->Tail.store(tail + GetRecordSize(length), std::memory_order_release);
+
+    return true;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <string>
+#include "Meta.h"
+
+// Named memory segment that can be mapped by several processes
+class SharedMemory
+{
+public:
+
+    SharedMemory();
+    SharedMemory(const SharedMemory& acRhs) = delete;
+    ~SharedMemory();
+
+    SharedMemory& operator=(const SharedMemory& acRhs) = delete;
+
+    // The creator owns the name and removes it on destruction
+    bool Create(const std::string& acName, size_t aSize);
+    bool Open(const std::string& acName, bool aReadOnly = false);
+
+    void* GetData() const;
+    size_t GetSize() const;
+    bool IsValid() const;
+
+private:
+
+    void Close();
+
+    void* m_pData;
+    size_t m_size;
+    std::string m_name;
+    bool m_owner;
+#ifdef _WIN32
+    void* m_handle;
+#endif
+};
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "Allocator.h"
+#include <new>
+
+// Lets standard containers allocate through an Allocator, a null allocator means the default one
+template<class T>
+struct StlAllocator
+{
+    using value_type = T;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    StlAllocator(Allocator* apAllocator = nullptr) noexcept : pAllocator(apAllocator) {}
+
+    template<class U>
+    StlAllocator(const StlAllocator<U>& acRhs) noexcept : pAllocator(acRhs.pAllocator) {}
+
+    T* allocate(size_t aCount)
+    {
+        auto* pData = static_cast<T*>(Get()->Allocate(aCount * sizeof(T)));
+        if (pData == nullptr)
+            throw std::bad_alloc();
+        return pData;
+    }
+
+    void deallocate(T* apData, size_t) noexcept
+    {
+        Get()->Free(apData);
+    }
+
+    Allocator* Get() const noexcept
+    {
+        return pAllocator ? pAllocator : Allocator::GetDefault();
+    }
+
+    template<class U>
+    bool operator==(const StlAllocator<U>& acRhs) const noexcept { return Get() == acRhs.Get(); }
+    template<class U>
+    bool operator!=(const StlAllocator<U>& acRhs) const noexcept { return Get() != acRhs.Get(); }
+
+    Allocator* pAllocator;
+};
\ No newline at end of file
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include "Clock.h"
+
+// Fixed timestep scheduler. Waits are split in a coarse phase, handed to the caller's event loop or an OS sleep,
+// and a short spin to land on the deadline since OS sleeps routinely overshoot by a millisecond or more.
+class TickScheduler
+{
+public:
+
+    struct Stats
+    {
+        uint64_t Ticks{ 0 };
+        // Ticks that were run late, back to back with another one
+        uint64_t CatchUpTicks{ 0 };
+        // Ticks dropped because the scheduler was too far behind
+        uint64_t SkippedTicks{ 0 };
+        uint64_t Samples{ 0 };
+        uint64_t TotalJitter{ 0 };
+        uint64_t MaxJitter{ 0 };
+
+        uint64_t GetAverageJitter() const { return Samples ? TotalJitter / Samples : 0; }
+    };
+
+    TickScheduler(uint32_t aTicksPerSecond, uint32_t aMaxCatchUpTicks = 4);
+
+    // Blocks until the next tick is due and returns the number of ticks to run
+    uint32_t Wait();
+
+    // aIdle(uint64_t aTimeout) waits for at most aTimeout nanoseconds and returns true when it was woken by an event,
+    // Wait then returns 0 so the caller can handle it before waiting again for the same deadline
+    template<class T>
+    uint32_t Wait(T&& aIdle);
+
+    void Reset();
+    void SetSpinThreshold(uint64_t aNanoseconds);
+
+    uint64_t GetPeriod() const;
+    uint64_t GetDeadline() const;
+    const Stats& GetStats() const;
+    void ResetStats();
+
+private:
+
+    uint32_t Spin();
+
+    uint64_t m_period;
+    uint64_t m_deadline;
+    uint64_t m_spinThreshold;
+    uint32_t m_maxCatchUpTicks;
+    Stats m_stats;
+};
+
+template<class T>
+uint32_t TickScheduler::Wait(T&& aIdle)
+{
+    for (auto now = Clock::GetTimestamp(); now + m_spinThreshold < m_deadline; now = Clock::GetTimestamp())
+    {
+        if (aIdle(m_deadline - now - m_spinThreshold))
+            return 0;
+    }
+
+    return Spin();
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "Allocator.h"
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Forwards to another allocator and records every call so that a real session can be replayed against other
+// allocators. The bookkeeping uses the global heap, never the allocator stack, so it can be pushed as the default.
+class TraceAllocator : public Allocator
+{
+public:
+
+    enum Operation : uint8_t
+    {
+        kAllocate,
+        kFree,
+        kSize
+    };
+
+    struct Event
+    {
+        // Nanoseconds since the recording started
+        uint64_t Timestamp;
+        // Requested bytes, only set for kAllocate
+        uint64_t Size;
+        // Allocations are numbered from 1 in the order they were made
+        uint32_t Id;
+        // Threads are numbered from 0 in the order they first called the allocator
+        uint32_t Thread;
+        Operation Op;
+    };
+
+    struct ReplayResult
+    {
+        uint64_t Duration{ 0 };
+        size_t Allocations{ 0 };
+        size_t Failures{ 0 };
+        // Highest sum of live bytes as requested by the trace and as reported by the allocator's Size
+        size_t PeakRequested{ 0 };
+        size_t PeakReserved{ 0 };
+    };
+
+    TraceAllocator(Allocator* apAllocator = Allocator::GetDefault());
+    virtual ~TraceAllocator() {}
+
+    TraceAllocator(const TraceAllocator&) = delete;
+    TraceAllocator& operator=(const TraceAllocator&) = delete;
+
+    virtual void* Allocate(size_t aSize) override;
+    // Pointers allocated before the recording started are forwarded but not recorded
+    virtual void Free(void* apData) override;
+    virtual size_t Size(void* apData) override;
+    virtual size_t GetUsedMemory() const override;
+
+    std::vector<Event> GetEvents() const;
+    // Forgets the recorded events, allocations still alive are not tracked anymore
+    void Clear();
+
+    bool Save(const std::string& acPath) const;
+    static bool Load(const std::string& acPath, std::vector<Event>& aEvents);
+
+    // Plays the events in order on the calling thread, whatever the trace leaves alive is freed at the end
+    static ReplayResult Replay(const std::vector<Event>& acEvents, Allocator& aAllocator);
+
+private:
+
+    void Record(Operation aOperation, uint32_t aId, uint64_t aSize);
+
+    Allocator* m_pAllocator;
+    uint64_t m_start;
+    uint32_t m_nextId;
+    std::vector<Event> m_events;
+    std::unordered_map<void*, uint32_t> m_live;
+    std::unordered_map<std::thread::id, uint32_t> m_threads;
+    mutable std::mutex m_lock;
+};
\ No newline at end of file
@@ -0,0 +1,123 @@
+#include "Clock.h"
+
+#include <atomic>
+#include <chrono>
+
+#if defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#define DOW_HAS_TSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#define DOW_HAS_TSC 1
+#else
+#define DOW_HAS_TSC 0
+#endif
+
+namespace
+{
+    uint64_t ReadSteadyClock()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+#if DOW_HAS_TSC
+    bool HasInvariantTsc()
+    {
+        uint32_t registers[4] = {};
+#ifdef _WIN32
+        __cpuid((int*)registers, 0x80000000);
+        if (registers[0] < 0x80000007)
+            return false;
+
+        __cpuid((int*)registers, 0x80000007);
+#else
+        if (__get_cpuid(0x80000000, &registers[0], &registers[1], &registers[2], &registers[3]) == 0 || registers[0] < 0x80000007)
+            return false;
+
+        __get_cpuid(0x80000007, &registers[0], &registers[1], &registers[2], &registers[3]);
+#endif
+        return (registers[3] & (1 << 8)) != 0;
+    }
+#endif
+
+    struct Calibration
+    {
+        Calibration()
+        {
+#if DOW_HAS_TSC
+            if (!HasInvariantTsc())
+                return;
+
+            // Spin for a few milliseconds to measure the TSC frequency against steady_clock
+            const auto startTsc = __rdtsc();
+            const auto start = ReadSteadyClock();
+
+            uint64_t end;
+            do
+            {
+                end = ReadSteadyClock();
+            } while (end - start < Clock::Milliseconds(5));
+
+            const auto endTsc = __rdtsc();
+            if (endTsc <= startTsc)
+                return;
+
+            NanosecondsPerTick = double(end - start) / double(endTsc - startTsc);
+            BaseTsc = endTsc;
+            BaseNanoseconds = end;
+            UseTsc = true;
+#endif
+        }
+
+        uint64_t Read() const
+        {
+#if DOW_HAS_TSC
+            if (UseTsc)
+            {
+                // Cores can disagree by a few ticks, never report a time before the calibration
+                const auto tsc = __rdtsc();
+                return BaseNanoseconds + (tsc > BaseTsc ? uint64_t(double(tsc - BaseTsc) * NanosecondsPerTick) : 0);
+            }
+#endif
+            return ReadSteadyClock();
+        }
+
+        bool UseTsc{ false };
+        double NanosecondsPerTick{ 0.0 };
+        uint64_t BaseTsc{ 0 };
+        uint64_t BaseNanoseconds{ 0 };
+    };
+
+    const Calibration& GetCalibration()
+    {
+        static const Calibration s_calibration;
+        return s_calibration;
+    }
+
+    std::atomic<uint64_t> s_now{ 0 };
+}
+
+uint64_t Clock::GetTimestamp()
+{
+    return GetCalibration().Read();
+}
+
+uint64_t Clock::Tick()
+{
+    const auto now = GetTimestamp();
+    s_now.store(now, std::memory_order_relaxed);
+
+    return now;
+}
+
+uint64_t Clock::GetNow()
+{
+    const auto now = s_now.load(std::memory_order_relaxed);
+    return now != 0 ? now : Tick();
+}
+
+bool Clock::IsUsingTsc()
+{
+    return GetCalibration().UseTsc;
+}
@@ -0,0 +1,214 @@
+#include "GaloisField.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define DOW_HAS_SHUFFLE 1
+#ifdef _MSC_VER
+#include <intrin.h>
+#define DOW_TARGET(x)
+#else
+#define DOW_TARGET(x) __attribute__((target(x)))
+#endif
+#else
+#define DOW_HAS_SHUFFLE 0
+#endif
+
+namespace
+{
+    struct Tables
+    {
+        Tables()
+        {
+            uint32_t value = 1;
+            for (uint32_t i = 0; i < 255; ++i)
+            {
+                Exp[i] = Exp[i + 255] = (uint8_t)value;
+                Log[value] = (uint8_t)i;
+
+                value <<= 1;
+                if (value & 0x100)
+                    value ^= 0x11D;
+            }
+
+            Log[0] = 0;
+        }
+
+        uint8_t Exp[510];
+        uint8_t Log[256];
+    };
+
+    const Tables& GetTables()
+    {
+        static const Tables s_tables;
+        return s_tables;
+    }
+
+    // Products of aFactor with every low nibble and every high nibble, a byte product is the xor of both lookups
+    void BuildNibbleTables(uint8_t aFactor, uint8_t* apLow, uint8_t* apHigh)
+    {
+        for (uint8_t i = 0; i < 16; ++i)
+        {
+            apLow[i] = GaloisField::Multiply(aFactor, i);
+            apHigh[i] = GaloisField::Multiply(aFactor, (uint8_t)(i << 4));
+        }
+    }
+
+    void MultiplyAddScalar(uint8_t* apDestination, const uint8_t* apSource, uint8_t aFactor, size_t aLength)
+    {
+        uint8_t low[16], high[16];
+        BuildNibbleTables(aFactor, low, high);
+
+        for (size_t i = 0; i < aLength; ++i)
+            apDestination[i] ^= low[apSource[i] & 0xF] ^ high[apSource[i] >> 4];
+    }
+
+#if DOW_HAS_SHUFFLE
+    DOW_TARGET("ssse3")
+    void MultiplyAddSsse3(uint8_t* apDestination, const uint8_t* apSource, uint8_t aFactor, size_t aLength)
+    {
+        alignas(16) uint8_t low[16], high[16];
+        BuildNibbleTables(aFactor, low, high);
+
+        const auto lowTable = _mm_load_si128((const __m128i*)low);
+        const auto highTable = _mm_load_si128((const __m128i*)high);
+        const auto mask = _mm_set1_epi8(0x0F);
+
+        size_t i = 0;
+        for (; i + 16 <= aLength; i += 16)
+        {
+            const auto source = _mm_loadu_si128((const __m128i*)(apSource + i));
+            const auto lowProduct = _mm_shuffle_epi8(lowTable, _mm_and_si128(source, mask));
+            const auto highProduct = _mm_shuffle_epi8(highTable, _mm_and_si128(_mm_srli_epi64(source, 4), mask));
+
+            auto destination = _mm_loadu_si128((const __m128i*)(apDestination + i));
+            destination = _mm_xor_si128(destination, _mm_xor_si128(lowProduct, highProduct));
+            _mm_storeu_si128((__m128i*)(apDestination + i), destination);
+        }
+
+        for (; i < aLength; ++i)
+            apDestination[i] ^= low[apSource[i] & 0xF] ^ high[apSource[i] >> 4];
+    }
+
+    DOW_TARGET("avx2")
+    void MultiplyAddAvx2(uint8_t* apDestination, const uint8_t* apSource, uint8_t aFactor, size_t aLength)
+    {
+        alignas(16) uint8_t low[16], high[16];
+        BuildNibbleTables(aFactor, low, high);
+
+        // vpshufb works on each 128 bit lane separately so the tables are duplicated
+        const auto lowTable = _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i*)low));
+        const auto highTable = _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i*)high));
+        const auto mask = _mm256_set1_epi8(0x0F);
+
+        size_t i = 0;
+        for (; i + 32 <= aLength; i += 32)
+        {
+            const auto source = _mm256_loadu_si256((const __m256i*)(apSource + i));
+            const auto lowProduct = _mm256_shuffle_epi8(lowTable, _mm256_and_si256(source, mask));
+            const auto highProduct = _mm256_shuffle_epi8(highTable, _mm256_and_si256(_mm256_srli_epi64(source, 4), mask));
+
+            auto destination = _mm256_loadu_si256((const __m256i*)(apDestination + i));
+            destination = _mm256_xor_si256(destination, _mm256_xor_si256(lowProduct, highProduct));
+            _mm256_storeu_si256((__m256i*)(apDestination + i), destination);
+        }
+
+        for (; i < aLength; ++i)
+            apDestination[i] ^= low[apSource[i] & 0xF] ^ high[apSource[i] >> 4];
+    }
+
+    GaloisField::Kernel DetectKernel()
+    {
+#ifdef _MSC_VER
+        int registers[4];
+        __cpuid(registers, 0);
+        const auto maxLeaf = registers[0];
+
+        __cpuid(registers, 1);
+        const bool ssse3 = (registers[2] & (1 << 9)) != 0;
+        const bool osAvx = (registers[2] & (1 << 27)) != 0 && (registers[2] & (1 << 28)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+
+        bool avx2 = false;
+        if (maxLeaf >= 7 && osAvx)
+        {
+            __cpuidex(registers, 7, 0);
+            avx2 = (registers[1] & (1 << 5)) != 0;
+        }
+#else
+        __builtin_cpu_init();
+        const bool ssse3 = __builtin_cpu_supports("ssse3");
+        const bool avx2 = __builtin_cpu_supports("avx2");
+#endif
+
+        if (avx2)
+            return GaloisField::kAvx2;
+        if (ssse3)
+            return GaloisField::kSsse3;
+
+        return GaloisField::kScalar;
+    }
+#endif
+}
+
+uint8_t GaloisField::Multiply(uint8_t aLhs, uint8_t aRhs)
+{
+    if (aLhs == 0 || aRhs == 0)
+        return 0;
+
+    const auto& tables = GetTables();
+    return tables.Exp[tables.Log[aLhs] + tables.Log[aRhs]];
+}
+
+uint8_t GaloisField::Divide(uint8_t aLhs, uint8_t aRhs)
+{
+    if (aLhs == 0 || aRhs == 0)
+        return 0;
+
+    const auto& tables = GetTables();
+    return tables.Exp[tables.Log[aLhs] + 255 - tables.Log[aRhs]];
+}
+
+uint8_t GaloisField::Inverse(uint8_t aValue)
+{
+    return Divide(1, aValue);
+}
+
+void GaloisField::MultiplyAdd(uint8_t* apDestination, const uint8_t* apSource, uint8_t aFactor, size_t aLength)
+{
+    static const auto s_kernel = GetBestKernel();
+
+    MultiplyAdd(apDestination, apSource, aFactor, aLength, s_kernel);
+}
+
+void GaloisField::MultiplyAdd(uint8_t* apDestination, const uint8_t* apSource, uint8_t aFactor, size_t aLength, Kernel aKernel)
+{
+    if (aFactor == 0)
+        return;
+
+    if (aFactor == 1)
+    {
+        for (size_t i = 0; i < aLength; ++i)
+            apDestination[i] ^= apSource[i];
+
+        return;
+    }
+
+#if DOW_HAS_SHUFFLE
+    if (aKernel == kAvx2)
+        return MultiplyAddAvx2(apDestination, apSource, aFactor, aLength);
+    if (aKernel == kSsse3)
+        return MultiplyAddSsse3(apDestination, apSource, aFactor, aLength);
+#else
+    (void)aKernel;
+#endif
+
+    MultiplyAddScalar(apDestination, apSource, aFactor, aLength);
+}
+
+GaloisField::Kernel GaloisField::GetBestKernel()
+{
+#if DOW_HAS_SHUFFLE
+    return DetectKernel();
+#else
+    return kScalar;
+#endif
+}
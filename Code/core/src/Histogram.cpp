@@ -0,0 +1,93 @@
+#include "Histogram.h"
+#include <algorithm>
+#include <cstring>
+
+Histogram::Histogram()
+{
+    Reset();
+}
+
+void Histogram::Record(uint64_t aValue)
+{
+    ++m_buckets[GetBucket(aValue)];
+    ++m_count;
+    m_sum += aValue;
+    m_min = std::min(m_min, aValue);
+    m_max = std::max(m_max, aValue);
+}
+
+void Histogram::Reset()
+{
+    std::memset(m_buckets, 0, sizeof(m_buckets));
+    m_count = 0;
+    m_sum = 0;
+    m_min = UINT64_MAX;
+    m_max = 0;
+}
+
+uint64_t Histogram::GetCount() const
+{
+    return m_count;
+}
+
+uint64_t Histogram::GetMin() const
+{
+    return m_count ? m_min : 0;
+}
+
+uint64_t Histogram::GetMax() const
+{
+    return m_max;
+}
+
+uint64_t Histogram::GetMean() const
+{
+    return m_count ? m_sum / m_count : 0;
+}
+
+uint64_t Histogram::GetPercentile(double aPercentile) const
+{
+    if (m_count == 0)
+        return 0;
+
+    const auto rank = std::max<uint64_t>(1, uint64_t(std::min(aPercentile, 100.0) / 100.0 * m_count + 0.5));
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BucketCount; ++i)
+    {
+        seen += m_buckets[i];
+        if (seen >= rank)
+            return std::min(GetUpperBound(i), m_max);
+    }
+
+    return m_max;
+}
+
+size_t Histogram::GetBucket(uint64_t aValue)
+{
+    // Values below SubBuckets get a bucket each, above that the highest bit picks the octave
+    if (aValue < SubBuckets)
+        return (size_t)aValue;
+
+    size_t highest = 63;
+    while (!(aValue >> highest))
+        --highest;
+
+    const auto octave = highest - SubBucketBits + 1;
+    const auto subBucket = (aValue >> (highest - SubBucketBits)) & (SubBuckets - 1);
+
+    return octave * SubBuckets + (size_t)subBucket;
+}
+
+uint64_t Histogram::GetUpperBound(size_t aBucket)
+{
+    if (aBucket < SubBuckets)
+        return aBucket;
+
+    const auto octave = aBucket / SubBuckets;
+    const auto subBucket = aBucket % SubBuckets;
+    const auto shift = octave - 1;
+
+    // Lowest value of the next bucket minus one
+    return ((uint64_t(SubBuckets + subBucket + 1)) << shift) - 1;
+}
\ No newline at end of file
@@ -0,0 +1,462 @@
+#include "Log.h"
+#include "RingBuffer.h"
+#include "Buffer.h"
+#include "Clock.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    static const char s_magic[] = { 'D', 'O', 'W', 'L', 'O', 'G' };
+    static constexpr uint16_t s_version = 1;
+    static constexpr size_t s_ringCapacity = 1 << 16;
+
+    enum RecordType : uint8_t
+    {
+        kDefinition = 'D',
+        kEntry = 'R',
+        kLost = 'L'
+    };
+
+    struct Definition
+    {
+        Log::Level Level;
+        uint32_t Line;
+        std::string File;
+        std::string Format;
+    };
+
+    struct EntryHeader
+    {
+        uint32_t Id;
+        uint32_t Count;
+        uint64_t Timestamp;
+    };
+
+    struct ThreadRing
+    {
+        ThreadRing(uint32_t aIndex)
+            : Memory(RingBuffer::GetRequiredSize(s_ringCapacity))
+            , Ring(Memory.GetWriteData(), s_ringCapacity, true)
+            , Index(aIndex)
+        {}
+
+        Buffer Memory;
+        RingBuffer Ring;
+        // Identifies the ring rather than the thread, a ring is handed to a new thread once its owner exited
+        uint32_t Index;
+        std::atomic<bool> Free{ false };
+    };
+
+    struct LogState
+    {
+        std::atomic<bool> Enabled{ false };
+        std::atomic<bool> Running{ false };
+        std::atomic<uint64_t> Dropped{ 0 };
+
+        std::mutex Lock;
+        std::vector<Definition> Definitions;
+        std::vector<std::unique_ptr<ThreadRing>> Rings;
+
+        std::thread Writer;
+        FILE* pFile{ nullptr };
+    };
+
+    LogState& GetState()
+    {
+        static LogState s_state;
+        return s_state;
+    }
+
+    struct ThreadSlot
+    {
+        ~ThreadSlot()
+        {
+            // The writer keeps draining what is left, the ring is only reused once it is empty
+            if (pRing)
+                pRing->Free.store(true, std::memory_order_release);
+        }
+
+        ThreadRing* pRing{ nullptr };
+    };
+
+    thread_local ThreadSlot s_slot;
+
+    ThreadRing& GetThreadRing(LogState& aState)
+    {
+        if (s_slot.pRing == nullptr)
+        {
+            std::lock_guard<std::mutex> _(aState.Lock);
+
+            // Rings are never destroyed so the writer never races with a thread exit
+            for (auto& pRing : aState.Rings)
+            {
+                if (pRing->Free.load(std::memory_order_acquire) && pRing->Ring.IsEmpty())
+                {
+                    pRing->Free.store(false, std::memory_order_relaxed);
+                    s_slot.pRing = pRing.get();
+                    break;
+                }
+            }
+
+            if (s_slot.pRing == nullptr)
+            {
+                aState.Rings.push_back(std::make_unique<ThreadRing>((uint32_t)aState.Rings.size()));
+                s_slot.pRing = aState.Rings.back().get();
+            }
+        }
+
+        return *s_slot.pRing;
+    }
+
+    template<class T>
+    void WriteValue(FILE* apFile, const T& acValue)
+    {
+        fwrite(&acValue, sizeof(T), 1, apFile);
+    }
+
+    void WriteString(FILE* apFile, const std::string& acValue)
+    {
+        WriteValue(apFile, (uint16_t)acValue.size());
+        fwrite(acValue.data(), 1, acValue.size(), apFile);
+    }
+
+    // Runs on the writer thread only
+    struct Drainer
+    {
+        void Run(LogState& aState)
+        {
+            std::vector<ThreadRing*> rings;
+
+            for (;;)
+            {
+                const bool running = aState.Running.load();
+
+                {
+                    std::lock_guard<std::mutex> _(aState.Lock);
+                    rings.clear();
+                    for (auto& pRing : aState.Rings)
+                        rings.push_back(pRing.get());
+                }
+
+                size_t count = 0;
+                for (auto* pRing : rings)
+                {
+                    while (pRing->Ring.Pop([this, &aState, pRing](const uint8_t* apData, size_t aLength) { WriteEntry(aState, pRing->Index, apData, aLength); }))
+                        ++count;
+                }
+
+                const auto dropped = aState.Dropped.load();
+                if (dropped != m_reportedDrops)
+                {
+                    WriteValue(aState.pFile, kLost);
+                    WriteValue(aState.pFile, dropped);
+                    m_reportedDrops = dropped;
+                }
+
+                // The rings were drained after Running was cleared, nothing can be left behind
+                if (!running)
+                    break;
+
+                if (count == 0)
+                {
+                    fflush(aState.pFile);
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+            }
+
+            fflush(aState.pFile);
+        }
+
+        void WriteEntry(LogState& aState, uint32_t aThread, const uint8_t* apData, size_t aLength)
+        {
+            EntryHeader header;
+            std::memcpy(&header, apData, sizeof(header));
+
+            // Definitions are emitted lazily, right before their first use
+            if (header.Id >= m_writtenDefinitions)
+            {
+                std::lock_guard<std::mutex> _(aState.Lock);
+                for (; m_writtenDefinitions <= header.Id && m_writtenDefinitions < aState.Definitions.size(); ++m_writtenDefinitions)
+                {
+                    auto& definition = aState.Definitions[m_writtenDefinitions];
+
+                    WriteValue(aState.pFile, kDefinition);
+                    WriteValue(aState.pFile, m_writtenDefinitions);
+                    WriteValue(aState.pFile, (uint8_t)definition.Level);
+                    WriteValue(aState.pFile, definition.Line);
+                    WriteString(aState.pFile, definition.File);
+                    WriteString(aState.pFile, definition.Format);
+                }
+            }
+
+            WriteValue(aState.pFile, kEntry);
+            WriteValue(aState.pFile, header.Id);
+            WriteValue(aState.pFile, aThread);
+            WriteValue(aState.pFile, header.Timestamp);
+            WriteValue(aState.pFile, (uint8_t)header.Count);
+            fwrite(apData + sizeof(header), sizeof(uint64_t), header.Count, aState.pFile);
+
+            (void)aLength;
+        }
+
+        uint32_t m_writtenDefinitions{ 0 };
+        uint64_t m_reportedDrops{ 0 };
+    };
+}
+
+bool Log::Start(const std::string& acPath)
+{
+    auto& state = GetState();
+
+    std::lock_guard<std::mutex> _(state.Lock);
+
+    if (state.Running)
+        return false;
+
+    state.pFile = fopen(acPath.c_str(), "wb");
+    if (state.pFile == nullptr)
+        return false;
+
+    fwrite(s_magic, 1, sizeof(s_magic), state.pFile);
+    WriteValue(state.pFile, s_version);
+
+    state.Dropped = 0;
+    state.Running = true;
+    state.Writer = std::thread([&state]()
+    {
+        Drainer drainer;
+        drainer.Run(state);
+    });
+
+    state.Enabled = true;
+
+    return true;
+}
+
+void Log::Stop()
+{
+    auto& state = GetState();
+
+    state.Enabled = false;
+    state.Running = false;
+
+    if (state.Writer.joinable())
+        state.Writer.join();
+
+    std::lock_guard<std::mutex> _(state.Lock);
+
+    if (state.pFile)
+        fclose(state.pFile);
+
+    state.pFile = nullptr;
+}
+
+bool Log::IsEnabled()
+{
+    return GetState().Enabled.load(std::memory_order_relaxed);
+}
+
+uint32_t Log::Register(Level aLevel, const char* acpFile, uint32_t aLine, const char* acpFormat)
+{
+    auto& state = GetState();
+
+    std::lock_guard<std::mutex> _(state.Lock);
+
+    state.Definitions.push_back(Definition{ aLevel, aLine, acpFile, acpFormat });
+
+    return (uint32_t)state.Definitions.size() - 1;
+}
+
+uint64_t Log::GetDroppedCount()
+{
+    return GetState().Dropped.load();
+}
+
+void Log::Push(uint32_t aId, const uint64_t* acpArguments, size_t aCount)
+{
+    auto& state = GetState();
+
+    auto& ring = GetThreadRing(state);
+
+    uint8_t record[sizeof(EntryHeader) + MaxArguments * sizeof(uint64_t)];
+
+    EntryHeader header;
+    header.Id = aId;
+    header.Count = (uint32_t)aCount;
+    header.Timestamp = Clock::GetTimestamp();
+
+    std::memcpy(record, &header, sizeof(header));
+    std::memcpy(record + sizeof(header), acpArguments, aCount * sizeof(uint64_t));
+
+    if (!ring.Ring.Push(record, sizeof(header) + aCount * sizeof(uint64_t)))
+        state.Dropped.fetch_add(1, std::memory_order_relaxed);
+}
+
+std::string Log::Format(const char* acpFormat, const uint64_t* acpArguments, size_t aCount)
+{
+    std::string result;
+    size_t argument = 0;
+
+    for (auto* pCursor = acpFormat; *pCursor; ++pCursor)
+    {
+        if (*pCursor != '%')
+        {
+            result += *pCursor;
+            continue;
+        }
+
+        if (pCursor[1] == '%')
+        {
+            result += '%';
+            ++pCursor;
+            continue;
+        }
+
+        // Keep flags, width and precision, the length modifiers are replaced by the ones matching 64 bit values
+        std::string specifier = "%";
+        auto* pSpec = pCursor + 1;
+        while (*pSpec && std::strchr("-+ #0123456789.", *pSpec))
+            specifier += *pSpec++;
+        while (*pSpec && std::strchr("hljztL", *pSpec))
+            ++pSpec;
+
+        if (*pSpec == '\0')
+            break;
+
+        const char conversion = *pSpec;
+        pCursor = pSpec;
+
+        if (argument >= aCount)
+        {
+            result += "<missing>";
+            continue;
+        }
+
+        const auto value = acpArguments[argument++];
+        char output[128];
+
+        switch (conversion)
+        {
+        case 'd': case 'i':
+            snprintf(output, sizeof(output), (specifier + "lld").c_str(), (long long)value);
+            break;
+        case 'u': case 'x': case 'X': case 'o':
+            snprintf(output, sizeof(output), (specifier + "ll" + conversion).c_str(), (unsigned long long)value);
+            break;
+        case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+        {
+            double floating;
+            std::memcpy(&floating, &value, sizeof(floating));
+            snprintf(output, sizeof(output), (specifier + conversion).c_str(), floating);
+            break;
+        }
+        case 'c':
+            snprintf(output, sizeof(output), (specifier + 'c').c_str(), (int)value);
+            break;
+        case 'p':
+            snprintf(output, sizeof(output), "0x%llx", (unsigned long long)value);
+            break;
+        default:
+            snprintf(output, sizeof(output), "<%c?>", conversion);
+            break;
+        }
+
+        result += output;
+    }
+
+    return result;
+}
+
+bool Log::Decode(const std::string& acPath, std::ostream& aOutput)
+{
+    std::ifstream input(acPath, std::ios::binary);
+    if (!input)
+        return false;
+
+    char magic[sizeof(s_magic)];
+    uint16_t version = 0;
+    input.read(magic, sizeof(magic));
+    input.read((char*)&version, sizeof(version));
+
+    if (!input || std::memcmp(magic, s_magic, sizeof(magic)) != 0 || version != s_version)
+        return false;
+
+    auto read = [&input](auto& aValue) { input.read((char*)&aValue, sizeof(aValue)); return (bool)input; };
+    auto readString = [&input, &read](std::string& aValue)
+    {
+        uint16_t length = 0;
+        if (!read(length))
+            return false;
+
+        aValue.resize(length);
+        input.read(&aValue[0], length);
+        return (bool)input;
+    };
+
+    static const char* s_levels[] = { "DEBUG", "INFO", "WARNING", "ERROR" };
+
+    std::vector<Definition> definitions;
+    uint8_t type;
+
+    while (read(type))
+    {
+        if (type == kDefinition)
+        {
+            uint32_t id, line;
+            uint8_t level;
+            Definition definition;
+
+            if (!read(id) || !read(level) || !read(line) || !readString(definition.File) || !readString(definition.Format) || level >= kCount)
+                return false;
+
+            definition.Level = (Level)level;
+            definition.Line = line;
+
+            if (definitions.size() <= id)
+                definitions.resize(id + 1);
+
+            definitions[id] = std::move(definition);
+        }
+        else if (type == kEntry)
+        {
+            uint32_t id, thread;
+            uint64_t timestamp;
+            uint8_t count;
+            uint64_t arguments[MaxArguments];
+
+            if (!read(id) || !read(thread) || !read(timestamp) || !read(count) || count > MaxArguments)
+                return false;
+
+            input.read((char*)arguments, count * sizeof(uint64_t));
+            if (!input || id >= definitions.size())
+                return false;
+
+            auto& definition = definitions[id];
+
+            aOutput << timestamp << " [" << s_levels[definition.Level] << "] " << definition.File << ":" << definition.Line
+                << " (" << thread << ") " << Format(definition.Format.c_str(), arguments, count) << "\n";
+        }
+        else if (type == kLost)
+        {
+            uint64_t dropped;
+            if (!read(dropped))
+                return false;
+
+            aOutput << dropped << " records lost so far\n";
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
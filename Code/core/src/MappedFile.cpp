@@ -0,0 +1,204 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#include <Windows.h>
+#elif __linux__
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+
+MappedFile::MappedFile()
+    : m_pData(nullptr)
+    , m_size(0)
+    , m_writable(false)
+#ifdef _WIN32
+    , m_file(nullptr)
+    , m_mapping(nullptr)
+#endif
+{
+
+}
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+bool MappedFile::Open(const std::string& acPath)
+{
+    Close();
+
+#ifdef _WIN32
+    m_file = CreateFileA(acPath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (m_file == INVALID_HANDLE_VALUE)
+    {
+        m_file = nullptr;
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(m_file, &size) || size.QuadPart == 0)
+    {
+        Close();
+        return false;
+    }
+
+    m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (m_mapping == nullptr)
+    {
+        Close();
+        return false;
+    }
+
+    m_pData = (uint8_t*)MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+    if (m_pData == nullptr)
+    {
+        Close();
+        return false;
+    }
+
+    m_size = (size_t)size.QuadPart;
+#elif __linux__
+    auto fd = open(acPath.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0)
+    {
+        close(fd);
+        return false;
+    }
+
+    auto* pData = mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (pData == MAP_FAILED)
+        return false;
+
+    m_pData = (uint8_t*)pData;
+    m_size = info.st_size;
+#else
+    static_assert(false, "Not implemented");
+#endif
+
+    return true;
+}
+
+bool MappedFile::Create(const std::string& acPath, size_t aSize)
+{
+    Close();
+
+    if (aSize == 0)
+        return false;
+
+#ifdef _WIN32
+    m_file = CreateFileA(acPath.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (m_file == INVALID_HANDLE_VALUE)
+    {
+        m_file = nullptr;
+        return false;
+    }
+
+    m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READWRITE, (DWORD)((uint64_t)aSize >> 32), (DWORD)(aSize & 0xFFFFFFFF), nullptr);
+    if (m_mapping == nullptr)
+    {
+        Close();
+        return false;
+    }
+
+    m_pData = (uint8_t*)MapViewOfFile(m_mapping, FILE_MAP_ALL_ACCESS, 0, 0, aSize);
+    if (m_pData == nullptr)
+    {
+        Close();
+        return false;
+    }
+#elif __linux__
+    auto fd = open(acPath.c_str(), O_CREAT | O_RDWR | O_TRUNC, 0644);
+    if (fd < 0)
+        return false;
+
+    // Reserve the blocks now, a sparse file would only run out of space on a page fault and raise SIGBUS
+    if (posix_fallocate(fd, 0, (off_t)aSize) != 0)
+    {
+        close(fd);
+        unlink(acPath.c_str());
+        return false;
+    }
+
+    auto* pData = mmap(nullptr, aSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (pData == MAP_FAILED)
+        return false;
+
+    m_pData = (uint8_t*)pData;
+#else
+    static_assert(false, "Not implemented");
+#endif
+
+    m_size = aSize;
+    m_writable = true;
+
+    return true;
+}
+
+void MappedFile::Close()
+{
+#ifdef _WIN32
+    if (m_pData)
+        UnmapViewOfFile(m_pData);
+
+    if (m_mapping)
+        CloseHandle(m_mapping);
+
+    if (m_file)
+        CloseHandle(m_file);
+
+    m_mapping = nullptr;
+    m_file = nullptr;
+#elif __linux__
+    if (m_pData)
+        munmap(m_pData, m_size);
+#endif
+
+    m_pData = nullptr;
+    m_size = 0;
+    m_writable = false;
+}
+
+void MappedFile::AdviseSequential() const
+{
+#ifdef __linux__
+    if (m_pData)
+        madvise(m_pData, m_size, MADV_SEQUENTIAL);
+#endif
+}
+
+const uint8_t* MappedFile::GetData() const
+{
+    return m_pData;
+}
+
+uint8_t* MappedFile::GetWriteData() const
+{
+    return m_writable ? m_pData : nullptr;
+}
+
+size_t MappedFile::GetSize() const
+{
+    return m_size;
+}
+
+bool MappedFile::IsValid() const
+{
+    return m_pData != nullptr;
+}
+
+bool MappedFile::IsWritable() const
+{
+    return m_writable;
+}
@@ -0,0 +1,137 @@
+#include "PoolAllocator.h"
+#include <algorithm>
+#include <cstring>
+
+PoolAllocator::PoolAllocator(size_t aBlockSize, size_t aBlockCount, Allocator* apFallback)
+    : m_pFallback(apFallback)
+    , m_blockSize((std::max(aBlockSize, sizeof(FreeBlock)) + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1))
+    , m_blockCount(aBlockCount)
+    , m_pSlab(nullptr)
+    , m_pFree(nullptr)
+    , m_freeCount(0)
+    , m_fallbackCount(0)
+    , m_fallbackMemory(0)
+{
+    if (m_blockCount == 0)
+        return;
+
+    m_pSlab = static_cast<uint8_t*>(m_pFallback->Allocate(m_blockSize * m_blockCount));
+    if (m_pSlab == nullptr)
+    {
+        m_blockCount = 0;
+        return;
+    }
+
+    // Writing every page now keeps page faults out of the first allocations
+    std::memset(m_pSlab, 0, m_blockSize * m_blockCount);
+
+    // Linked in address order so consecutive allocations are adjacent
+    for (size_t i = m_blockCount; i > 0; --i)
+    {
+        auto* pBlock = reinterpret_cast<FreeBlock*>(m_pSlab + (i - 1) * m_blockSize);
+        pBlock->pNext = m_pFree;
+        m_pFree = pBlock;
+    }
+
+    m_freeCount = m_blockCount;
+}
+
+PoolAllocator::~PoolAllocator()
+{
+    m_pFallback->Free(m_pSlab);
+}
+
+void* PoolAllocator::Allocate(size_t aSize)
+{
+    {
+        std::lock_guard<std::mutex> _(m_lock);
+
+        if (aSize <= m_blockSize && m_pFree)
+        {
+            auto* pBlock = m_pFree;
+            m_pFree = pBlock->pNext;
+            --m_freeCount;
+
+            return pBlock;
+        }
+
+        ++m_fallbackCount;
+    }
+
+    auto* pData = m_pFallback->Allocate(aSize);
+    if (pData)
+    {
+        std::lock_guard<std::mutex> _(m_lock);
+        m_fallbackMemory += m_pFallback->Size(pData);
+    }
+
+    return pData;
+}
+
+void PoolAllocator::Free(void* apData)
+{
+    if (apData == nullptr)
+        return;
+
+    if (!Owns(apData))
+    {
+        {
+            std::lock_guard<std::mutex> _(m_lock);
+            m_fallbackMemory -= m_pFallback->Size(apData);
+        }
+
+        m_pFallback->Free(apData);
+        return;
+    }
+
+    std::lock_guard<std::mutex> _(m_lock);
+
+    auto* pBlock = static_cast<FreeBlock*>(apData);
+    pBlock->pNext = m_pFree;
+    m_pFree = pBlock;
+    ++m_freeCount;
+}
+
+size_t PoolAllocator::Size(void* apData)
+{
+    return Owns(apData) ? m_blockSize : m_pFallback->Size(apData);
+}
+
+size_t PoolAllocator::GetUsedMemory() const
+{
+    std::lock_guard<std::mutex> _(m_lock);
+    return (m_blockCount - m_freeCount) * m_blockSize + m_fallbackMemory;
+}
+
+size_t PoolAllocator::GetBlockSize() const
+{
+    return m_blockSize;
+}
+
+size_t PoolAllocator::GetBlockCount() const
+{
+    return m_blockCount;
+}
+
+size_t PoolAllocator::GetFreeCount() const
+{
+    std::lock_guard<std::mutex> _(m_lock);
+    return m_freeCount;
+}
+
+size_t PoolAllocator::GetFallbackCount() const
+{
+    std::lock_guard<std::mutex> _(m_lock);
+    return m_fallbackCount;
+}
+
+bool PoolAllocator::IsValid() const
+{
+    return m_pSlab != nullptr;
+}
+
+bool PoolAllocator::Owns(void* apData) const
+{
+    auto* pData = static_cast<uint8_t*>(apData);
+    return pData >= m_pSlab && pData < m_pSlab + m_blockSize * m_blockCount;
+}
\ No newline at end of file
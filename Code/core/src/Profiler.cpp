@@ -0,0 +1,319 @@
+#include "Profiler.h"
+#include "Clock.h"
+
+#include <atomic>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+
+#ifdef _WIN32
+#elif __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#else
+static_assert(false, "Not implemented");
+#endif
+
+namespace
+{
+    // Written by the owning thread only, relaxed atomics let GetZones read them from another one
+    struct ZoneTotals
+    {
+        std::atomic<uint64_t> Calls{ 0 };
+        std::atomic<uint64_t> Time{ 0 };
+        std::atomic<uint64_t> Items{ 0 };
+        std::atomic<uint64_t> Counters[Profiler::kCounterCount]{};
+    };
+
+    struct ThreadZones
+    {
+        ZoneTotals Zones[Profiler::MaxZones];
+        // Group leader first, -1 while counters are off
+        int Descriptors[Profiler::kCounterCount]{ -1, -1, -1, -1 };
+    };
+
+    struct ProfilerState
+    {
+        std::atomic<bool> Enabled{ false };
+
+        std::mutex Lock;
+        std::vector<const char*> Names;
+        std::vector<std::unique_ptr<ThreadZones>> Threads;
+    };
+
+    ProfilerState& GetState()
+    {
+        static ProfilerState s_state;
+        return s_state;
+    }
+
+    void CloseCounters(ThreadZones& aZones)
+    {
+#ifdef __linux__
+        for (auto& descriptor : aZones.Descriptors)
+        {
+            if (descriptor >= 0)
+                close(descriptor);
+            descriptor = -1;
+        }
+#else
+        (void)aZones;
+#endif
+    }
+
+    // The totals outlive their thread so nothing is lost, the counters are closed with it
+    struct ThreadSlot
+    {
+        ~ThreadSlot()
+        {
+            if (pZones)
+                CloseCounters(*pZones);
+        }
+
+        ThreadZones* pZones{ nullptr };
+    };
+
+    thread_local ThreadSlot s_slot;
+
+    ThreadZones& GetThreadZones()
+    {
+        if (s_slot.pZones == nullptr)
+        {
+            auto& state = GetState();
+            std::lock_guard<std::mutex> _(state.Lock);
+
+            state.Threads.push_back(std::make_unique<ThreadZones>());
+            s_slot.pZones = state.Threads.back().get();
+        }
+
+        return *s_slot.pZones;
+    }
+
+    void Add(std::atomic<uint64_t>& aTotal, uint64_t aValue)
+    {
+        aTotal.store(aTotal.load(std::memory_order_relaxed) + aValue, std::memory_order_relaxed);
+    }
+}
+
+void Profiler::Enable(bool aEnabled)
+{
+    GetState().Enabled = aEnabled;
+}
+
+bool Profiler::IsEnabled()
+{
+    return GetState().Enabled.load(std::memory_order_relaxed);
+}
+
+bool Profiler::EnableCounters()
+{
+#ifdef _WIN32
+    return false;
+#elif __linux__
+    auto& zones = GetThreadZones();
+    if (zones.Descriptors[0] >= 0)
+        return true;
+
+    static const uint64_t s_configs[kCounterCount] =
+    {
+        PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_MISSES,
+        PERF_COUNT_HW_BRANCH_MISSES
+    };
+
+    for (size_t i = 0; i < kCounterCount; ++i)
+    {
+        perf_event_attr attributes;
+        std::memset(&attributes, 0, sizeof(attributes));
+        attributes.type = PERF_TYPE_HARDWARE;
+        attributes.size = sizeof(attributes);
+        attributes.config = s_configs[i];
+        attributes.read_format = PERF_FORMAT_GROUP;
+        attributes.disabled = i == 0;
+        // User space only, allowed with the default perf_event_paranoid
+        attributes.exclude_kernel = 1;
+        attributes.exclude_hv = 1;
+
+        const auto descriptor = (int)syscall(SYS_perf_event_open, &attributes, 0, -1, i == 0 ? -1 : zones.Descriptors[0], 0);
+        if (descriptor < 0)
+        {
+            CloseCounters(zones);
+            return false;
+        }
+
+        zones.Descriptors[i] = descriptor;
+    }
+
+    ioctl(zones.Descriptors[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(zones.Descriptors[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+
+    return true;
+#endif
+}
+
+void Profiler::DisableCounters()
+{
+    if (s_slot.pZones)
+        CloseCounters(*s_slot.pZones);
+}
+
+bool Profiler::HasCounters()
+{
+    return s_slot.pZones && s_slot.pZones->Descriptors[0] >= 0;
+}
+
+uint32_t Profiler::Register(const char* acpName)
+{
+    auto& state = GetState();
+    std::lock_guard<std::mutex> _(state.Lock);
+
+    if (state.Names.size() >= MaxZones)
+        return MaxZones;
+
+    state.Names.push_back(acpName);
+    return (uint32_t)state.Names.size() - 1;
+}
+
+std::vector<Profiler::Zone> Profiler::GetZones()
+{
+    auto& state = GetState();
+    std::lock_guard<std::mutex> _(state.Lock);
+
+    std::vector<Zone> zones(state.Names.size(), Zone{});
+    for (size_t i = 0; i < zones.size(); ++i)
+    {
+        auto& zone = zones[i];
+        zone.Name = state.Names[i];
+
+        for (auto& pThread : state.Threads)
+        {
+            const auto& totals = pThread->Zones[i];
+            zone.Calls += totals.Calls.load(std::memory_order_relaxed);
+            zone.Time += totals.Time.load(std::memory_order_relaxed);
+            zone.Items += totals.Items.load(std::memory_order_relaxed);
+            for (size_t c = 0; c < kCounterCount; ++c)
+                zone.Counters[c] += totals.Counters[c].load(std::memory_order_relaxed);
+        }
+    }
+
+    return zones;
+}
+
+void Profiler::Reset()
+{
+    auto& state = GetState();
+    std::lock_guard<std::mutex> _(state.Lock);
+
+    for (auto& pThread : state.Threads)
+    {
+        for (auto& totals : pThread->Zones)
+        {
+            totals.Calls.store(0, std::memory_order_relaxed);
+            totals.Time.store(0, std::memory_order_relaxed);
+            totals.Items.store(0, std::memory_order_relaxed);
+            for (auto& counter : totals.Counters)
+                counter.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+void Profiler::Print(std::ostream& aOutput)
+{
+    char line[256];
+
+    std::snprintf(line, sizeof(line), "%-32s %10s %12s %10s %12s %12s %8s %12s %12s %12s\n",
+        "zone", "calls", "ns/call", "items", "ns/item", "cycles/item", "ipc", "instr/item", "llc miss/item", "br miss/item");
+    aOutput << line;
+
+    for (auto& zone : GetZones())
+    {
+        if (zone.Calls == 0)
+            continue;
+
+        // Zones that report no items are shown per call
+        const double items = (double)(zone.Items ? zone.Items : zone.Calls);
+        const auto* c = zone.Counters;
+
+        std::snprintf(line, sizeof(line), "%-32s %10" PRIu64 " %12.1f %10" PRIu64 " %12.1f %12.1f %8.2f %12.1f %12.2f %12.2f\n",
+            zone.Name, zone.Calls, (double)zone.Time / zone.Calls, zone.Items, zone.Time / items,
+            c[kCycles] / items, c[kCycles] ? (double)c[kInstructions] / c[kCycles] : 0.0,
+            c[kInstructions] / items, c[kCacheMisses] / items, c[kBranchMisses] / items);
+        aOutput << line;
+    }
+}
+
+bool Profiler::ReadCounters(uint64_t* apValues)
+{
+#ifdef _WIN32
+    (void)apValues;
+    return false;
+#elif __linux__
+    if (!HasCounters())
+        return false;
+
+    // PERF_FORMAT_GROUP layout: the number of events followed by their values in opening order
+    uint64_t data[1 + kCounterCount];
+    if (read(s_slot.pZones->Descriptors[0], data, sizeof(data)) != (ssize_t)sizeof(data) || data[0] != kCounterCount)
+        return false;
+
+    std::memcpy(apValues, data + 1, sizeof(uint64_t) * kCounterCount);
+    return true;
+#endif
+}
+
+void Profiler::Accumulate(uint32_t aZone, uint64_t aTime, uint64_t aItems, const uint64_t* apCounters)
+{
+    auto& totals = GetThreadZones().Zones[aZone];
+
+    Add(totals.Calls, 1);
+    Add(totals.Time, aTime);
+    Add(totals.Items, aItems);
+
+    if (apCounters)
+    {
+        for (size_t i = 0; i < kCounterCount; ++i)
+            Add(totals.Counters[i], apCounters[i]);
+    }
+}
+
+ProfileZone::ProfileZone(uint32_t aZone)
+    : m_zone(aZone)
+    , m_active(aZone < Profiler::MaxZones && Profiler::IsEnabled())
+    , m_counting(false)
+    , m_items(0)
+    , m_start(0)
+{
+    if (!m_active)
+        return;
+
+    m_counting = Profiler::ReadCounters(m_counters);
+    m_start = Clock::GetTimestamp();
+}
+
+ProfileZone::~ProfileZone()
+{
+    if (!m_active)
+        return;
+
+    const auto duration = Clock::GetTimestamp() - m_start;
+
+    uint64_t counters[Profiler::kCounterCount];
+    const bool counting = m_counting && Profiler::ReadCounters(counters);
+    if (counting)
+    {
+        for (size_t i = 0; i < Profiler::kCounterCount; ++i)
+            counters[i] -= m_counters[i];
+    }
+
+    Profiler::Accumulate(m_zone, duration, m_items, counting ? counters : nullptr);
+}
+
+void ProfileZone::AddItems(uint64_t aCount)
+{
+    m_items += aCount;
+}
\ No newline at end of file
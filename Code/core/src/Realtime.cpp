@@ -0,0 +1,81 @@
+#include "Realtime.h"
+#include <algorithm>
+#include <thread>
+
+#ifdef _WIN32
+#include <Windows.h>
+#include <malloc.h>
+#elif __linux__
+#include <alloca.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#include <immintrin.h>
+#endif
+
+bool Realtime::PinCurrentThread(uint32_t aCore)
+{
+    if (aCore >= GetCoreCount())
+        return false;
+
+#ifdef _WIN32
+    return SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << aCore) != 0;
+#elif __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(aCore, &set);
+
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    static_assert(false, "Not implemented");
+#endif
+}
+
+uint32_t Realtime::GetCoreCount()
+{
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+bool Realtime::LockMemory()
+{
+#ifdef _WIN32
+    // Windows only locks explicit ranges, raise the working set so the pages we touch stay resident instead
+    return SetProcessWorkingSetSizeEx(GetCurrentProcess(), 256 << 20, 1024 << 20, QUOTA_LIMITS_HARDWS_MIN_ENABLE) != 0;
+#elif __linux__
+    return mlockall(MCL_CURRENT | MCL_FUTURE) == 0;
+#else
+    static_assert(false, "Not implemented");
+#endif
+}
+
+void Realtime::UnlockMemory()
+{
+#ifdef _WIN32
+    SetProcessWorkingSetSizeEx(GetCurrentProcess(), SIZE_T(-1), SIZE_T(-1), QUOTA_LIMITS_HARDWS_MIN_DISABLE);
+#elif __linux__
+    munlockall();
+#else
+    static_assert(false, "Not implemented");
+#endif
+}
+
+void Realtime::PrefaultStack(size_t aSize)
+{
+    auto* pStack = static_cast<volatile uint8_t*>(alloca(aSize));
+
+    // One write per page is enough
+    for (size_t i = 0; i < aSize; i += 4096)
+        pStack[i] = 0;
+}
+
+void Realtime::Relax()
+{
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+    _mm_pause();
+#else
+    std::this_thread::yield();
+#endif
+}
\ No newline at end of file
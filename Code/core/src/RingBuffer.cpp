@@ -0,0 +1,95 @@
+#include "RingBuffer.h"
+#include <algorithm>
+#include <new>
+
+
+RingBuffer::RingBuffer()
+    : m_pHeader(nullptr)
+    , m_pData(nullptr)
+    , m_mask(0)
+{
+
+}
+
+RingBuffer::RingBuffer(void* apMemory, size_t aCapacity, bool aInitialize)
+    : m_pHeader((Header*)(((uintptr_t)apMemory + alignof(Header) - 1) & ~uintptr_t(alignof(Header) - 1)))
+    , m_pData((uint8_t*)m_pHeader + sizeof(Header))
+    , m_mask(aCapacity - 1)
+{
+    if (aInitialize)
+    {
+        new (m_pHeader) Header;
+        m_pHeader->Head.store(0, std::memory_order_relaxed);
+        m_pHeader->Tail.store(0, std::memory_order_relaxed);
+        m_pHeader->Capacity = aCapacity;
+    }
+    else if (m_pHeader->Capacity != aCapacity)
+    {
+        m_pHeader = nullptr;
+        m_pData = nullptr;
+    }
+}
+
+size_t RingBuffer::GetRequiredSize(size_t aCapacity)
+{
+    return alignof(Header) - 1 + sizeof(Header) + aCapacity;
+}
+
+size_t RingBuffer::GetRecordSize(size_t aLength)
+{
+    // Records stay 8 byte aligned so a length prefix never straddles the end of the ring
+    return (sizeof(uint32_t) + aLength + 7) & ~size_t(7);
+}
+
+bool RingBuffer::Push(const uint8_t* apData, size_t aLength)
+{
+    const auto recordSize = GetRecordSize(aLength);
+    const auto capacity = m_pHeader->Capacity;
+
+    if (recordSize > capacity / 2)
+        return false;
+
+    auto head = m_pHeader->Head.load(std::memory_order_relaxed);
+    const auto tail = m_pHeader->Tail.load(std::memory_order_acquire);
+
+    const auto offset = head & m_mask;
+    const auto contiguous = capacity - offset;
+    const auto required = contiguous < recordSize ? contiguous + recordSize : recordSize;
+
+    if (head + required - tail > capacity)
+        return false;
+
+    if (contiguous < recordSize)
+    {
+        *(uint32_t*)(m_pData + offset) = kPadding;
+        head += contiguous;
+    }
+
+    auto* pRecord = m_pData + (head & m_mask);
+    *(uint32_t*)pRecord = (uint32_t)aLength;
+    std::copy(apData, apData + aLength, pRecord + sizeof(uint32_t));
+
+    m_pHeader->Head.store(head + recordSize, std::memory_order_release);
+
+    return true;
+}
+
+bool RingBuffer::IsEmpty() const
+{
+    return m_pHeader->Head.load(std::memory_order_acquire) == m_pHeader->Tail.load(std::memory_order_acquire);
+}
+
+bool RingBuffer::IsValid() const
+{
+    return m_pHeader != nullptr;
+}
+
+size_t RingBuffer::GetCapacity() const
+{
+    return m_pHeader->Capacity;
+}
+
+size_t RingBuffer::GetUsedSize() const
+{
+    return m_pHeader->Head.load(std::memory_order_acquire) - m_pHeader->Tail.load(std::memory_order_acquire);
+}
@@ -0,0 +1,175 @@
+#include "SharedMemory.h"
+
+#ifdef _WIN32
+#include <Windows.h>
+#elif __linux__
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include <cerrno>
+#include <cstring>
+
+
+SharedMemory::SharedMemory()
+    : m_pData(nullptr)
+    , m_size(0)
+    , m_owner(false)
+#ifdef _WIN32
+    , m_handle(nullptr)
+#endif
+{
+
+}
+
+SharedMemory::~SharedMemory()
+{
+    Close();
+}
+
+bool SharedMemory::Create(const std::string& acName, size_t aSize)
+{
+    Close();
+
+#ifdef _WIN32
+    m_handle = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 
+        (DWORD)((uint64_t)aSize >> 32), (DWORD)(aSize & 0xFFFFFFFF), acName.c_str());
+    if (m_handle == nullptr)
+        return false;
+
+    m_pData = MapViewOfFile(m_handle, FILE_MAP_ALL_ACCESS, 0, 0, aSize);
+    if (m_pData == nullptr)
+    {
+        Close();
+        return false;
+    }
+#elif __linux__
+    // POSIX names must start with a single slash
+    m_name = acName[0] == '/' ? acName : "/" + acName;
+
+    // Never resize a segment another process may still have mapped, a name left by a crashed owner is unlinked
+    // so its readers keep their old mapping and we get a fresh one
+    auto fd = shm_open(m_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0 && errno == EEXIST && shm_unlink(m_name.c_str()) == 0)
+        fd = shm_open(m_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+
+    if (fd < 0)
+        return false;
+
+    m_owner = true;
+
+    if (ftruncate(fd, aSize) != 0)
+    {
+        close(fd);
+        Close();
+        return false;
+    }
+
+    m_pData = mmap(nullptr, aSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (m_pData == MAP_FAILED)
+    {
+        m_pData = nullptr;
+        Close();
+        return false;
+    }
+#else
+    static_assert(false, "Not implemented");
+#endif
+
+    m_size = aSize;
+    std::memset(m_pData, 0, m_size);
+
+    return true;
+}
+
+bool SharedMemory::Open(const std::string& acName, bool aReadOnly)
+{
+    Close();
+
+#ifdef _WIN32
+    m_handle = OpenFileMappingA(aReadOnly ? FILE_MAP_READ : FILE_MAP_ALL_ACCESS, FALSE, acName.c_str());
+    if (m_handle == nullptr)
+        return false;
+
+    m_pData = MapViewOfFile(m_handle, aReadOnly ? FILE_MAP_READ : FILE_MAP_ALL_ACCESS, 0, 0, 0);
+    if (m_pData == nullptr)
+    {
+        Close();
+        return false;
+    }
+
+    MEMORY_BASIC_INFORMATION info;
+    VirtualQuery(m_pData, &info, sizeof(info));
+    m_size = info.RegionSize;
+#elif __linux__
+    m_name = acName[0] == '/' ? acName : "/" + acName;
+
+    auto fd = shm_open(m_name.c_str(), aReadOnly ? O_RDONLY : O_RDWR, 0);
+    if (fd < 0)
+        return false;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0)
+    {
+        close(fd);
+        return false;
+    }
+
+    m_size = info.st_size;
+    m_pData = mmap(nullptr, m_size, aReadOnly ? PROT_READ : PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (m_pData == MAP_FAILED)
+    {
+        m_pData = nullptr;
+        m_size = 0;
+        return false;
+    }
+#else
+    static_assert(false, "Not implemented");
+#endif
+
+    return true;
+}
+
+void* SharedMemory::GetData() const
+{
+    return m_pData;
+}
+
+size_t SharedMemory::GetSize() const
+{
+    return m_size;
+}
+
+bool SharedMemory::IsValid() const
+{
+    return m_pData != nullptr;
+}
+
+void SharedMemory::Close()
+{
+#ifdef _WIN32
+    if (m_pData)
+        UnmapViewOfFile(m_pData);
+
+    if (m_handle)
+        CloseHandle(m_handle);
+
+    m_handle = nullptr;
+#elif __linux__
+    if (m_pData)
+        munmap(m_pData, m_size);
+
+    if (m_owner)
+        shm_unlink(m_name.c_str());
+#endif
+
+    m_pData = nullptr;
+    m_size = 0;
+    m_owner = false;
+}
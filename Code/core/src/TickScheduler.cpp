@@ -0,0 +1,76 @@
+#include "TickScheduler.h"
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+TickScheduler::TickScheduler(uint32_t aTicksPerSecond, uint32_t aMaxCatchUpTicks)
+    : m_period{ Clock::Seconds(1) / std::max(aTicksPerSecond, 1u) }
+    , m_deadline{ 0 }
+    , m_spinThreshold{ Clock::Microseconds(500) }
+    , m_maxCatchUpTicks{ std::max(aMaxCatchUpTicks, 1u) }
+{
+    Reset();
+}
+
+uint32_t TickScheduler::Wait()
+{
+    return Wait([](uint64_t aTimeout)
+    {
+        std::this_thread::sleep_for(std::chrono::nanoseconds(aTimeout));
+        return false;
+    });
+}
+
+void TickScheduler::Reset()
+{
+    m_deadline = Clock::GetTimestamp() + m_period;
+}
+
+void TickScheduler::SetSpinThreshold(uint64_t aNanoseconds)
+{
+    m_spinThreshold = aNanoseconds;
+}
+
+uint64_t TickScheduler::GetPeriod() const
+{
+    return m_period;
+}
+
+uint64_t TickScheduler::GetDeadline() const
+{
+    return m_deadline;
+}
+
+const TickScheduler::Stats& TickScheduler::GetStats() const
+{
+    return m_stats;
+}
+
+void TickScheduler::ResetStats()
+{
+    m_stats = Stats{};
+}
+
+uint32_t TickScheduler::Spin()
+{
+    auto now = Clock::GetTimestamp();
+    while (now < m_deadline)
+        now = Clock::GetTimestamp();
+
+    const auto jitter = now - m_deadline;
+    const auto due = jitter / m_period + 1;
+
+    // Deadlines stay on the original grid, ticks beyond the catch up limit are dropped rather than run in a burst
+    m_deadline += due * m_period;
+
+    const auto ticks = (uint32_t)std::min<uint64_t>(due, m_maxCatchUpTicks);
+
+    m_stats.Ticks += ticks;
+    m_stats.CatchUpTicks += ticks - 1;
+    m_stats.SkippedTicks += due - ticks;
+    m_stats.Samples++;
+    m_stats.TotalJitter += jitter;
+    m_stats.MaxJitter = std::max(m_stats.MaxJitter, jitter);
+
+    return ticks;
+}
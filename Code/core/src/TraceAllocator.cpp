@@ -0,0 +1,272 @@
+#include "TraceAllocator.h"
+#include "Clock.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+namespace
+{
+    static const char s_magic[] = { 'D', 'O', 'W', 'T', 'R', 'C' };
+    static constexpr uint16_t s_version = 1;
+
+    // Events are stored as LEB128 varints with delta encoded timestamps, a few bytes each
+    void WriteVarint(std::vector<uint8_t>& aOutput, uint64_t aValue)
+    {
+        while (aValue >= 0x80)
+        {
+            aOutput.push_back((uint8_t)(aValue | 0x80));
+            aValue >>= 7;
+        }
+        aOutput.push_back((uint8_t)aValue);
+    }
+
+    bool ReadVarint(std::istream& aInput, uint64_t& aValue)
+    {
+        aValue = 0;
+        for (uint32_t shift = 0; shift < 64; shift += 7)
+        {
+            const auto byte = aInput.get();
+            if (byte == std::char_traits<char>::eof())
+                return false;
+
+            aValue |= (uint64_t)(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0)
+                return true;
+        }
+
+        return false;
+    }
+}
+
+TraceAllocator::TraceAllocator(Allocator* apAllocator)
+    : m_pAllocator(apAllocator)
+    , m_start(Clock::GetTimestamp())
+    , m_nextId(1)
+{
+
+}
+
+void* TraceAllocator::Allocate(size_t aSize)
+{
+    auto* pData = m_pAllocator->Allocate(aSize);
+    if (pData == nullptr)
+        return nullptr;
+
+    std::lock_guard<std::mutex> _(m_lock);
+
+    const auto id = m_nextId++;
+    m_live[pData] = id;
+    Record(kAllocate, id, aSize);
+
+    return pData;
+}
+
+void TraceAllocator::Free(void* apData)
+{
+    if (apData == nullptr)
+        return;
+
+    {
+        std::lock_guard<std::mutex> _(m_lock);
+
+        auto itor = m_live.find(apData);
+        if (itor != std::end(m_live))
+        {
+            Record(kFree, itor->second, 0);
+            m_live.erase(itor);
+        }
+    }
+
+    m_pAllocator->Free(apData);
+}
+
+size_t TraceAllocator::Size(void* apData)
+{
+    {
+        std::lock_guard<std::mutex> _(m_lock);
+
+        auto itor = m_live.find(apData);
+        if (itor != std::end(m_live))
+            Record(kSize, itor->second, 0);
+    }
+
+    return m_pAllocator->Size(apData);
+}
+
+size_t TraceAllocator::GetUsedMemory() const
+{
+    return m_pAllocator->GetUsedMemory();
+}
+
+std::vector<TraceAllocator::Event> TraceAllocator::GetEvents() const
+{
+    std::lock_guard<std::mutex> _(m_lock);
+    return m_events;
+}
+
+void TraceAllocator::Clear()
+{
+    std::lock_guard<std::mutex> _(m_lock);
+
+    m_events.clear();
+    m_live.clear();
+    m_threads.clear();
+    m_nextId = 1;
+    m_start = Clock::GetTimestamp();
+}
+
+bool TraceAllocator::Save(const std::string& acPath) const
+{
+    std::vector<uint8_t> data;
+    {
+        std::lock_guard<std::mutex> _(m_lock);
+
+        data.reserve(m_events.size() * 6);
+
+        uint64_t last = 0;
+        for (auto& event : m_events)
+        {
+            data.push_back(event.Op);
+            WriteVarint(data, event.Timestamp - last);
+            WriteVarint(data, event.Thread);
+            WriteVarint(data, event.Id);
+            if (event.Op == kAllocate)
+                WriteVarint(data, event.Size);
+
+            last = event.Timestamp;
+        }
+    }
+
+    auto* pFile = fopen(acPath.c_str(), "wb");
+    if (pFile == nullptr)
+        return false;
+
+    bool result = fwrite(s_magic, 1, sizeof(s_magic), pFile) == sizeof(s_magic);
+    result &= fwrite(&s_version, sizeof(s_version), 1, pFile) == 1;
+    result &= fwrite(data.data(), 1, data.size(), pFile) == data.size();
+
+    return (fclose(pFile) == 0) && result;
+}
+
+bool TraceAllocator::Load(const std::string& acPath, std::vector<Event>& aEvents)
+{
+    std::ifstream input(acPath, std::ios::binary);
+    if (!input)
+        return false;
+
+    char magic[sizeof(s_magic)];
+    uint16_t version = 0;
+    input.read(magic, sizeof(magic));
+    input.read((char*)&version, sizeof(version));
+
+    if (!input || std::memcmp(magic, s_magic, sizeof(magic)) != 0 || version != s_version)
+        return false;
+
+    aEvents.clear();
+
+    uint64_t last = 0;
+    int op;
+    while ((op = input.get()) != std::char_traits<char>::eof())
+    {
+        if (op > kSize)
+            return false;
+
+        Event event{};
+        event.Op = (Operation)op;
+
+        uint64_t delta, thread, id, size = 0;
+        if (!ReadVarint(input, delta) || !ReadVarint(input, thread) || !ReadVarint(input, id))
+            return false;
+        if (event.Op == kAllocate && !ReadVarint(input, size))
+            return false;
+
+        last += delta;
+        event.Timestamp = last;
+        event.Thread = (uint32_t)thread;
+        event.Id = (uint32_t)id;
+        event.Size = size;
+
+        aEvents.push_back(event);
+    }
+
+    return true;
+}
+
+TraceAllocator::ReplayResult TraceAllocator::Replay(const std::vector<Event>& acEvents, Allocator& aAllocator)
+{
+    struct Live
+    {
+        void* pData;
+        size_t Requested;
+        size_t Reserved;
+    };
+
+    // Ids are dense so the live set is a plain table, sized before the clock starts
+    uint32_t maxId = 0;
+    for (auto& event : acEvents)
+        maxId = std::max(maxId, event.Id);
+
+    std::vector<Live> live(maxId + 1, Live{ nullptr, 0, 0 });
+
+    ReplayResult result;
+    size_t requested = 0, reserved = 0;
+
+    const auto start = Clock::GetTimestamp();
+
+    for (auto& event : acEvents)
+    {
+        auto& entry = live[event.Id];
+
+        switch (event.Op)
+        {
+        case kAllocate:
+            ++result.Allocations;
+            entry.pData = aAllocator.Allocate(event.Size);
+            if (entry.pData == nullptr)
+            {
+                ++result.Failures;
+                break;
+            }
+
+            entry.Requested = event.Size;
+            entry.Reserved = aAllocator.Size(entry.pData);
+            requested += entry.Requested;
+            reserved += entry.Reserved;
+            result.PeakRequested = std::max(result.PeakRequested, requested);
+            result.PeakReserved = std::max(result.PeakReserved, reserved);
+            break;
+        case kFree:
+            if (entry.pData == nullptr)
+                break;
+
+            requested -= entry.Requested;
+            reserved -= entry.Reserved;
+            aAllocator.Free(entry.pData);
+            entry.pData = nullptr;
+            break;
+        case kSize:
+            if (entry.pData)
+                aAllocator.Size(entry.pData);
+            break;
+        }
+    }
+
+    result.Duration = Clock::GetTimestamp() - start;
+
+    for (auto& entry : live)
+    {
+        if (entry.pData)
+            aAllocator.Free(entry.pData);
+    }
+
+    return result;
+}
+
+void TraceAllocator::Record(Operation aOperation, uint32_t aId, uint64_t aSize)
+{
+    const auto thread = m_threads.emplace(std::this_thread::get_id(), (uint32_t)m_threads.size()).first->second;
+
+    m_events.push_back(Event{ Clock::GetTimestamp() - m_start, aSize, aId, thread, aOperation });
+}
\ No newline at end of file
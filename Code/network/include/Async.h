@@ -0,0 +1,147 @@
+#pragma once
+
+// Coroutine flavoured API, the Network library is built as C++20 and users need coroutine support to see it
+#ifdef __cpp_impl_coroutine
+
+#include "Server.h"
+#include <coroutine>
+#include <vector>
+
+class AsyncLoop;
+
+// Coroutine that starts running immediately and stays suspended on a loop until its condition holds. Frames come
+// from the allocator that is current when the coroutine is called.
+class AsyncTask
+{
+public:
+
+    struct promise_type
+    {
+        AsyncTask get_return_object() noexcept { return AsyncTask(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        // The frame is kept until the task goes away so IsDone can be asked
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept;
+
+        static void* operator new(size_t aSize) noexcept;
+        static void operator delete(void* apData) noexcept;
+        static AsyncTask get_return_object_on_allocation_failure() noexcept { return AsyncTask(nullptr); }
+    };
+
+    AsyncTask(AsyncTask&& aRhs) noexcept;
+    AsyncTask& operator=(AsyncTask&& aRhs) noexcept;
+    AsyncTask(const AsyncTask&) = delete;
+    AsyncTask& operator=(const AsyncTask&) = delete;
+    // Destroying a suspended task cancels it
+    ~AsyncTask();
+
+    // False when the frame could not be allocated
+    bool IsValid() const;
+    bool IsDone() const;
+
+private:
+
+    AsyncTask(std::coroutine_handle<promise_type> aHandle) noexcept;
+
+    std::coroutine_handle<promise_type> m_handle;
+};
+
+// Common part of the awaiters, it lives in the suspended coroutine's frame for as long as the loop refers to it
+struct AsyncWaiter
+{
+    AsyncWaiter(AsyncLoop& aLoop, bool (*apReady)(AsyncWaiter&)) noexcept : pLoop(&aLoop), pReady(apReady) {}
+    AsyncWaiter(const AsyncWaiter&) = delete;
+    AsyncWaiter& operator=(const AsyncWaiter&) = delete;
+    ~AsyncWaiter();
+
+    bool await_ready() { return pReady(*this); }
+    void await_suspend(std::coroutine_handle<> aHandle);
+
+    AsyncLoop* pLoop;
+    bool (*pReady)(AsyncWaiter&);
+    std::coroutine_handle<> Handle;
+    bool Registered{ false };
+};
+
+// Resumes suspended coroutines from the caller's loop, usually right after Server::Update or Client::Update
+class AsyncLoop
+{
+public:
+
+    struct AcceptAwaiter : AsyncWaiter
+    {
+        AcceptAwaiter(AsyncLoop& aLoop, Server& aServer) : AsyncWaiter(aLoop, &Ready), pServer(&aServer) {}
+        Connection* await_resume() noexcept { return pConnection; }
+
+        static bool Ready(AsyncWaiter& aWaiter);
+
+        Server* pServer;
+        Connection* pConnection{ nullptr };
+    };
+
+    struct HandshakeAwaiter : AsyncWaiter
+    {
+        HandshakeAwaiter(AsyncLoop& aLoop, Connection& aConnection) : AsyncWaiter(aLoop, &Ready), pConnection(&aConnection) {}
+        bool await_resume() noexcept { return pConnection->IsConnected(); }
+
+        static bool Ready(AsyncWaiter& aWaiter);
+
+        Connection* pConnection;
+    };
+
+    struct ReceiveAwaiter : AsyncWaiter
+    {
+        ReceiveAwaiter(AsyncLoop& aLoop, Connection& aConnection, Connection::Message& aMessage)
+            : AsyncWaiter(aLoop, &Ready), pConnection(&aConnection), pMessage(&aMessage) {}
+        bool await_resume() noexcept { return Received; }
+
+        static bool Ready(AsyncWaiter& aWaiter);
+
+        Connection* pConnection;
+        Connection::Message* pMessage;
+        bool Received{ false };
+    };
+
+    template<class T>
+    struct ConditionAwaiter : AsyncWaiter
+    {
+        ConditionAwaiter(AsyncLoop& aLoop, T&& aCondition) : AsyncWaiter(aLoop, &Ready), Condition(std::forward<T>(aCondition)) {}
+        void await_resume() noexcept {}
+
+        static bool Ready(AsyncWaiter& aWaiter) { return static_cast<ConditionAwaiter&>(aWaiter).Condition(); }
+
+        std::decay_t<T> Condition;
+    };
+
+    AsyncLoop() = default;
+    AsyncLoop(const AsyncLoop&) = delete;
+    AsyncLoop& operator=(const AsyncLoop&) = delete;
+
+    // co_await yields the next peer returned by Server::Accept
+    AcceptAwaiter Accept(Server& aServer) { return AcceptAwaiter(*this, aServer); }
+    // co_await yields true once connected, false if the handshake timed out
+    HandshakeAwaiter Handshake(Connection& aConnection) { return HandshakeAwaiter(*this, aConnection); }
+    // co_await yields true with the next message, false once the connection is gone
+    ReceiveAwaiter Receive(Connection& aConnection, Connection::Message& aMessage) { return ReceiveAwaiter(*this, aConnection, aMessage); }
+    // co_await resumes once aCondition() returns true
+    template<class T>
+    ConditionAwaiter<T> Until(T&& aCondition) { return ConditionAwaiter<T>(*this, std::forward<T>(aCondition)); }
+
+    // Resumes every coroutine whose condition holds, coroutines suspended again meanwhile wait for the next call.
+    // Returns the number of coroutines resumed.
+    size_t Poll();
+    size_t GetWaitingCount() const;
+
+private:
+
+    friend struct AsyncWaiter;
+
+    void Add(AsyncWaiter& aWaiter);
+    void Remove(AsyncWaiter& aWaiter);
+
+    std::vector<AsyncWaiter*> m_waiters;
+    std::vector<AsyncWaiter*> m_polling;
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,115 @@
+#pragma once
+
+#include "Connection.h"
+#include "MappedFile.h"
+#include <string>
+#include <vector>
+
+class Socket;
+
+// Large payloads over a dedicated channel. The sender keeps a window of fragments in flight, the receiver answers with
+// selective acknowledgements and both ends read or write the data in place in memory mapped files.
+struct BulkTransfer
+{
+    enum Type : uint8_t
+    {
+        kFragment,
+        kAck
+    };
+
+    // Type, transfer id, fragment index and total size
+    static constexpr size_t HeaderSize = 1 + 2 + 4 + 6;
+    static constexpr size_t FragmentSize = Connection::MaxPayloadSize - HeaderSize;
+    // Fragments after the cumulative acknowledgement reported in each ack
+    static constexpr size_t AckBits = 256;
+    static constexpr size_t AckSize = 1 + 2 + 4 + AckBits / 8;
+};
+
+class BulkSender
+{
+public:
+
+    BulkSender(uint32_t aChannel, uint16_t aId);
+
+    bool Open(const std::string& acPath);
+    // The data must outlive the transfer
+    void Attach(const uint8_t* apData, size_t aSize);
+
+    // Sends the fragments considered lost then new ones while the window allows, at most aMaxFragments per call
+    // so that a transfer never crowds out the real time channels of the connection
+    size_t Update(Connection& aConnection, size_t aMaxFragments);
+    // Same but the fragments are laid out directly in the send slab of the connection's socket, flush it afterwards
+    size_t Update(Connection& aConnection, Socket& aSocket, size_t aMaxFragments);
+    // Consumes acknowledgements received on the channel
+    bool Process(const Connection::Message& acMessage);
+
+    bool IsComplete() const;
+    size_t GetFragmentCount() const;
+    size_t GetAcknowledgedCount() const;
+    size_t GetRetransmitCount() const;
+
+    // Fragments further than AckBits past the cumulative ack could never be acknowledged selectively
+    static constexpr size_t WindowSize = BulkTransfer::AckBits;
+
+private:
+
+    size_t Update(Connection& aConnection, Socket* apSocket, size_t aMaxFragments);
+    bool SendFragment(Connection& aConnection, Socket* apSocket, size_t aIndex, uint64_t aNow);
+    void Acknowledge(size_t aIndex);
+    bool IsAcknowledged(size_t aIndex) const;
+
+    MappedFile m_file;
+    const uint8_t* m_pData;
+    size_t m_size;
+    uint32_t m_channel;
+    uint16_t m_id;
+
+    size_t m_fragmentCount;
+    // First fragment not acknowledged, next fragment never sent and one past the highest acknowledged
+    size_t m_base;
+    size_t m_next;
+    size_t m_highest;
+    size_t m_acknowledgedCount;
+    size_t m_retransmitCount;
+
+    std::vector<uint64_t> m_acknowledged;
+    std::vector<uint64_t> m_sentAt;
+};
+
+class BulkReceiver
+{
+public:
+
+    // The destination file is created once the first fragment tells the size, transfers larger than aMaxSize are refused
+    BulkReceiver(uint32_t aChannel, const std::string& acPath, size_t aMaxSize);
+
+    // Consumes fragments received on the channel, acknowledgements are sent every AckInterval fragments
+    bool Process(Connection& aConnection, const Connection::Message& acMessage);
+    // Acknowledges what was received since the last ack, call it once per update
+    void Flush(Connection& aConnection);
+
+    bool IsComplete() const;
+    size_t GetSize() const;
+    const uint8_t* GetData() const;
+
+    static constexpr size_t AckInterval = 32;
+
+private:
+
+    bool IsReceived(size_t aIndex) const;
+
+    MappedFile m_file;
+    std::string m_path;
+    uint32_t m_channel;
+    uint16_t m_id;
+    bool m_started;
+
+    size_t m_maxSize;
+    size_t m_size;
+    size_t m_fragmentCount;
+    size_t m_cumulative;
+    size_t m_receivedCount;
+    size_t m_pendingAcks;
+
+    std::vector<uint64_t> m_received;
+};
\ No newline at end of file
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "Socket.h"
+#include "Connection.h"
+#include <memory>
+
+// Client side counterpart of Server, a non-blocking socket and a single connection driven from the caller's loop
+class Client : public AllocatorCompatible
+             , public Connection::ICommunication
+{
+public:
+
+    Client(Endpoint::Type aType = Endpoint::kIPv4);
+    ~Client();
+
+    // Starts the handshake and returns right away, Update completes it
+    bool Connect(const Endpoint& acRemote);
+    void Disconnect();
+
+    // Ticks the Clock, processes everything the socket holds, keeps the handshake going and flushes queued sends.
+    // Returns the number of packets processed.
+    uint32_t Update();
+    // Sleeps until a packet arrives or the timeout, in nanoseconds, expires. Meant as the idle step of a TickScheduler
+    bool Wait(uint64_t aTimeout);
+
+    // Queued in the socket's send slab, it goes out with the next Flush or Update
+    bool Send(uint32_t aChannel, const uint8_t* apData, size_t aLength);
+    // For input: sent along with anything queued before it as soon as it is produced instead of on the next tick
+    bool SendImmediate(uint32_t aChannel, const uint8_t* apData, size_t aLength);
+    size_t Flush();
+
+    bool Receive(Connection::Message& aMessage);
+
+    bool IsConnected() const;
+    Connection::State GetState() const;
+    Connection* GetConnection();
+    uint16_t GetPort() const;
+
+    bool Send(const Endpoint& acRemoteEndpoint, Buffer aBuffer) override;
+
+private:
+
+    Socket m_socket;
+    Endpoint::Type m_type;
+    std::unique_ptr<Connection> m_pConnection;
+};
\ No newline at end of file
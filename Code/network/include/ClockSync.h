@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+// Estimates the offset of a remote clock from NTP style samples.
+// Only the sample with the smallest round trip in the window is trusted since queuing delays are rarely symmetric.
+class ClockSync
+{
+public:
+
+    ClockSync();
+
+    // aOffset is the remote time minus the local time, all values are in nanoseconds
+    void AddSample(uint64_t aLocalTime, int64_t aOffset, uint64_t aRoundTrip);
+
+    bool HasEstimate() const;
+    // Offset extrapolated to aLocalTime using the estimated drift
+    int64_t GetOffset(uint64_t aLocalTime) const;
+    // Upper bound of the offset error, half the best round trip
+    uint64_t GetError() const;
+    uint64_t GetRoundTrip() const;
+    // Nanoseconds of divergence per nanosecond
+    double GetDrift() const;
+
+    static constexpr size_t WindowSize = 64;
+
+private:
+
+    struct Sample
+    {
+        uint64_t Time;
+        int64_t Offset;
+        uint64_t RoundTrip;
+    };
+
+    Sample m_samples[WindowSize];
+    size_t m_count;
+    size_t m_next;
+    Sample m_best;
+    Sample m_reference;
+    double m_drift;
+};
\ No newline at end of file
@@ -1,82 +1,176 @@
-#pragma once
-
-#include "Buffer.h"
-#include "Outcome.h"
-#include "Endpoint.h"
-#include "DHChachaFilter.h"
-
-class Socket;
-class Connection
-{
-public:
-
-    struct Header
-    {
-        enum
-        {
-            kNegotiation,
-            kConnection,
-            kCount
-        };
-
-        char Signature[2];
-        uint64_t Version;
-        uint64_t Type;
-        uint64_t Length;
-    };
-
-    enum State
-    {
-        kNone,
-        kNegociating,
-        kConnected
-    };
-
-    enum HeaderErrors
-    {
-        kBadSignature,
-        kBadVersion,
-        kBadPacketType,
-        kTooLarge,
-        kUnknownChannel
-    };
-
-    struct ICommunication
-    {
-        virtual bool Send(const Endpoint& acRemote, Buffer aBuffer) = 0;
-    };
-
-    Connection(ICommunication& aCommunicationInterface, const Endpoint& acRemoteEndpoint);
-    Connection(const Connection& acRhs) = delete;
-    Connection(Connection&& aRhs) noexcept;
-
-    ~Connection();
-
-    Connection& operator=(Connection&& aRhs) noexcept;
-    Connection& operator=(const Connection& aRhs) = delete;
-
-    bool ProcessPacket(Buffer* apBuffer);
-    bool ProcessNegociation(Buffer* apBuffer);
-
-    bool IsNegotiating() const;
-    bool IsConnected() const;
-
-    State GetState() const;
-    const Endpoint& GetRemoteEndpoint() const;
-
-    void Update(uint64_t aElapsedMilliseconds);
-
-protected:
-
-    void SendNegotiation();
-
-    Outcome<Header, HeaderErrors> ProcessHeader(Buffer::Reader& aReader);
-
-private:
-
-    ICommunication& m_communication;
-    State m_state;
-    uint64_t m_timeSinceLastEvent;
-    Endpoint m_remoteEndpoint;
-    DHChachaFilter m_filter;
+#pragma once
+
+#include "Buffer.h"
+#include "Outcome.h"
+#include "Endpoint.h"
+#include "DHChachaFilter.h"
+#include "Clock.h"
+#include "ClockSync.h"
+#include "ForwardErrorCorrection.h"
+#include "StlAllocator.h"
+#include <array>
+#include <deque>
+#include <memory>
+
+class Socket;
+class Connection
+{
+public:
+
+    struct Header
+    {
+        enum
+        {
+            kNegotiation,
+            kConnection,
+            kCount
+        };
+
+        char Signature[2];
+        uint64_t Version;
+        uint64_t Type;
+        uint64_t Length;
+    };
+
+    enum State
+    {
+        kNone,
+        kNegociating,
+        kConnected
+    };
+
+    enum HeaderErrors
+    {
+        kBadSignature,
+        kBadVersion,
+        kBadPacketType,
+        kTooLarge,
+        kUnknownChannel
+    };
+
+    struct ICommunication
+    {
+        virtual bool Send(const Endpoint& acRemote, Buffer aBuffer) = 0;
+        // Trusted transports never leave the process, the key exchange and payload encryption are skipped
+        virtual bool IsTrusted() const { return false; }
+    };
+
+    struct Message
+    {
+        const uint8_t* GetData() const { return Packet.GetData() + Offset; }
+        size_t GetSize() const { return Length; }
+
+        uint32_t Channel;
+        // The payload is kept in the packet it arrived in to avoid a copy
+        Buffer Packet;
+        size_t Offset;
+        size_t Length;
+    };
+
+    struct Statistics
+    {
+        uint64_t SentPackets{ 0 };
+        uint64_t SentBytes{ 0 };
+        uint64_t ReceivedPackets{ 0 };
+        uint64_t ReceivedBytes{ 0 };
+        // Packets that failed validation
+        uint64_t DroppedPackets{ 0 };
+    };
+
+    static constexpr uint32_t MaxChannels = 16;
+    static constexpr size_t MaxPacketSize = 1200;
+    // Data packets also carry their send time and echo the last one received, in microseconds, for clock synchronization
+    static constexpr size_t HeaderSize = 22;
+    static constexpr size_t MaxPayloadSize = MaxPacketSize - HeaderSize;
+
+    Connection(ICommunication& aCommunicationInterface, const Endpoint& acRemoteEndpoint);
+    // Restores a connection written by Save, the state is kNone if the data was invalid
+    Connection(ICommunication& aCommunicationInterface, Buffer::Reader& aReader);
+    Connection(const Connection& acRhs) = delete;
+    Connection(Connection&& aRhs) noexcept;
+
+    ~Connection();
+
+    Connection& operator=(Connection&& aRhs) noexcept;
+    Connection& operator=(const Connection& aRhs) = delete;
+
+    // Takes ownership of the packet, payloads are queued for Receive
+    bool ProcessPacket(Buffer aPacket);
+    // Only copies the payload of packets that carry one
+    bool ProcessPacket(const uint8_t* apData, size_t aLength);
+    bool ProcessNegociation(Buffer* apBuffer);
+
+    bool Send(uint32_t aChannel, const uint8_t* apData, size_t aLength);
+    // Builds the complete packet in apOutput, which must hold HeaderSize + aLength bytes, and returns its size.
+    // Lets the caller batch the sends, returns 0 on channels that need more than one packet.
+    size_t WritePacket(uint32_t aChannel, const uint8_t* apData, size_t aLength, uint8_t* apOutput);
+    // Same with a payload the caller already wrote at apOutput + HeaderSize, it is encrypted in place
+    size_t WritePacket(uint32_t aChannel, size_t aLength, uint8_t* apOutput);
+    // Adds parity packets to a channel, payloads of that channel lose ForwardErrorCorrection::Overhead bytes
+    bool EnableForwardErrorCorrection(uint32_t aChannel, const ForwardErrorCorrection::Config& acConfig);
+    void DisableForwardErrorCorrection(uint32_t aChannel);
+    bool Receive(Message& aMessage);
+
+    bool IsNegotiating() const;
+    bool IsConnected() const;
+
+    State GetState() const;
+    const Endpoint& GetRemoteEndpoint() const;
+    const ICommunication& GetCommunication() const;
+
+    // Remote clock minus the local Clock, in nanoseconds
+    int64_t GetClockOffset() const;
+    uint64_t GetClockError() const;
+    const ClockSync& GetClockSync() const;
+    const Statistics& GetStatistics() const;
+
+    // Takes the current Clock time
+    void Update(uint64_t aNow);    // Drops the connection and its link to the communication interface so that the interface can go away
+    void Close();
+
+    bool Save(Buffer::Writer& aWriter) const;
+
+    // Packet buffers and the receive queue come from apAllocator, which must outlive the connection and its messages.
+    // Past aMaxQueued messages waiting for Receive new payloads are dropped so one peer cannot drain a shared
+    // allocator, 0 for no limit.
+    void SetAllocator(Allocator* apAllocator, size_t aMaxQueued = 0);
+
+    static constexpr size_t MaxSerializedSize = 1024;
+    // Connections that receive nothing for this long are dropped (TODO: make this configurable)
+    static constexpr uint64_t Timeout = Clock::Seconds(15);
+
+protected:
+
+    void SendNegotiation();
+    bool SendPacket(uint32_t aChannel, const uint8_t* apData, size_t aLength);
+    bool HandleNegotiation(Buffer::Reader& aReader);
+    bool ReadPayloadHeader(Buffer::Reader& aReader, const Header& acHeader, size_t aPacketSize, uint32_t& aSequence, uint32_t& aChannel);
+    void ProcessTimestamps(uint64_t aTransmit, uint64_t aEcho, uint64_t aEchoDelay);
+    void QueuePayload(Buffer aData, size_t aOffset, size_t aLength, uint32_t aSequence, uint32_t aChannel);
+
+    Outcome<Header, HeaderErrors> ProcessHeader(Buffer::Reader& aReader);
+    void WriteHeader(Buffer::Writer& aWriter, uint64_t aType, size_t aLength);
+    // Full header of a data packet
+    void WriteHeader(uint32_t aChannel, size_t aLength, uint8_t* apOutput);
+
+    bool Load(Buffer::Reader& aReader);
+    bool IsReceiveQueueFull() const;
+    Buffer AllocateBuffer(size_t aSize) const;
+
+private:
+
+    ICommunication* m_pCommunication;
+    State m_state;
+    uint64_t m_timeoutDeadline;
+    Endpoint m_remoteEndpoint;
+    DHChachaFilter m_filter;
+    uint32_t m_sendSequence;
+    std::deque<Message, StlAllocator<Message>> m_receiveQueue;
+    ClockSync m_clockSync;
+    uint64_t m_remoteTransmit;
+    uint64_t m_remoteTransmitTime;
+    std::array<std::unique_ptr<ForwardErrorCorrection>, MaxChannels> m_fec;
+    Statistics m_statistics;
+    Allocator* m_pAllocator;
+    size_t m_maxQueued;
 };
\ No newline at end of file
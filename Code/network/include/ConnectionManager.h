@@ -1,26 +1,54 @@
-#pragma once
-
-#include "Socket.h"
-#include "Connection.h"
-#include <unordered_map>
-
-class ConnectionManager : public AllocatorCompatible
-{
-public:
-
-    ConnectionManager(size_t aMaxConnections);
-
-    Connection* Find(const Endpoint& acEndpoint);
-    const Connection* Find(const Endpoint& acEndpoint) const;
-
-    void Add(Connection aConnection);
-
-    bool IsFull() const;
-
-    void Update(uint64_t aElapsedMilliSeconds);
-
-private:
-
-    std::unordered_map<Endpoint, Connection> m_connections;
-    size_t m_maxConnections;
-};
\ No newline at end of file
+#pragma once
+
+#include "Socket.h"
+#include "Connection.h"
+#include <vector>
+
+// Connections live in a flat table reserved up front, pointers stay valid for the lifetime of the manager.
+// Slots are never reclaimed, the capacity bounds the peers seen over that lifetime rather than the live ones.
+class ConnectionManager : public AllocatorCompatible
+{
+public:
+
+    ConnectionManager(size_t aMaxConnections);
+
+    Connection* Find(const Endpoint& acEndpoint);
+    const Connection* Find(const Endpoint& acEndpoint) const;
+
+    // Ignored if the manager is full or the endpoint is already known
+    void Add(Connection aConnection);
+
+    // Reserves storage for aMaxConnections, only allowed while empty
+    bool SetCapacity(size_t aMaxConnections);
+    size_t GetCapacity() const;
+
+    bool IsFull() const;
+    size_t GetCount() const;
+
+    void Update(uint64_t aNow);
+
+    // Calls aVisitor(Connection&) for every connection
+    template<class T>
+    void ForEach(T&& aVisitor);
+
+    bool Save(Buffer::Writer& aWriter) const;
+    bool Load(Buffer::Reader& aReader, Connection::ICommunication& aCommunicationInterface);
+
+private:
+
+    static constexpr uint32_t kEmpty = UINT32_MAX;
+
+    size_t GetSlot(const Endpoint& acEndpoint) const;
+
+    std::vector<Connection> m_connections;
+    // Open addressing table of indices into m_connections, its size is a power of two
+    std::vector<uint32_t> m_index;
+    size_t m_maxConnections;
+};
+
+template<class T>
+void ConnectionManager::ForEach(T&& aVisitor)
+{
+    for (auto& connection : m_connections)
+        aVisitor(connection);
+}
\ No newline at end of file
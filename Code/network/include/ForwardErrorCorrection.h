@@ -0,0 +1,164 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+// Parity packets for a channel: every group of DataCount packets is followed by ParityCount parity packets
+// and any DataCount packets of a group are enough to rebuild the others. Both ends must use the same configuration.
+class ForwardErrorCorrection
+{
+public:
+
+    enum Scheme : uint8_t
+    {
+        // Single parity packet, repairs one loss per group
+        kXor,
+        // Cauchy Reed-Solomon, repairs up to ParityCount losses per group
+        kReedSolomon
+    };
+
+    struct Config
+    {
+        Scheme Type{ kXor };
+        uint8_t DataCount{ 4 };
+        uint8_t ParityCount{ 1 };
+    };
+
+    // Group and index in front of every packet
+    static constexpr size_t HeaderSize = 3;
+    // Parity packets add the number of data packets of their group, which is smaller when it was flushed early
+    static constexpr size_t ParityHeaderSize = HeaderSize + 1;
+    // Parity packets also carry the length of the payloads they protect
+    static constexpr size_t Overhead = ParityHeaderSize + 2;
+    static constexpr size_t MaxGroupSize = 32;
+    static constexpr size_t MaxGroupsInFlight = 4;
+
+    ForwardErrorCorrection(const Config& acConfig, size_t aMaxPayloadSize);
+
+    static bool IsValid(const Config& acConfig);
+    const Config& GetConfig() const;
+
+    // Frames a payload in apOutput, which must hold aLength + HeaderSize bytes, and returns the framed size
+    size_t Encode(const uint8_t* apData, size_t aLength, uint8_t* apOutput);
+    // Calls aSend(const uint8_t*, size_t) for each parity packet once the current group is complete. With aPartial
+    // a group holding fewer packets is closed too, so that the last packets before a pause are protected.
+    template<class T>
+    void Flush(T&& aSend, bool aPartial = false);
+    // Partial flush of a group nothing was added to since the previous call, call it once per tick. Groups of a
+    // steady stream fill up and keep the configured ratio, only the last one before a pause is closed early.
+    template<class T>
+    void FlushIdle(T&& aSend);
+
+    // Returns true if the packet is a new data packet, its payload follows the header. Data packets of groups that
+    // already left the window are still delivered, they only take no part in recovery.
+    // Calls aRecovered(const uint8_t*, size_t) for every payload rebuilt from parity.
+    template<class T>
+    bool Decode(const uint8_t* apPacket, size_t aLength, T&& aRecovered);
+
+private:
+
+    struct Group
+    {
+        uint16_t Id;
+        // Data packets in the group, known once a parity packet arrived
+        uint8_t DataCount;
+        bool Active;
+        bool Recovered;
+        uint32_t ReceivedMask;
+        size_t ParityLength;
+        // Every shard is a 16 bit length followed by the payload, zero padded to the longest one of the group
+        std::vector<uint8_t> Shards;
+        size_t Lengths[MaxGroupSize];
+    };
+
+    uint8_t GetCoefficient(size_t aParity, size_t aData) const;
+    Group* Store(uint16_t aGroup, uint8_t aIndex, uint8_t aDataCount, const uint8_t* apData, size_t aLength);
+    size_t Recover(Group& aGroup, uint8_t* apRecovered);
+
+    Config m_config;
+    size_t m_shardSize;
+
+    uint16_t m_sendGroup;
+    uint8_t m_sendIndex;
+    // Set by Encode, cleared by FlushIdle
+    bool m_sendActive;
+    size_t m_parityLength;
+    std::vector<uint8_t> m_parity;
+
+    Group m_groups[MaxGroupsInFlight];
+};
+
+template<class T>
+void ForwardErrorCorrection::Flush(T&& aSend, bool aPartial)
+{
+    if (m_sendIndex == 0 || (m_sendIndex < m_config.DataCount && !aPartial))
+        return;
+
+    // The missing packets of a partial group count as empty, they add nothing to the parity
+    const size_t stride = ParityHeaderSize + m_shardSize;
+    for (size_t i = 0; i < m_config.ParityCount; ++i)
+    {
+        auto* pPacket = m_parity.data() + i * stride;
+        pPacket[0] = (uint8_t)(m_sendGroup & 0xFF);
+        pPacket[1] = (uint8_t)(m_sendGroup >> 8);
+        pPacket[2] = (uint8_t)(m_config.DataCount + i);
+        pPacket[3] = m_sendIndex;
+
+        aSend((const uint8_t*)pPacket, ParityHeaderSize + m_parityLength);
+
+        std::fill(pPacket + ParityHeaderSize, pPacket + ParityHeaderSize + m_parityLength, 0);
+    }
+
+    ++m_sendGroup;
+    m_sendIndex = 0;
+    m_parityLength = 0;
+}
+
+template<class T>
+void ForwardErrorCorrection::FlushIdle(T&& aSend)
+{
+    if (!m_sendActive)
+        Flush(std::forward<T>(aSend), true);
+
+    m_sendActive = false;
+}
+
+template<class T>
+bool ForwardErrorCorrection::Decode(const uint8_t* apPacket, size_t aLength, T&& aRecovered)
+{
+    if (aLength < HeaderSize)
+        return false;
+
+    const uint16_t groupId = apPacket[0] | (apPacket[1] << 8);
+    const uint8_t index = apPacket[2];
+
+    if (index >= m_config.DataCount + m_config.ParityCount)
+        return false;
+
+    const bool isParity = index >= m_config.DataCount;
+    if (isParity && aLength < ParityHeaderSize)
+        return false;
+
+    const auto headerSize = isParity ? ParityHeaderSize : HeaderSize;
+    const auto dataCount = isParity ? apPacket[HeaderSize] : m_config.DataCount;
+
+    // Late data is intact, only its group is gone
+    const auto& slot = m_groups[groupId % MaxGroupsInFlight];
+    if (!isParity && slot.Active && int16_t(groupId - slot.Id) < 0)
+        return true;
+
+    auto* pGroup = Store(groupId, index, dataCount, apPacket + headerSize, aLength - headerSize);
+    if (pGroup == nullptr)
+        return false;
+
+    uint8_t recovered[MaxGroupSize];
+    const auto count = Recover(*pGroup, recovered);
+    for (size_t i = 0; i < count; ++i)
+    {
+        const auto* pShard = pGroup->Shards.data() + recovered[i] * m_shardSize;
+        aRecovered(pShard + 2, pGroup->Lengths[recovered[i]]);
+    }
+
+    return !isParity;
+}
\ No newline at end of file
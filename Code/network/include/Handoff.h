@@ -0,0 +1,35 @@
+#pragma once
+
+#include "Socket.h"
+#include <initializer_list>
+#include <string>
+
+// Passes bound sockets and an opaque state blob to another process over a unix domain socket (SCM_RIGHTS)
+class Handoff
+{
+public:
+
+    Handoff();
+    ~Handoff();
+
+    // Predecessor side: wait for a successor to connect on the given path
+    bool Listen(const std::string& acPath);
+    // Non-blocking, returns true when a successor just connected
+    bool Accept();
+
+    // Successor side: attach to a predecessor listening on the given path
+    bool Connect(const std::string& acPath);
+
+    bool Send(std::initializer_list<Socket*> aSockets, const Buffer& acState, size_t aStateSize);
+    bool Receive(std::initializer_list<Socket*> aSockets, Buffer& aState);
+
+    bool IsConnected() const;
+
+private:
+
+    static constexpr size_t MaxSocketCount = 8;
+
+    int m_listener;
+    int m_peer;
+    std::string m_path;
+};
\ No newline at end of file
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Uniform grid of entities used to decide what each peer should receive. Entities are stored sorted by cell so that
+// a query walks a few contiguous ranges, the cost of a view only depends on the density around it.
+class InterestGrid
+{
+public:
+
+    // What a peer sees, Entered and Left hold the difference with the previous update
+    struct View
+    {
+        float X{ 0.f };
+        float Y{ 0.f };
+        float Radius{ 0.f };
+
+        // Sorted
+        std::vector<uint32_t> Visible;
+        std::vector<uint32_t> Entered;
+        std::vector<uint32_t> Left;
+
+    private:
+
+        friend class InterestGrid;
+        std::vector<uint32_t> m_scratch;
+    };
+
+    InterestGrid(float aMinX, float aMinY, float aWidth, float aHeight, float aCellSize);
+    ~InterestGrid();
+
+    // Entities are added every tick then sorted in cells by Build, positions outside the grid are clamped to its border
+    void Clear();
+    void Add(uint32_t aId, float aX, float aY);
+    void Build(size_t aThreadCount = 1);
+
+    // Calls aVisitor(uint32_t aId) for every entity within aRadius
+    template<class T>
+    void Query(float aX, float aY, float aRadius, T&& aVisitor) const;
+
+    void Update(View& aView) const;
+    // Views are independent so they are split between threads, the threads are started once and kept for later calls
+    void Update(View* apViews, size_t aCount, size_t aThreadCount = 1) const;
+
+    size_t GetEntityCount() const;
+    size_t GetCellCount() const;
+
+private:
+
+    struct Workers;
+
+    // Splits [0, aCount) in aThreadCount chunks and calls aFunction(begin, end, chunk), the caller takes the first one
+    template<class T>
+    void ParallelFor(size_t aThreadCount, size_t aCount, T&& aFunction) const;
+
+    uint32_t GetCell(float aX, float aY) const;
+    uint32_t GetColumn(float aX) const;
+    uint32_t GetRow(float aY) const;
+
+    float m_minX;
+    float m_minY;
+    float m_inverseCellSize;
+    uint32_t m_columns;
+    uint32_t m_rows;
+
+    std::vector<uint32_t> m_ids;
+    std::vector<float> m_xs;
+    std::vector<float> m_ys;
+    std::vector<uint32_t> m_cells;
+
+    // Entities of cell i are in [m_cellStart[i], m_cellStart[i + 1])
+    std::vector<uint32_t> m_cellStart;
+    std::vector<uint32_t> m_sortedIds;
+    std::vector<float> m_sortedXs;
+    std::vector<float> m_sortedYs;
+
+    mutable std::unique_ptr<Workers> m_pWorkers;
+};
+
+template<class T>
+void InterestGrid::Query(float aX, float aY, float aRadius, T&& aVisitor) const
+{
+    if (m_cellStart.empty())
+        return;
+
+    const auto firstColumn = GetColumn(aX - aRadius);
+    const auto lastColumn = GetColumn(aX + aRadius);
+    const auto firstRow = GetRow(aY - aRadius);
+    const auto lastRow = GetRow(aY + aRadius);
+    const auto radiusSquared = aRadius * aRadius;
+
+    for (auto row = firstRow; row <= lastRow; ++row)
+    {
+        // Cells of a row are adjacent so their entities form a single range
+        const auto begin = m_cellStart[row * m_columns + firstColumn];
+        const auto end = m_cellStart[row * m_columns + lastColumn + 1];
+
+        for (auto i = begin; i < end; ++i)
+        {
+            const auto dx = m_sortedXs[i] - aX;
+            const auto dy = m_sortedYs[i] - aY;
+            if (dx * dx + dy * dy <= radiusSquared)
+                aVisitor(m_sortedIds[i]);
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "Connection.h"
+#include "Socket.h"
+#include <deque>
+
+// In-process transport for listen servers and bots, buffers are handed to the other end without copies or syscalls.
+// Both ends must be used from the same thread.
+class LoopbackCommunication : public Connection::ICommunication
+{
+public:
+
+    // acLocal is the address the other end sees packets coming from
+    LoopbackCommunication(const Endpoint& acLocal, bool aTrusted = false);
+    LoopbackCommunication(const LoopbackCommunication& acRhs) = delete;
+    ~LoopbackCommunication();
+
+    LoopbackCommunication& operator=(const LoopbackCommunication& acRhs) = delete;
+
+    void Link(LoopbackCommunication& aPeer);
+
+    bool Send(const Endpoint& acRemote, Buffer aBuffer) override;
+    bool IsTrusted() const override;
+
+    Outcome<Socket::Packet, Socket::Error> Receive();
+
+    const Endpoint& GetLocalEndpoint() const;
+    bool IsReady() const;
+    size_t GetQueuedCount() const;
+
+private:
+
+    std::deque<Socket::Packet> m_queue;
+    LoopbackCommunication* m_pPeer;
+    Endpoint m_local;
+    bool m_trusted;
+};
@@ -0,0 +1,119 @@
+#pragma once
+
+#include "Buffer.h"
+#include <cstdint>
+#include <deque>
+#include <initializer_list>
+#include <vector>
+
+class Connection;
+
+// Objects made of fixed width fields, changes are tracked with one dirty mask per object kept in a dense array
+// so finding what to send is a linear scan rather than a call on every object.
+class Replication
+{
+public:
+
+    using ObjectId = uint32_t;
+
+    static constexpr size_t MaxFields = 63;
+    static constexpr size_t MaxTypes = 256;
+    static constexpr uint32_t InvalidType = ~0u;
+    static constexpr ObjectId InvalidObject = ~0u;
+    static constexpr ObjectId MaxObjects = 1 << 20;
+
+    // State of the remote side of a connection, holds the fields it has not acknowledged yet
+    class Peer
+    {
+    public:
+
+        // Updates not acknowledged after this many more recent ones are considered lost
+        static constexpr size_t MaxInFlight = 64;
+
+        Peer(Replication& aReplication);
+        ~Peer();
+
+        Peer(const Peer&) = delete;
+        Peer& operator=(const Peer&) = delete;
+
+        // Updates older than an acknowledged one were dropped by the receiver, their fields are sent again
+        void Acknowledge(uint32_t aSequence);
+
+        bool HasPending() const;
+
+    private:
+
+        friend class Replication;
+
+        struct Update
+        {
+            uint32_t Sequence;
+            std::vector<ObjectId> Objects;
+            std::vector<uint64_t> Masks;
+        };
+
+        void Resend(const Update& acUpdate);
+
+        Replication& m_replication;
+        uint32_t m_sequence;
+        std::vector<uint64_t> m_pending;
+        std::deque<Update> m_inFlight;
+    };
+
+    Replication() = default;
+    ~Replication();
+
+    Replication(const Replication&) = delete;
+    Replication& operator=(const Replication&) = delete;
+
+    // Fields are 1 to 64 bits wide, returns InvalidType when too many types or fields are registered
+    uint32_t RegisterType(std::initializer_list<uint8_t> aFieldBits);
+
+    ObjectId Create(uint32_t aType);
+    void Destroy(ObjectId aObject);
+    // Values are truncated to the width of the field, only actual changes mark it dirty
+    void Set(ObjectId aObject, uint32_t aField, uint64_t aValue);
+
+    uint64_t Get(ObjectId aObject, uint32_t aField) const;
+    uint32_t GetType(ObjectId aObject) const;
+    bool IsAlive(ObjectId aObject) const;
+    size_t GetObjectCount() const;
+
+    // Hands the changes made since the last call to every peer, once per tick
+    void Commit();
+
+    // Writes the fields aPeer is missing until aWriter is full, returns false if there was nothing to write
+    bool Write(Peer& aPeer, Buffer::Writer& aWriter);
+    // Same as Write in a single packet of aChannel
+    bool Send(Peer& aPeer, Connection& aConnection, uint32_t aChannel);
+    // Applies an update from the remote Write, out of order updates are rejected and must not be acknowledged
+    bool Read(Buffer::Reader& aReader, uint32_t& aSequence);
+
+private:
+
+    struct Type
+    {
+        std::vector<uint8_t> Bits;
+        uint64_t Mask;
+    };
+
+    // Set when an object is created or destroyed so that objects without fields are sent too
+    static constexpr uint64_t ExistenceBit = uint64_t(1) << MaxFields;
+
+    void Allocate(ObjectId aObject, uint32_t aType);
+
+    std::vector<Type> m_types;
+    std::vector<Peer*> m_peers;
+
+    // Indexed by object
+    std::vector<uint32_t> m_objectTypes;
+    std::vector<uint32_t> m_offsets;
+    std::vector<uint8_t> m_capacities;
+    std::vector<uint64_t> m_dirty;
+    std::vector<ObjectId> m_free;
+
+    std::vector<uint64_t> m_values;
+
+    bool m_hasReceived{ false };
+    uint32_t m_receiveSequence{ 0 };
+};
\ No newline at end of file
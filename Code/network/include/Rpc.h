@@ -0,0 +1,252 @@
+#pragma once
+
+#include "Buffer.h"
+#include "Connection.h"
+#include "Meta.h"
+#include <array>
+#include <cstring>
+#include <tuple>
+
+// Fixed size types only so that every message has a size known at compile time
+template<class T, class = void>
+struct RpcSerializer;
+
+// Values travel through a uint64_t, wider types such as long double have no serializer
+template<class T>
+struct RpcSerializer<T, std::enable_if_t<(std::is_arithmetic_v<T> || std::is_enum_v<T>) && sizeof(T) <= sizeof(uint64_t)>>
+{
+    static constexpr size_t Bits = std::is_same_v<T, bool> ? 1 : sizeof(T) * 8;
+
+    static bool Write(Buffer::Writer& aWriter, const T& acValue)
+    {
+        uint64_t bits = 0;
+        std::memcpy(&bits, &acValue, sizeof(T));
+        return aWriter.WriteBits(bits, Bits);
+    }
+
+    static bool Read(Buffer::Reader& aReader, T& aValue)
+    {
+        uint64_t bits;
+        if (!aReader.ReadBits(bits, Bits))
+            return false;
+
+        std::memcpy(&aValue, &bits, sizeof(T));
+        return true;
+    }
+};
+
+template<class T, size_t N>
+struct RpcSerializer<std::array<T, N>>
+{
+    static constexpr size_t Bits = RpcSerializer<T>::Bits * N;
+
+    static bool Write(Buffer::Writer& aWriter, const std::array<T, N>& acValue)
+    {
+        for (const auto& element : acValue)
+        {
+            if (!RpcSerializer<T>::Write(aWriter, element))
+                return false;
+        }
+        return true;
+    }
+
+    static bool Read(Buffer::Reader& aReader, std::array<T, N>& aValue)
+    {
+        for (auto& element : aValue)
+        {
+            if (!RpcSerializer<T>::Read(aReader, element))
+                return false;
+        }
+        return true;
+    }
+};
+
+template<uint32_t TId, class... TArgs>
+struct RpcMessage
+{
+    static constexpr uint32_t Id = TId;
+    static constexpr size_t Bits = (size_t(0) + ... + RpcSerializer<TArgs>::Bits);
+
+    using Arguments = std::tuple<TArgs...>;
+};
+
+// RPC_MESSAGE(SpawnEntity, uint32_t, float, float) declares a message handled by void On(SpawnEntity, uint32_t, float, float)
+#define RPC_MESSAGE(Name, ...) struct Name : RpcMessage<HashString(#Name), ##__VA_ARGS__> {}
+
+// Set of messages both ends agree on. Messages are sent as their index in the list, the hashed ids make the
+// Fingerprint that peers compare to detect they were built with different lists.
+template<class... TMessages>
+class RpcProtocol
+{
+public:
+
+    static constexpr size_t Count = sizeof...(TMessages);
+
+    static_assert(Count > 0, "A protocol needs at least one message");
+
+    static constexpr uint32_t Fingerprint = []()
+    {
+        uint32_t hash = 2166136261u;
+        for (auto id : { TMessages::Id... })
+            hash = (hash ^ id) * 16777619u;
+        return hash;
+    }();
+
+    // One more value is needed for the end marker
+    static constexpr size_t IndexBits = []()
+    {
+        size_t bits = 1;
+        while ((size_t(1) << bits) <= Count)
+            ++bits;
+        return bits;
+    }();
+
+    template<class T>
+    static constexpr size_t IndexOf()
+    {
+        constexpr bool matches[] = { std::is_same_v<T, TMessages>... };
+        for (size_t i = 0; i < Count; ++i)
+        {
+            if (matches[i])
+                return i;
+        }
+        return Count;
+    }
+
+    // Calls aHandler.On(Message{}, arguments...) for every message of a batch, stops at the first malformed one
+    template<class THandler>
+    static bool Dispatch(THandler& aHandler, Buffer::Reader& aReader);
+
+    template<class THandler>
+    static bool Dispatch(THandler& aHandler, const uint8_t* apData, size_t aLength)
+    {
+        Buffer::Reader reader(apData, aLength);
+        return Dispatch(aHandler, reader);
+    }
+
+private:
+
+    static constexpr bool HasUniqueIds()
+    {
+        constexpr uint32_t ids[] = { TMessages::Id... };
+        for (size_t i = 0; i < Count; ++i)
+        {
+            for (size_t j = i + 1; j < Count; ++j)
+            {
+                if (ids[i] == ids[j])
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    static_assert(HasUniqueIds(), "Two messages hash to the same id");
+
+    template<class THandler, class T, size_t... Is>
+    static bool Invoke(THandler& aHandler, Buffer::Reader& aReader, std::index_sequence<Is...>)
+    {
+        typename T::Arguments arguments;
+        if (!(RpcSerializer<std::tuple_element_t<Is, typename T::Arguments>>::Read(aReader, std::get<Is>(arguments)) && ...))
+            return false;
+
+        aHandler.On(T{}, std::get<Is>(arguments)...);
+        return true;
+    }
+
+    template<class THandler, class T>
+    static bool Invoke(THandler& aHandler, Buffer::Reader& aReader)
+    {
+        return Invoke<THandler, T>(aHandler, aReader, std::make_index_sequence<std::tuple_size_v<typename T::Arguments>>{});
+    }
+};
+
+template<class... TMessages>
+template<class THandler>
+bool RpcProtocol<TMessages...>::Dispatch(THandler& aHandler, Buffer::Reader& aReader)
+{
+    using Invoker = bool(*)(THandler&, Buffer::Reader&);
+    static constexpr Invoker s_table[] = { &Invoke<THandler, TMessages>... };
+
+    for (;;)
+    {
+        uint64_t index;
+        if (!aReader.ReadBits(index, IndexBits) || index > Count)
+            return false;
+
+        if (index == Count)
+            return true;
+
+        if (!s_table[index](aHandler, aReader))
+            return false;
+    }
+}
+
+// Packs calls in a single datagram sent on Flush, or when the next call doesn't fit. Nothing is allocated.
+template<class TProtocol>
+class RpcBatch
+{
+public:
+
+    RpcBatch(Connection& aConnection, uint32_t aChannel)
+        : m_connection(aConnection)
+        , m_channel{aChannel}
+        , m_writer(m_data, sizeof(m_data))
+        , m_count{0}
+    {
+    }
+
+    RpcBatch(const RpcBatch&) = delete;
+    RpcBatch& operator=(const RpcBatch&) = delete;
+
+    template<class T, class... TArgs>
+    bool Call(TArgs&&... aArgs)
+    {
+        static_assert(TProtocol::template IndexOf<T>() < TProtocol::Count, "The message is not part of the protocol");
+        static_assert(sizeof...(TArgs) == std::tuple_size_v<typename T::Arguments>, "Wrong number of arguments");
+        static_assert(2 * TProtocol::IndexBits + T::Bits <= sizeof(m_data) * 8, "The message is larger than a datagram");
+
+        if (m_writer.GetRemainingBits() < 2 * TProtocol::IndexBits + T::Bits && !Flush())
+            return false;
+
+        m_writer.WriteBits(TProtocol::template IndexOf<T>(), TProtocol::IndexBits);
+        Write<T>(std::forward_as_tuple(std::forward<TArgs>(aArgs)...), std::make_index_sequence<sizeof...(TArgs)>{});
+        ++m_count;
+
+        return true;
+    }
+
+    bool Flush()
+    {
+        if (m_count == 0)
+            return true;
+
+        m_writer.WriteBits(TProtocol::Count, TProtocol::IndexBits);
+        const auto result = m_connection.Send(m_channel, m_data, (m_writer.GetBitPosition() + 7) / 8);
+
+        m_writer.Reset();
+        m_count = 0;
+
+        return result;
+    }
+
+    size_t GetPendingCount() const
+    {
+        return m_count;
+    }
+
+private:
+
+    template<class T, class TTuple, size_t... Is>
+    void Write(TTuple&& aArgs, std::index_sequence<Is...>)
+    {
+        using Arguments = typename T::Arguments;
+        (RpcSerializer<std::tuple_element_t<Is, Arguments>>::Write(m_writer, static_cast<std::tuple_element_t<Is, Arguments>>(std::get<Is>(aArgs))), ...);
+    }
+
+    Connection& m_connection;
+    uint32_t m_channel;
+    // Leaves room for forward error correction in case the channel uses it
+    uint8_t m_data[Connection::MaxPayloadSize - ForwardErrorCorrection::Overhead];
+    Buffer::Writer m_writer;
+    size_t m_count;
+};
\ No newline at end of file
@@ -1,16 +1,23 @@
-#pragma once
-
-#include "Socket.h"
-
-class Selector
-{
-public:
-    
-    Selector(Socket& aSocket);
-
-    bool IsReady() const;
-
-private:
-
-    Socket_t m_sock;
+#pragma once
+
+#include "Socket.h"
+#include <initializer_list>
+
+class Selector
+{
+public:
+    
+    Selector(Socket& aSocket);
+    Selector(std::initializer_list<Socket*> aSockets);
+
+    bool IsReady() const;
+    // Blocks until one of the sockets is readable or the timeout expires
+    bool Wait(uint64_t aTimeoutMicroseconds) const;
+
+    static constexpr size_t MaxSockets = 4;
+
+private:
+
+    Socket_t m_socks[MaxSockets];
+    size_t m_count;
 };
\ No newline at end of file
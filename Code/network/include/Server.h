@@ -1,30 +1,166 @@
-#pragma once
-
-#include "Socket.h"
-#include "ConnectionManager.h"
-
-class Server : public AllocatorCompatible
-             , public Connection::ICommunication
-{
-public:
-
-    Server();
-    ~Server();
-
-    bool Start(uint16_t aPort);
-    uint32_t Update(uint64_t aElapsedMilliSeconds);
-    uint16_t GetPort() const;
-
-    bool Send(const Endpoint& acRemoteEndpoint, Buffer aBuffer) override;
-
-protected:
-
-    bool ProcessPacket(Socket::Packet& aPacket);
-
-private:
-
-    uint32_t Work();
-
-    Socket m_v4Listener, m_v6Listener;
-    ConnectionManager m_connectionManager;
-};
\ No newline at end of file
+#pragma once
+
+#include "Socket.h"
+#include "ConnectionManager.h"
+#include "Handoff.h"
+#include "LoopbackCommunication.h"
+#include "ServerStatistics.h"
+#include "Histogram.h"
+#include "PoolAllocator.h"
+#include <memory>
+#include <vector>
+
+class Server : public AllocatorCompatible
+             , public Connection::ICommunication
+{
+public:
+
+    // Limits the work done by a single Update, whatever is left stays queued for the next one
+    struct Budget
+    {
+        size_t MaxPackets{ SIZE_MAX };
+        // 0 means unbounded
+        uint64_t MaxMicroseconds{ 0 };
+    };
+
+    struct WorkReport
+    {
+        uint32_t ProcessedPackets{ 0 };
+        // Packets from unknown endpoints dropped while backlogged
+        uint32_t ShedPackets{ 0 };
+        size_t QueuedBytes{ 0 };
+        size_t QueuedLoopbackPackets{ 0 };
+        bool Backlogged{ false };
+    };
+
+    // Trades CPU for latency, meant for machines dedicated to a single server
+    struct LowLatency
+    {
+        // Core the thread calling EnableLowLatency, which must be the one running Update and Wait, is pinned to. -1 to leave it
+        int Core{ -1 };
+        // Microseconds of kernel busy polling on reads, 0 to disable
+        uint32_t BusyPoll{ 50 };
+        // Wait spins on the sockets instead of sleeping
+        bool Spin{ true };
+        bool LockMemory{ true };
+        size_t PrefaultStack{ 512 * 1024 };
+    };
+
+    // Sizes everything the server allocates per connection so that none of it reaches the system allocator once started
+    struct CapacityPlan
+    {
+        // Connections are never removed, this counts every peer seen over the life of the process, not only live ones
+        size_t MaxConnections{ 64 };
+        // Messages each connection may keep waiting for Receive, later payloads are dropped until it catches up
+        size_t PacketsPerConnection{ 64 };
+        // Bytes of stack touched by Start so the first ticks do not fault, 0 to skip
+        size_t PrefaultStack{ 0 };
+    };
+
+    Server();
+    ~Server();
+
+    bool Start(uint16_t aPort);
+    // Received messages hold blocks of the packet pool and must be released before the server is destroyed
+    bool Start(uint16_t aPort, const CapacityPlan& acPlan);
+    // Ticks the Clock, the cached time stays valid until the next Update
+    uint32_t Update();
+    // Sleeps until a packet arrives or the timeout, in nanoseconds, expires. Meant as the idle step of a TickScheduler
+    bool Wait(uint64_t aTimeout);
+    uint16_t GetPort() const;
+    size_t GetConnectionCount() const;
+
+    // Applies every setting it can, returns false if one of them was refused
+    bool EnableLowLatency(const LowLatency& acConfig);
+    // How late Wait returned after a timeout with nothing received, in nanoseconds, recorded in both modes so they
+    // can be compared. This is the overshoot of the idle timer, not the delay between a packet and its wakeup
+    const Histogram& GetTimerOvershoot() const;
+    void ResetTimerOvershoot();
+
+    // Publishes the counters in a shared memory segment after every Update, apAllocator's usage is included if set
+    bool EnableStatistics(const std::string& acName, const Allocator* apAllocator = nullptr);
+
+    // Null unless started with a capacity plan
+    const PoolAllocator* GetPacketPool() const;
+
+    void SetBudget(const Budget& acBudget);
+    const WorkReport& GetWorkReport() const;
+    Connection* GetConnection(const Endpoint& acRemoteEndpoint);
+    // Returns each new peer once, after its handshake completed, or nullptr if none is waiting
+    Connection* Accept();
+
+    // In-process peers, their packets are drained alongside the sockets
+    void Attach(LoopbackCommunication& aCommunication);
+    // Connections that came through aCommunication are closed, it can be destroyed afterwards
+    void Detach(LoopbackCommunication& aCommunication);
+
+    // Hot restart: the running process listens for its successor and hands over its sockets and connections
+    bool EnableHandoff(const std::string& acPath);
+    bool IsHandedOff() const;
+    // Replaces Start in the successor process
+    bool Resume(const std::string& acPath);
+    // The table grows to hold every connection handed over even if the plan is smaller
+    bool Resume(const std::string& acPath, const CapacityPlan& acPlan);
+
+    bool Send(const Endpoint& acRemoteEndpoint, Buffer aBuffer) override;
+
+    // Sends the same payload to every connected peer. Each copy is encrypted straight from the shared payload into
+    // the socket's send slab and every socket flushes its batch in one call. Returns the number of peers reached.
+    size_t Broadcast(uint32_t aChannel, const uint8_t* apData, size_t aLength);
+    // Only peers for which aFilter(const Connection&) returns true are reached
+    template<class T>
+    size_t Broadcast(uint32_t aChannel, const uint8_t* apData, size_t aLength, T&& aFilter);
+
+protected:
+
+    bool ProcessPacket(Socket::Packet& aPacket, Connection::ICommunication& aCommunication);
+    bool ProcessPacket(const uint8_t* apData, size_t aLength, const Endpoint& acRemote);
+
+private:
+
+    uint32_t Work();
+    bool Reserve(const CapacityPlan& acPlan);
+    void Publish(uint64_t aStart);
+    bool Enqueue(Connection& aConnection, uint32_t aChannel, const uint8_t* apData, size_t aLength);
+    bool Transfer();
+    Connection* Route(const Endpoint& acRemote, Connection::ICommunication& aCommunication);
+
+    // Declared first so the connections release their buffers before it goes away
+    std::unique_ptr<PoolAllocator> m_pPacketPool;
+    size_t m_packetsPerConnection;
+    Socket m_v4Listener, m_v6Listener;
+    ConnectionManager m_connectionManager;
+    Handoff m_handoff;
+    bool m_handedOff;
+    std::vector<LoopbackCommunication*> m_loopbacks;
+    // Connections created by Route that Accept has not returned yet
+    std::vector<Connection*> m_unaccepted;
+    Budget m_budget;
+    WorkReport m_workReport;
+    ServerStatistics m_statistics;
+    const Allocator* m_pStatisticsAllocator;
+    uint64_t m_tick;
+    uint64_t m_lastTickStart;
+    uint64_t m_maxTickDuration;
+    bool m_spin;
+    Histogram m_timerOvershoot;
+};
+
+template<class T>
+size_t Server::Broadcast(uint32_t aChannel, const uint8_t* apData, size_t aLength, T&& aFilter)
+{
+    size_t count = 0;
+    const auto dropped = m_v4Listener.GetDroppedCount() + m_v6Listener.GetDroppedCount();
+
+    m_connectionManager.ForEach([&](Connection& aConnection)
+    {
+        if (aConnection.IsConnected() && aFilter((const Connection&)aConnection) && Enqueue(aConnection, aChannel, apData, aLength))
+            ++count;
+    });
+
+    m_v4Listener.Flush();
+    m_v6Listener.Flush();
+
+    // Copies the kernel refused did not reach their peer, those left queued go out on the next flush
+    return count - (size_t)(m_v4Listener.GetDroppedCount() + m_v6Listener.GetDroppedCount() - dropped);
+}
\ No newline at end of file
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "SharedMemory.h"
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// Counters published by a Server in a named shared memory segment. The server writes them once per tick under a
+// sequence lock, readers in other processes copy them and retry if a write happened meanwhile, neither side waits.
+class ServerStatistics
+{
+public:
+
+    static constexpr uint32_t Magic = 0x53574F44;
+    static constexpr uint32_t Version = 1;
+    static constexpr size_t MaxConnections = 256;
+
+    struct Peer
+    {
+        // Network order, only the first 4 bytes are used by IPv4
+        uint8_t Address[16];
+        uint16_t Port;
+        uint8_t IPv6;
+        uint8_t State;
+        uint32_t Padding;
+        uint64_t RoundTrip;
+        uint64_t SentPackets;
+        uint64_t SentBytes;
+        uint64_t ReceivedPackets;
+        uint64_t ReceivedBytes;
+        uint64_t DroppedPackets;
+    };
+
+    // Durations are in nanoseconds
+    struct Snapshot
+    {
+        uint64_t Tick;
+        uint64_t Timestamp;
+        uint64_t TickInterval;
+        uint64_t TickDuration;
+        uint64_t MaxTickDuration;
+        uint64_t ProcessedPackets;
+        uint64_t ShedPackets;
+        uint64_t QueuedBytes;
+        uint64_t AllocatedBytes;
+        uint32_t ConnectionCount;
+        // Connections past MaxConnections are counted but not listed
+        uint32_t ListedCount;
+        Peer Connections[MaxConnections];
+    };
+
+    ServerStatistics();
+    ~ServerStatistics();
+
+    bool Create(const std::string& acName);
+    bool Open(const std::string& acName);
+    bool IsValid() const;
+
+    // Writer side, the snapshot returned by Begin must only be modified until End
+    Snapshot& Begin();
+    void End();
+
+    // Reader side, fails if the writer kept updating for all the attempts
+    bool Read(Snapshot& aSnapshot, size_t aAttempts = 100) const;
+
+private:
+
+    struct Segment
+    {
+        uint32_t Magic;
+        uint32_t Version;
+        // Odd while the snapshot is being written
+        std::atomic<uint64_t> Sequence;
+        Snapshot Data;
+    };
+
+    static_assert(std::atomic<uint64_t>::is_always_lock_free, "The sequence is shared between processes");
+
+    SharedMemory m_memory;
+    Segment* m_pSegment;
+};
\ No newline at end of file
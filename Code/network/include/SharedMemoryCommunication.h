@@ -0,0 +1,48 @@
+#pragma once
+
+#include "Connection.h"
+#include "Socket.h"
+#include "RingBuffer.h"
+#include "SharedMemory.h"
+
+// Connection transport for peers on the same host, packets go through a pair of rings in a shared memory segment.
+// Unlike loopback it is not attached to a Server: the peer wakes us through a futex the server selector cannot wait
+// on, so the owner drives it with Wait and Receive on its own thread and feeds Connection::ProcessPacket.
+class SharedMemoryCommunication : public Connection::ICommunication
+{
+public:
+
+    // acRemote is the logical address reported for packets coming from the peer
+    SharedMemoryCommunication(const Endpoint& acRemote);
+
+    bool Create(const std::string& acName, size_t aRingCapacity = 1 << 20);
+    bool Open(const std::string& acName);
+
+    bool Send(const Endpoint& acRemote, Buffer aBuffer) override;
+    Outcome<Socket::Packet, Socket::Error> Receive();
+
+    // Blocks until a packet is available or the timeout expires
+    bool Wait(uint64_t aTimeoutMicroseconds);
+
+    bool IsReady() const;
+
+private:
+
+    struct Control
+    {
+        uint32_t Magic;
+        uint32_t RingCapacity;
+        // Indexed by the receiving side
+        std::atomic<uint32_t> Signal[2];
+        std::atomic<uint32_t> Waiting[2];
+    };
+
+    bool Attach(bool aInitialize);
+
+    SharedMemory m_memory;
+    Control* m_pControl;
+    RingBuffer m_send;
+    RingBuffer m_receive;
+    uint32_t m_side;
+    Endpoint m_remote;
+};
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "Buffer.h"
+#include <cstdint>
+#include <vector>
+
+// Past world states for delta compression, shared by every peer. The last Window ticks are kept so that any of them
+// can be acknowledged, older ones only survive while a peer uses them as its baseline. Memory grows with the number
+// of distinct baselines, which peers acknowledging at the same rate share, instead of with peers times ticks.
+class SnapshotHistory
+{
+public:
+
+    static constexpr uint32_t InvalidSlot = ~0u;
+
+    struct Snapshot
+    {
+        const uint8_t* GetData() const { return Data.GetData(); }
+        size_t GetSize() const { return Size; }
+        uint32_t GetTick() const { return Tick; }
+
+        uint32_t Tick;
+        // One for being in the window plus one per baseline
+        uint32_t References;
+        size_t Size;
+        // Kept when the slot is freed so that a later snapshot of the same size does not allocate
+        Buffer Data;
+    };
+
+    // What a peer keeps: a reference to the last snapshot it acknowledged
+    class Baseline
+    {
+    public:
+
+        Baseline(SnapshotHistory& aHistory);
+        ~Baseline();
+
+        Baseline(const Baseline&) = delete;
+        Baseline& operator=(const Baseline&) = delete;
+
+        // Moves the baseline to a tick the peer acknowledged, fails if that tick already left the window.
+        // Older acknowledgements, arriving out of order, are ignored.
+        bool Acknowledge(uint32_t aTick);
+        // The snapshot to compute deltas against, nullptr means the peer needs the full state
+        const Snapshot* Get() const;
+        void Reset();
+
+    private:
+
+        SnapshotHistory& m_history;
+        uint32_t m_slot;
+        uint32_t m_tick;
+    };
+
+    // Capacity bounds the snapshots alive at once, when it is exhausted the oldest baselines are dropped
+    SnapshotHistory(size_t aWindow, size_t aCapacity);
+
+    SnapshotHistory(const SnapshotHistory&) = delete;
+    SnapshotHistory& operator=(const SnapshotHistory&) = delete;
+
+    // Ticks must increase, the tick that leaves the window is freed unless a baseline holds it
+    bool Push(uint32_t aTick, const uint8_t* apData, size_t aSize);
+    const Snapshot* Find(uint32_t aTick) const;
+
+    const Snapshot* GetLatest() const;
+    size_t GetSnapshotCount() const;
+    // Bytes held by the live snapshots
+    size_t GetUsedMemory() const;
+    size_t GetWindow() const;
+
+private:
+
+    uint32_t FindSlot(uint32_t aTick) const;
+    uint32_t AllocateSlot();
+    void AddReference(uint32_t aSlot);
+    void RemoveReference(uint32_t aSlot);
+    bool IsValid(uint32_t aSlot, uint32_t aTick) const;
+
+    std::vector<Snapshot> m_snapshots;
+    std::vector<uint32_t> m_free;
+    // Slot of each tick in the window, indexed by tick modulo the window
+    std::vector<uint32_t> m_window;
+    uint32_t m_latest;
+    bool m_empty;
+    size_t m_count;
+    size_t m_usedMemory;
+};
\ No newline at end of file
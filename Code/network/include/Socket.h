@@ -1,48 +1,113 @@
-#pragma once
-
-#include "Network.h"
-#include "Outcome.h"
-#include "Buffer.h"
-#include "Endpoint.h"
-
-class Socket
-{
-public:
-
-    enum Error
-    {
-        kInvalidSocket,
-        kDiscardError,
-        kCallFailure
-    };
-
-    struct Packet
-    {
-        Endpoint Remote;
-        Buffer Payload;
-    };
-
-    Socket(Endpoint::Type aEndpointType = Endpoint::kIPv6, bool aBlocking = true);
-    ~Socket();
-
-    Outcome<Packet, Error> Receive();
-    bool Send(const Packet& aBuffer);
-    bool Bind(uint16_t aPort = 0);
-
-    uint16_t GetPort() const;
-
-protected:
-
-    bool Bindv6(uint16_t aPort);
-    bool Bindv4(uint16_t aPort);
-
-private:
-
-    friend class Selector;
-
-    static constexpr size_t MaxPacketSize = 1200;
-
-    Socket_t m_sock;
-    uint16_t m_port;
-    Endpoint::Type m_type;
-};
\ No newline at end of file
+#pragma once
+
+#include "Network.h"
+#include "Outcome.h"
+#include "Buffer.h"
+#include "Endpoint.h"
+#include <cstdint>
+
+class Socket
+{
+public:
+
+    enum Error
+    {
+        kInvalidSocket,
+        kDiscardError,
+        kCallFailure
+    };
+
+    struct Packet
+    {
+        Endpoint Remote;
+        Buffer Payload;
+    };
+
+    Socket(Endpoint::Type aEndpointType = Endpoint::kIPv6, bool aBlocking = true);
+    ~Socket();
+
+    Outcome<Packet, Error> Receive();
+
+    // Calls aCallback(const uint8_t* apData, size_t aLength, const Endpoint& acRemote) for every waiting datagram, up to aMaxPackets.
+    // The data lives in the receive slab and is only valid for the duration of the call.
+    template<class T>
+    size_t ReceiveAll(T&& aCallback, size_t aMaxPackets = SIZE_MAX);
+
+    bool Send(const Packet& aBuffer);
+
+    // Batched sends: datagrams are written in place in the send slab and all go out in a single call on Flush.
+    // Reserve returns nullptr once the slab is full.
+    uint8_t* Reserve();
+    void Commit(const Endpoint& acRemote, size_t aLength);
+    // Returns the number of datagrams handed to the kernel. Refused ones are dropped and counted, those that did not
+    // fit in a full kernel queue stay in the slab for the next Flush.
+    size_t Flush();
+    size_t GetPendingCount() const;
+    uint64_t GetDroppedCount() const;
+    bool Bind(uint16_t aPort = 0);
+
+    // Lets the kernel poll the device queue for this long before blocking on a read, Linux only and usually privileged
+    bool EnableBusyPoll(uint32_t aMicroseconds);
+
+    uint16_t GetPort() const;
+    // Bytes waiting in the kernel receive queue, an approximation on platforms that cannot report it
+    size_t GetQueuedBytes() const;
+
+    static constexpr size_t ReceiveBatchSize = 16;
+    static constexpr size_t SendBatchSize = 64;
+    static constexpr size_t MaxPacketSize = 1200;
+
+protected:
+
+    bool Bindv6(uint16_t aPort);
+    bool Bindv4(uint16_t aPort);
+
+    // Takes ownership of a socket that was bound elsewhere
+    void Adopt(Socket_t aSock);
+
+    // Fills the receive slab without blocking, returns the number of datagrams read
+    size_t ReceiveBatch(size_t aMaxCount);
+
+private:
+
+    friend class Selector;
+    friend class Handoff;
+
+    Socket_t m_sock;
+    uint16_t m_port;
+    Endpoint::Type m_type;
+
+    Buffer m_slab;
+    size_t m_slabLengths[ReceiveBatchSize];
+    Endpoint m_slabEndpoints[ReceiveBatchSize];
+
+    Buffer m_sendSlab;
+    size_t m_sendLengths[SendBatchSize];
+    Endpoint m_sendEndpoints[SendBatchSize];
+    size_t m_sendCount;
+    uint64_t m_droppedCount;
+};
+
+template<class T>
+size_t Socket::ReceiveAll(T&& aCallback, size_t aMaxPackets)
+{
+    size_t total = 0;
+
+    while (total < aMaxPackets)
+    {
+        const auto requested = aMaxPackets - total < ReceiveBatchSize ? aMaxPackets - total : ReceiveBatchSize;
+        const auto count = ReceiveBatch(requested);
+        for (size_t i = 0; i < count; ++i)
+        {
+            aCallback((const uint8_t*)m_slab.GetData() + i * MaxPacketSize, m_slabLengths[i], (const Endpoint&)m_slabEndpoints[i]);
+        }
+
+        total += count;
+
+        // A partial batch means the socket is drained
+        if (count < requested)
+            break;
+    }
+
+    return total;
+}
\ No newline at end of file
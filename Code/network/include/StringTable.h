@@ -0,0 +1,83 @@
+#pragma once
+
+#include "Buffer.h"
+#include "Clock.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Interns the strings sent on a connection, each end owns one table and both use the same capacity.
+// A string is sent with its id until the other end acknowledges it, then only the id is sent. The sender picks
+// which slot to reuse so the receiver just overwrites its copy and both stay in sync.
+class StringTable
+{
+public:
+
+    static constexpr size_t MaxLength = 255;
+    // A slot is only reused once it hasn't been referenced for this long so late packets can't read the new string
+    static constexpr uint64_t ReuseDelay = Clock::Seconds(1);
+
+    StringTable(uint32_t aCapacity = 1024);
+
+    // Returns false if the string is too long or doesn't fit, nothing is written in that case
+    bool Write(Buffer::Writer& aWriter, std::string_view aString, uint64_t aNow);
+    // The view is valid until the slot is overwritten or the next Read
+    bool Read(Buffer::Reader& aReader, std::string_view& aString);
+
+    // Definitions received since the last call, to send back to the writer
+    bool WriteAcknowledgements(Buffer::Writer& aWriter);
+    bool ReadAcknowledgements(Buffer::Reader& aReader);
+    bool HasAcknowledgements() const;
+
+    uint32_t GetCapacity() const;
+    size_t GetIdBits() const;
+    size_t GetSize() const;
+
+private:
+
+    static constexpr uint32_t Empty = ~0u;
+
+    struct LocalEntry
+    {
+        std::string Text;
+        size_t Hash{ 0 };
+        uint64_t LastUse{ 0 };
+        uint32_t Previous{ Empty };
+        uint32_t Next{ Empty };
+        uint8_t Generation{ 0 };
+        bool Acknowledged{ false };
+    };
+
+    struct RemoteEntry
+    {
+        std::string Text;
+        uint8_t Generation{ 0 };
+    };
+
+    struct Acknowledgement
+    {
+        uint32_t Id;
+        uint8_t Generation;
+    };
+
+    uint32_t Find(std::string_view aString, size_t aHash) const;
+    void Insert(uint32_t aId);
+    void Erase(uint32_t aId);
+    void Unlink(uint32_t aId);
+    void PushFront(uint32_t aId);
+
+    uint32_t m_capacity;
+    size_t m_idBits;
+
+    // Sender side, the flat hash maps strings to ids and the entries form a most recently used list
+    std::vector<LocalEntry> m_local;
+    std::vector<uint32_t> m_buckets;
+    uint32_t m_head;
+    uint32_t m_tail;
+
+    // Receiver side
+    std::vector<RemoteEntry> m_remote;
+    std::vector<Acknowledgement> m_acknowledgements;
+    std::string m_literal;
+};
\ No newline at end of file
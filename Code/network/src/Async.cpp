@@ -0,0 +1,166 @@
+#include "Async.h"
+
+#ifdef __cpp_impl_coroutine
+
+#include <algorithm>
+#include <exception>
+
+namespace
+{
+    // Room in front of the frame for the allocator that has to free it, keeps the frame aligned
+    constexpr size_t s_headerSize = alignof(std::max_align_t);
+}
+
+void AsyncTask::promise_type::unhandled_exception() noexcept
+{
+    std::terminate();
+}
+
+void* AsyncTask::promise_type::operator new(size_t aSize) noexcept
+{
+    auto* pAllocator = Allocator::Get();
+
+    auto* pData = static_cast<uint8_t*>(pAllocator->Allocate(aSize + s_headerSize));
+    if (pData == nullptr)
+        return nullptr;
+
+    *reinterpret_cast<Allocator**>(pData) = pAllocator;
+    return pData + s_headerSize;
+}
+
+void AsyncTask::promise_type::operator delete(void* apData) noexcept
+{
+    auto* pData = static_cast<uint8_t*>(apData) - s_headerSize;
+    (*reinterpret_cast<Allocator**>(pData))->Free(pData);
+}
+
+AsyncTask::AsyncTask(std::coroutine_handle<promise_type> aHandle) noexcept
+    : m_handle(aHandle)
+{
+}
+
+AsyncTask::AsyncTask(AsyncTask&& aRhs) noexcept
+    : m_handle(std::exchange(aRhs.m_handle, nullptr))
+{
+}
+
+AsyncTask& AsyncTask::operator=(AsyncTask&& aRhs) noexcept
+{
+    std::swap(m_handle, aRhs.m_handle);
+
+    return *this;
+}
+
+AsyncTask::~AsyncTask()
+{
+    // The awaiter in the frame unregisters itself from its loop as it is destroyed
+    if (m_handle)
+        m_handle.destroy();
+}
+
+bool AsyncTask::IsValid() const
+{
+    return (bool)m_handle;
+}
+
+bool AsyncTask::IsDone() const
+{
+    return m_handle && m_handle.done();
+}
+
+AsyncWaiter::~AsyncWaiter()
+{
+    if (Registered)
+        pLoop->Remove(*this);
+}
+
+void AsyncWaiter::await_suspend(std::coroutine_handle<> aHandle)
+{
+    Handle = aHandle;
+    pLoop->Add(*this);
+}
+
+bool AsyncLoop::AcceptAwaiter::Ready(AsyncWaiter& aWaiter)
+{
+    auto& self = static_cast<AcceptAwaiter&>(aWaiter);
+    self.pConnection = self.pServer->Accept();
+
+    return self.pConnection != nullptr;
+}
+
+bool AsyncLoop::HandshakeAwaiter::Ready(AsyncWaiter& aWaiter)
+{
+    auto& self = static_cast<HandshakeAwaiter&>(aWaiter);
+
+    return self.pConnection->IsConnected() || self.pConnection->GetState() == Connection::kNone;
+}
+
+bool AsyncLoop::ReceiveAwaiter::Ready(AsyncWaiter& aWaiter)
+{
+    auto& self = static_cast<ReceiveAwaiter&>(aWaiter);
+    self.Received = self.pConnection->Receive(*self.pMessage);
+
+    return self.Received || self.pConnection->GetState() == Connection::kNone;
+}
+
+size_t AsyncLoop::Poll()
+{
+    // Coroutines resumed below can suspend again, they land in m_waiters and wait for the next call. Entries are
+    // cleared as they are visited so that a cancellation only has to look for the ones still ahead.
+    std::swap(m_waiters, m_polling);
+
+    size_t resumed = 0;
+    for (size_t i = 0; i < m_polling.size(); ++i)
+    {
+        auto* pWaiter = m_polling[i];
+
+        // Cancelled by a coroutine resumed earlier in this pass
+        if (pWaiter == nullptr)
+            continue;
+
+        m_polling[i] = nullptr;
+
+        if (!pWaiter->pReady(*pWaiter))
+        {
+            m_waiters.push_back(pWaiter);
+            continue;
+        }
+
+        pWaiter->Registered = false;
+
+        pWaiter->Handle.resume();
+        ++resumed;
+    }
+
+    m_polling.clear();
+
+    return resumed;
+}
+
+size_t AsyncLoop::GetWaitingCount() const
+{
+    return m_waiters.size() + std::count_if(std::begin(m_polling), std::end(m_polling), [](AsyncWaiter* apWaiter) { return apWaiter != nullptr; });
+}
+
+void AsyncLoop::Add(AsyncWaiter& aWaiter)
+{
+    aWaiter.Registered = true;
+    m_waiters.push_back(&aWaiter);
+}
+
+void AsyncLoop::Remove(AsyncWaiter& aWaiter)
+{
+    aWaiter.Registered = false;
+
+    auto itor = std::find(std::begin(m_waiters), std::end(m_waiters), &aWaiter);
+    if (itor != std::end(m_waiters))
+    {
+        *itor = m_waiters.back();
+        m_waiters.pop_back();
+        return;
+    }
+
+    std::replace(std::begin(m_polling), std::end(m_polling), &aWaiter, (AsyncWaiter*)nullptr);
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,323 @@
+#include "BulkTransfer.h"
+#include "Socket.h"
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    void WriteLittleEndian(uint8_t* apOutput, uint64_t aValue, size_t aBytes)
+    {
+        for (size_t i = 0; i < aBytes; ++i)
+            apOutput[i] = (uint8_t)(aValue >> (i * 8));
+    }
+
+    uint64_t ReadLittleEndian(const uint8_t* apInput, size_t aBytes)
+    {
+        uint64_t value = 0;
+        for (size_t i = 0; i < aBytes; ++i)
+            value |= uint64_t(apInput[i]) << (i * 8);
+
+        return value;
+    }
+
+    bool TestBit(const std::vector<uint64_t>& acBits, size_t aIndex)
+    {
+        return (acBits[aIndex >> 6] >> (aIndex & 63)) & 1;
+    }
+
+    void SetBit(std::vector<uint64_t>& aBits, size_t aIndex)
+    {
+        aBits[aIndex >> 6] |= uint64_t(1) << (aIndex & 63);
+    }
+}
+
+BulkSender::BulkSender(uint32_t aChannel, uint16_t aId)
+    : m_pData{nullptr}
+    , m_size{0}
+    , m_channel{aChannel}
+    , m_id{aId}
+    , m_fragmentCount{0}
+    , m_base{0}
+    , m_next{0}
+    , m_highest{0}
+    , m_acknowledgedCount{0}
+    , m_retransmitCount{0}
+    , m_sentAt(WindowSize, 0)
+{
+}
+
+bool BulkSender::Open(const std::string& acPath)
+{
+    if (!m_file.Open(acPath))
+        return false;
+
+    m_file.AdviseSequential();
+    Attach(m_file.GetData(), m_file.GetSize());
+
+    return true;
+}
+
+void BulkSender::Attach(const uint8_t* apData, size_t aSize)
+{
+    m_pData = apData;
+    m_size = aSize;
+    m_fragmentCount = (aSize + BulkTransfer::FragmentSize - 1) / BulkTransfer::FragmentSize;
+    m_base = m_next = m_highest = 0;
+    m_acknowledgedCount = m_retransmitCount = 0;
+
+    m_acknowledged.assign((m_fragmentCount + 63) / 64, 0);
+    std::fill(m_sentAt.begin(), m_sentAt.end(), 0);
+}
+
+size_t BulkSender::Update(Connection& aConnection, size_t aMaxFragments)
+{
+    return Update(aConnection, nullptr, aMaxFragments);
+}
+
+size_t BulkSender::Update(Connection& aConnection, Socket& aSocket, size_t aMaxFragments)
+{
+    return Update(aConnection, &aSocket, aMaxFragments);
+}
+
+size_t BulkSender::Update(Connection& aConnection, Socket* apSocket, size_t aMaxFragments)
+{
+    if (!aConnection.IsConnected())
+        return 0;
+
+    const auto now = Clock::GetTimestamp();
+
+    // Losses are detected from the acks of later fragments, the timeout only covers lost acks and tail losses
+    const auto roundTrip = std::max(aConnection.GetClockSync().GetRoundTrip(), Clock::Microseconds(500));
+    const auto lossDelay = roundTrip * 2;
+    const auto timeout = std::max(roundTrip * 4, Clock::Milliseconds(100));
+
+    size_t sent = 0;
+    for (size_t i = m_base; i < m_next && sent < aMaxFragments; ++i)
+    {
+        if (IsAcknowledged(i))
+            continue;
+
+        const auto elapsed = now - m_sentAt[i % WindowSize];
+        if ((m_highest > i + 3 && elapsed > lossDelay) || elapsed > timeout)
+        {
+            if (!SendFragment(aConnection, apSocket, i, now))
+                return sent;
+
+            ++m_retransmitCount;
+            ++sent;
+        }
+    }
+
+    for (; sent < aMaxFragments && m_next < m_fragmentCount && m_next < m_base + WindowSize; ++m_next, ++sent)
+    {
+        if (!SendFragment(aConnection, apSocket, m_next, now))
+            break;
+    }
+
+    return sent;
+}
+
+bool BulkSender::Process(const Connection::Message& acMessage)
+{
+    const auto* pData = acMessage.GetData();
+    if (acMessage.Channel != m_channel || acMessage.GetSize() != BulkTransfer::AckSize || pData[0] != BulkTransfer::kAck)
+        return false;
+
+    if (ReadLittleEndian(pData + 1, 2) != m_id)
+        return false;
+
+    const auto cumulative = std::min<size_t>(ReadLittleEndian(pData + 3, 4), m_next);
+    for (size_t i = m_base; i < cumulative; ++i)
+        Acknowledge(i);
+
+    const auto* pBits = pData + 7;
+    for (size_t bit = 0; bit < BulkTransfer::AckBits; ++bit)
+    {
+        if ((pBits[bit >> 3] >> (bit & 7)) & 1)
+        {
+            const auto index = cumulative + bit;
+            if (index >= m_next)
+                break;
+
+            Acknowledge(index);
+        }
+    }
+
+    while (m_base < m_next && IsAcknowledged(m_base))
+        ++m_base;
+
+    return true;
+}
+
+bool BulkSender::IsComplete() const
+{
+    return m_acknowledgedCount == m_fragmentCount;
+}
+
+size_t BulkSender::GetFragmentCount() const
+{
+    return m_fragmentCount;
+}
+
+size_t BulkSender::GetAcknowledgedCount() const
+{
+    return m_acknowledgedCount;
+}
+
+size_t BulkSender::GetRetransmitCount() const
+{
+    return m_retransmitCount;
+}
+
+bool BulkSender::SendFragment(Connection& aConnection, Socket* apSocket, size_t aIndex, uint64_t aNow)
+{
+    const auto offset = aIndex * BulkTransfer::FragmentSize;
+    const auto length = std::min(BulkTransfer::FragmentSize, m_size - offset);
+
+    auto* pSlot = apSocket ? apSocket->Reserve() : nullptr;
+    if (apSocket && pSlot == nullptr)
+    {
+        apSocket->Flush();
+        pSlot = apSocket->Reserve();
+    }
+
+    // With a slot the data is copied once, from the mapping into the datagram, and encrypted there
+    uint8_t fragment[Connection::MaxPayloadSize];
+    auto* pPayload = pSlot ? pSlot + Connection::HeaderSize : fragment;
+    pPayload[0] = BulkTransfer::kFragment;
+    WriteLittleEndian(pPayload + 1, m_id, 2);
+    WriteLittleEndian(pPayload + 3, aIndex, 4);
+    WriteLittleEndian(pPayload + 7, m_size, 6);
+    std::memcpy(pPayload + BulkTransfer::HeaderSize, m_pData + offset, length);
+
+    // Channels with parity packets, and fragments that find the slab still full, take the regular path
+    const auto size = pSlot ? aConnection.WritePacket(m_channel, BulkTransfer::HeaderSize + length, pSlot) : 0;
+    if (size != 0)
+        apSocket->Commit(aConnection.GetRemoteEndpoint(), size);
+    else if (!aConnection.Send(m_channel, pPayload, BulkTransfer::HeaderSize + length))
+        return false;
+
+    m_sentAt[aIndex % WindowSize] = aNow;
+
+    return true;
+}
+
+void BulkSender::Acknowledge(size_t aIndex)
+{
+    if (IsAcknowledged(aIndex))
+        return;
+
+    SetBit(m_acknowledged, aIndex);
+    ++m_acknowledgedCount;
+
+    m_highest = std::max(m_highest, aIndex + 1);
+}
+
+bool BulkSender::IsAcknowledged(size_t aIndex) const
+{
+    return TestBit(m_acknowledged, aIndex);
+}
+
+BulkReceiver::BulkReceiver(uint32_t aChannel, const std::string& acPath, size_t aMaxSize)
+    : m_path{acPath}
+    , m_channel{aChannel}
+    , m_id{0}
+    , m_started{false}
+    , m_maxSize{aMaxSize}
+    , m_size{0}
+    , m_fragmentCount{0}
+    , m_cumulative{0}
+    , m_receivedCount{0}
+    , m_pendingAcks{0}
+{
+}
+
+bool BulkReceiver::Process(Connection& aConnection, const Connection::Message& acMessage)
+{
+    const auto* pData = acMessage.GetData();
+    if (acMessage.Channel != m_channel || acMessage.GetSize() < BulkTransfer::HeaderSize || pData[0] != BulkTransfer::kFragment)
+        return false;
+
+    const auto id = (uint16_t)ReadLittleEndian(pData + 1, 2);
+    const auto index = (size_t)ReadLittleEndian(pData + 3, 4);
+    const auto size = (size_t)ReadLittleEndian(pData + 7, 6);
+
+    if (!m_started)
+    {
+        // The size comes from the peer, it must not get to pick how much disk and address space we commit
+        if (size > m_maxSize || !m_file.Create(m_path, size))
+            return false;
+
+        m_id = id;
+        m_size = size;
+        m_fragmentCount = (size + BulkTransfer::FragmentSize - 1) / BulkTransfer::FragmentSize;
+        m_received.assign((m_fragmentCount + 63) / 64, 0);
+        m_started = true;
+    }
+
+    if (id != m_id || size != m_size || index >= m_fragmentCount)
+        return false;
+
+    const auto offset = index * BulkTransfer::FragmentSize;
+    const auto length = acMessage.GetSize() - BulkTransfer::HeaderSize;
+    if (length != std::min(BulkTransfer::FragmentSize, m_size - offset))
+        return false;
+
+    // Duplicates still get acknowledged, the previous ack may have been lost
+    if (!IsReceived(index))
+    {
+        std::memcpy(m_file.GetWriteData() + offset, pData + BulkTransfer::HeaderSize, length);
+
+        SetBit(m_received, index);
+        ++m_receivedCount;
+
+        while (m_cumulative < m_fragmentCount && IsReceived(m_cumulative))
+            ++m_cumulative;
+    }
+
+    if (++m_pendingAcks >= AckInterval || IsComplete())
+        Flush(aConnection);
+
+    return true;
+}
+
+void BulkReceiver::Flush(Connection& aConnection)
+{
+    if (m_pendingAcks == 0)
+        return;
+
+    uint8_t ack[BulkTransfer::AckSize] = {};
+    ack[0] = BulkTransfer::kAck;
+    WriteLittleEndian(ack + 1, m_id, 2);
+    WriteLittleEndian(ack + 3, m_cumulative, 4);
+
+    auto* pBits = ack + 7;
+    for (size_t bit = 0; bit < BulkTransfer::AckBits && m_cumulative + bit < m_fragmentCount; ++bit)
+    {
+        if (IsReceived(m_cumulative + bit))
+            pBits[bit >> 3] |= 1 << (bit & 7);
+    }
+
+    if (aConnection.Send(m_channel, ack, sizeof(ack)))
+        m_pendingAcks = 0;
+}
+
+bool BulkReceiver::IsComplete() const
+{
+    return m_started && m_receivedCount == m_fragmentCount;
+}
+
+size_t BulkReceiver::GetSize() const
+{
+    return m_size;
+}
+
+const uint8_t* BulkReceiver::GetData() const
+{
+    return m_file.GetData();
+}
+
+bool BulkReceiver::IsReceived(size_t aIndex) const
+{
+    return TestBit(m_received, aIndex);
+}
\ No newline at end of file
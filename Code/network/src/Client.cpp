@@ -0,0 +1,131 @@
+#include "Client.h"
+#include "Selector.h"
+
+Client::Client(Endpoint::Type aType)
+    : m_socket(aType, false)
+    , m_type(aType)
+{
+
+}
+
+Client::~Client()
+{
+}
+
+bool Client::Connect(const Endpoint& acRemote)
+{
+    if (acRemote.GetType() != m_type)
+        return false;
+
+    if (m_socket.GetPort() == 0 && !m_socket.Bind())
+        return false;
+
+    m_pConnection = std::make_unique<Connection>(*this, acRemote);
+    m_pConnection->Update(Clock::Tick());
+
+    return true;
+}
+
+void Client::Disconnect()
+{
+    m_socket.Flush();
+    m_pConnection.reset();
+}
+
+uint32_t Client::Update()
+{
+    const auto now = Clock::Tick();
+
+    uint32_t processed = 0;
+
+    // Datagrams from anyone but the server are dropped
+    m_socket.ReceiveAll([this, &processed](const uint8_t* apData, size_t aLength, const Endpoint& acRemote)
+    {
+        if (m_pConnection && m_pConnection->GetRemoteEndpoint() == acRemote && m_pConnection->ProcessPacket(apData, aLength))
+            ++processed;
+    });
+
+    if (m_pConnection)
+        m_pConnection->Update(now);
+
+    Flush();
+
+    return processed;
+}
+
+bool Client::Wait(uint64_t aTimeout)
+{
+    Selector selector(m_socket);
+
+    return selector.Wait(aTimeout / 1000);
+}
+
+bool Client::Send(uint32_t aChannel, const uint8_t* apData, size_t aLength)
+{
+    if (!m_pConnection)
+        return false;
+
+    auto* pSlot = m_socket.Reserve();
+    if (pSlot == nullptr)
+    {
+        m_socket.Flush();
+        pSlot = m_socket.Reserve();
+    }
+
+    // Channels with parity packets, and packets that find the slab still full, take the regular path
+    const auto size = pSlot ? m_pConnection->WritePacket(aChannel, apData, aLength, pSlot) : 0;
+    if (size == 0)
+        return m_pConnection->Send(aChannel, apData, aLength);
+
+    m_socket.Commit(m_pConnection->GetRemoteEndpoint(), size);
+
+    return true;
+}
+
+bool Client::SendImmediate(uint32_t aChannel, const uint8_t* apData, size_t aLength)
+{
+    if (!Send(aChannel, apData, aLength))
+        return false;
+
+    Flush();
+
+    return true;
+}
+
+size_t Client::Flush()
+{
+    return m_socket.Flush();
+}
+
+bool Client::Receive(Connection::Message& aMessage)
+{
+    return m_pConnection && m_pConnection->Receive(aMessage);
+}
+
+bool Client::IsConnected() const
+{
+    return m_pConnection && m_pConnection->IsConnected();
+}
+
+Connection::State Client::GetState() const
+{
+    return m_pConnection ? m_pConnection->GetState() : Connection::kNone;
+}
+
+Connection* Client::GetConnection()
+{
+    return m_pConnection.get();
+}
+
+uint16_t Client::GetPort() const
+{
+    return m_socket.GetPort();
+}
+
+bool Client::Send(const Endpoint& acRemoteEndpoint, Buffer aBuffer)
+{
+    // Whatever is queued was produced first and must not be overtaken
+    m_socket.Flush();
+
+    return m_socket.Send(Socket::Packet{ acRemoteEndpoint, std::move(aBuffer) });
+}
\ No newline at end of file
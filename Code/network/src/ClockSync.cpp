@@ -0,0 +1,67 @@
+#include "ClockSync.h"
+#include "Clock.h"
+
+ClockSync::ClockSync()
+    : m_samples{}
+    , m_count{0}
+    , m_next{0}
+    , m_best{}
+    , m_reference{}
+    , m_drift{0.0}
+{
+}
+
+void ClockSync::AddSample(uint64_t aLocalTime, int64_t aOffset, uint64_t aRoundTrip)
+{
+    m_samples[m_next] = Sample{ aLocalTime, aOffset, aRoundTrip };
+    m_next = (m_next + 1) % WindowSize;
+    if (m_count < WindowSize)
+        ++m_count;
+
+    m_best = m_samples[0];
+    for (size_t i = 1; i < m_count; ++i)
+    {
+        const auto& sample = m_samples[i];
+        if (sample.RoundTrip < m_best.RoundTrip || (sample.RoundTrip == m_best.RoundTrip && sample.Time > m_best.Time))
+            m_best = sample;
+    }
+
+    if (m_count == 1)
+    {
+        m_reference = m_best;
+        return;
+    }
+
+    // Drift is measured between filtered estimates far enough apart for the noise to be negligible
+    if (m_best.Time > m_reference.Time + Clock::Seconds(1))
+    {
+        const auto drift = double(m_best.Offset - m_reference.Offset) / double(m_best.Time - m_reference.Time);
+        m_drift = m_drift == 0.0 ? drift : m_drift * 0.75 + drift * 0.25;
+        m_reference = m_best;
+    }
+}
+
+bool ClockSync::HasEstimate() const
+{
+    return m_count != 0;
+}
+
+int64_t ClockSync::GetOffset(uint64_t aLocalTime) const
+{
+    return m_best.Offset + int64_t(m_drift * double(int64_t(aLocalTime - m_best.Time)));
+}
+
+uint64_t ClockSync::GetError() const
+{
+    return m_best.RoundTrip / 2;
+}
+
+uint64_t ClockSync::GetRoundTrip() const
+{
+    return m_best.RoundTrip;
+}
+
+double ClockSync::GetDrift() const
+{
+    return m_drift;
+}
\ No newline at end of file
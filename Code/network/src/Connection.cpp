@@ -1,181 +1,646 @@
-#include "Connection.h"
-#include "StackAllocator.h"
-
-
-
-struct NullCommunicationInterface : public Connection::ICommunication
-{
-    bool Send(const Endpoint& acRemote, Buffer aBuffer) override
-    {
-        (void)acRemote;
-        (void)aBuffer;
-
-        return false;
-    }
-};
-
-static NullCommunicationInterface s_dummyInterface;
-
-static const char* s_headerSignature = "MG";
-
-Connection::Connection(ICommunication& aCommunicationInterface, const Endpoint& acRemoteEndpoint)
-    : m_communication{ aCommunicationInterface }
-    , m_state{kNegociating}
-    , m_timeSinceLastEvent{0}
-    , m_remoteEndpoint{acRemoteEndpoint}
-{
-
-}
-
-Connection::Connection(Connection&& aRhs) noexcept
-    : m_communication{aRhs.m_communication}
-    , m_state{std::move(aRhs.m_state)}
-    , m_timeSinceLastEvent{std::move(aRhs.m_timeSinceLastEvent)}
-    , m_remoteEndpoint{std::move(aRhs.m_remoteEndpoint)}
-{
-    aRhs.m_communication = s_dummyInterface;
-    aRhs.m_state = kNone;
-    aRhs.m_timeSinceLastEvent = 0;
-}
-
-Connection::~Connection()
-{
-}
-
-Connection& Connection::operator=(Connection&& aRhs) noexcept
-{
-    m_communication = aRhs.m_communication;
-    m_state = aRhs.m_state;
-    m_timeSinceLastEvent = aRhs.m_timeSinceLastEvent;
-    m_remoteEndpoint = std::move(aRhs.m_remoteEndpoint);
-
-    aRhs.m_communication = s_dummyInterface;
-    aRhs.m_state = kNone;
-    aRhs.m_timeSinceLastEvent = 0;
-
-    return *this;
-}
-
-bool Connection::ProcessPacket(Buffer* apBuffer)
-{
-    Buffer::Reader reader(apBuffer);
-    
-    auto header = ProcessHeader(reader);
-    if (header.HasError())
-        return false;
-
-    m_timeSinceLastEvent = 0;
-
-    return true;
-}
-
-bool Connection::ProcessNegociation(Buffer* apBuffer)
-{
-    Buffer::Reader reader(apBuffer);
-
-    auto header = ProcessHeader(reader);
-    if (header.HasError())
-        return false;
-
-    if (m_filter.ReceiveConnect(&reader))
-        m_state = kConnected;
-
-    return IsNegotiating() || IsConnected();
-}
-
-bool Connection::IsNegotiating() const
-{
-    return m_state == kNegociating;
-}
-
-bool Connection::IsConnected() const
-{
-    return m_state == kConnected;
-}
-
-Connection::State Connection::GetState() const
-{
-    return m_state;
-}
-
-const Endpoint& Connection::GetRemoteEndpoint() const
-{
-    return m_remoteEndpoint;
-}
-
-void Connection::Update(uint64_t aElapsedMilliseconds)
-{
-    m_timeSinceLastEvent += aElapsedMilliseconds;
-
-    // Connection is considered timed out if no data is received in 15s (TODO: make this configurable)
-    if (m_timeSinceLastEvent > 15 * 1000)
-    {
-        m_state = kNone;
-        return;
-    }
-
-    switch (m_state)
-    {
-    case Connection::kNone:
-        break;
-    case Connection::kNegociating:
-        SendNegotiation();
-        break;
-    case Connection::kConnected:
-        break;
-    default:
-        break;
-    }
-}
-
-void Connection::SendNegotiation()
-{
-    Header header;
-    header.Signature[0] = s_headerSignature[0];
-    header.Signature[1] = s_headerSignature[1];
-    header.Version = 1;
-    header.Type = Header::kNegotiation;
-    header.Length = 0;
-
-    StackAllocator<1 << 13> allocator;
-    auto* pBuffer = allocator.New<Buffer>(1200);
-
-    Buffer::Writer writer(pBuffer);
-    writer.WriteBytes((const uint8_t*)header.Signature, 2);
-    writer.WriteBits(header.Version, 6);
-    writer.WriteBits(header.Type, 3);
-    writer.WriteBits(header.Length, 11);
-
-    m_filter.PreConnect(&writer);
-
-    m_communication.Send(m_remoteEndpoint, *pBuffer);
-
-    allocator.Delete(pBuffer);
-}
-
-Outcome<Connection::Header, Connection::HeaderErrors> Connection::ProcessHeader(Buffer::Reader& aReader)
-{
-    Header header;
-
-    aReader.ReadBytes((uint8_t*)&header.Signature, 2);
-
-    if (header.Signature[0] != 'M' || header.Signature[1] != 'G')
-        return kBadSignature;
-
-    aReader.ReadBits(header.Version, 6);
-
-    if (header.Version != 1)
-        return kBadVersion;
-
-    aReader.ReadBits(header.Type, 3);
-
-    if (header.Type >= Header::kCount)
-        return kBadPacketType;
-
-    aReader.ReadBits(header.Length, 11);
-
-    if (header.Length > 1200)
-        return kTooLarge;
-
-    return header;
+#include "Connection.h"
+#include "Log.h"
+#include "StackAllocator.h"
+#include <algorithm>
+
+
+
+struct NullCommunicationInterface : public Connection::ICommunication
+{
+    bool Send(const Endpoint& acRemote, Buffer aBuffer) override
+    {
+        (void)acRemote;
+        (void)aBuffer;
+
+        return false;
+    }
+};
+
+static NullCommunicationInterface s_dummyInterface;
+
+static const char* s_headerSignature = "MG";
+static constexpr uint64_t s_noEcho = (1 << 24) - 1;
+
+Connection::Connection(ICommunication& aCommunicationInterface, const Endpoint& acRemoteEndpoint)
+    : m_pCommunication{ &aCommunicationInterface }
+    , m_state{kNegociating}
+    , m_timeoutDeadline{Clock::GetNow() + Timeout}
+    , m_remoteEndpoint{acRemoteEndpoint}
+    , m_filter{!aCommunicationInterface.IsTrusted()}
+    , m_sendSequence{0}
+    , m_remoteTransmit{0}
+    , m_remoteTransmitTime{0}
+    , m_pAllocator{nullptr}
+    , m_maxQueued{0}
+{
+
+}
+
+Connection::Connection(ICommunication& aCommunicationInterface, Buffer::Reader& aReader)
+    : m_pCommunication{ &aCommunicationInterface }
+    , m_state{kNone}
+    , m_timeoutDeadline{0}
+    , m_filter{false}
+    , m_sendSequence{0}
+    , m_remoteTransmit{0}
+    , m_remoteTransmitTime{0}
+    , m_pAllocator{nullptr}
+    , m_maxQueued{0}
+{
+    if (Load(aReader) == false)
+        m_state = kNone;
+}
+
+Connection::Connection(Connection&& aRhs) noexcept
+    : m_pCommunication{aRhs.m_pCommunication}
+    , m_state{std::move(aRhs.m_state)}
+    , m_timeoutDeadline{aRhs.m_timeoutDeadline}
+    , m_remoteEndpoint{std::move(aRhs.m_remoteEndpoint)}
+    , m_filter{std::move(aRhs.m_filter)}
+    , m_sendSequence{aRhs.m_sendSequence}
+    , m_receiveQueue{std::move(aRhs.m_receiveQueue)}
+    , m_clockSync{aRhs.m_clockSync}
+    , m_remoteTransmit{aRhs.m_remoteTransmit}
+    , m_remoteTransmitTime{aRhs.m_remoteTransmitTime}
+    , m_fec{std::move(aRhs.m_fec)}
+    , m_statistics{aRhs.m_statistics}
+    , m_pAllocator{aRhs.m_pAllocator}
+    , m_maxQueued{aRhs.m_maxQueued}
+{
+    aRhs.m_pCommunication = &s_dummyInterface;
+    aRhs.m_state = kNone;
+    aRhs.m_timeoutDeadline = 0;
+}
+
+Connection::~Connection()
+{
+}
+
+Connection& Connection::operator=(Connection&& aRhs) noexcept
+{
+    m_pCommunication = aRhs.m_pCommunication;
+    m_state = aRhs.m_state;
+    m_timeoutDeadline = aRhs.m_timeoutDeadline;
+    m_remoteEndpoint = std::move(aRhs.m_remoteEndpoint);
+    m_filter = std::move(aRhs.m_filter);
+    m_sendSequence = aRhs.m_sendSequence;
+    m_receiveQueue = std::move(aRhs.m_receiveQueue);
+    m_clockSync = aRhs.m_clockSync;
+    m_remoteTransmit = aRhs.m_remoteTransmit;
+    m_remoteTransmitTime = aRhs.m_remoteTransmitTime;
+    m_fec = std::move(aRhs.m_fec);
+    m_statistics = aRhs.m_statistics;
+    m_pAllocator = aRhs.m_pAllocator;
+    m_maxQueued = aRhs.m_maxQueued;
+
+    aRhs.m_pCommunication = &s_dummyInterface;
+    aRhs.m_state = kNone;
+    aRhs.m_timeoutDeadline = 0;
+
+    return *this;
+}
+
+bool Connection::ProcessPacket(Buffer aPacket)
+{
+    Buffer::Reader reader(&aPacket);
+    const auto size = aPacket.GetSize();
+
+    auto header = ProcessHeader(reader);
+    if (header.HasError())
+    {
+        ++m_statistics.DroppedPackets;
+        return false;
+    }
+
+    const auto& acHeader = header.GetResult();
+
+    bool result = false;
+    if (acHeader.Type == Header::kNegotiation)
+    {
+        result = HandleNegotiation(reader);
+    }
+    else
+    {
+        uint32_t sequence, channel;
+        result = ReadPayloadHeader(reader, acHeader, aPacket.GetSize(), sequence, channel);
+        if (result)
+            QueuePayload(std::move(aPacket), HeaderSize, acHeader.Length, sequence, channel);
+    }
+
+    if (result)
+    {
+        m_timeoutDeadline = Clock::GetNow() + Timeout;
+        ++m_statistics.ReceivedPackets;
+        m_statistics.ReceivedBytes += size;
+    }
+    else
+        ++m_statistics.DroppedPackets;
+
+    return result;
+}
+
+bool Connection::ProcessPacket(const uint8_t* apData, size_t aLength)
+{
+    Buffer::Reader reader(apData, aLength);
+
+    auto header = ProcessHeader(reader);
+    if (header.HasError())
+    {
+        ++m_statistics.DroppedPackets;
+        return false;
+    }
+
+    const auto& acHeader = header.GetResult();
+
+    bool result = false;
+    if (acHeader.Type == Header::kNegotiation)
+    {
+        result = HandleNegotiation(reader);
+    }
+    else
+    {
+        uint32_t sequence, channel;
+        result = ReadPayloadHeader(reader, acHeader, aLength, sequence, channel);
+        if (result)
+        {
+            auto payload = AllocateBuffer(acHeader.Length);
+            std::copy(apData + HeaderSize, apData + HeaderSize + acHeader.Length, payload.GetWriteData());
+
+            QueuePayload(std::move(payload), 0, acHeader.Length, sequence, channel);
+        }
+    }
+
+    if (result)
+    {
+        m_timeoutDeadline = Clock::GetNow() + Timeout;
+        ++m_statistics.ReceivedPackets;
+        m_statistics.ReceivedBytes += aLength;
+    }
+    else
+        ++m_statistics.DroppedPackets;
+
+    return result;
+}
+
+void Connection::Close()
+{
+    m_state = kNone;
+    m_pCommunication = &s_dummyInterface;
+}
+
+bool Connection::ProcessNegociation(Buffer* apBuffer)
+{
+    Buffer::Reader reader(apBuffer);
+
+    auto header = ProcessHeader(reader);
+    if (header.HasError())
+        return false;
+
+    return HandleNegotiation(reader);
+}
+
+bool Connection::Send(uint32_t aChannel, const uint8_t* apData, size_t aLength)
+{
+    if (!IsConnected() || aChannel >= MaxChannels || aLength > MaxPayloadSize)
+        return false;
+
+    auto& pFec = m_fec[aChannel];
+    if (!pFec)
+        return SendPacket(aChannel, apData, aLength);
+
+    uint8_t framed[MaxPayloadSize];
+    const auto size = pFec->Encode(apData, aLength, framed);
+    if (size == 0)
+        return false;
+
+    const auto result = SendPacket(aChannel, framed, size);
+
+    pFec->Flush([this, aChannel](const uint8_t* apParity, size_t aParityLength)
+    {
+        SendPacket(aChannel, apParity, aParityLength);
+    });
+
+    return result;
+}
+
+bool Connection::EnableForwardErrorCorrection(uint32_t aChannel, const ForwardErrorCorrection::Config& acConfig)
+{
+    if (aChannel >= MaxChannels || !ForwardErrorCorrection::IsValid(acConfig))
+        return false;
+
+    m_fec[aChannel] = std::make_unique<ForwardErrorCorrection>(acConfig, MaxPayloadSize);
+
+    return true;
+}
+
+void Connection::DisableForwardErrorCorrection(uint32_t aChannel)
+{
+    if (aChannel < MaxChannels)
+        m_fec[aChannel].reset();
+}
+
+bool Connection::SendPacket(uint32_t aChannel, const uint8_t* apData, size_t aLength)
+{
+    auto packet = AllocateBuffer(HeaderSize + aLength);
+
+    WriteHeader(aChannel, aLength, packet.GetWriteData());
+
+    std::copy(apData, apData + aLength, packet.GetWriteData() + HeaderSize);
+    if (!m_pCommunication->IsTrusted())
+        m_filter.PostSend(packet.GetWriteData() + HeaderSize, aLength, m_sendSequence);
+
+    ++m_sendSequence;
+    ++m_statistics.SentPackets;
+    m_statistics.SentBytes += HeaderSize + aLength;
+
+    return m_pCommunication->Send(m_remoteEndpoint, std::move(packet));
+}
+
+size_t Connection::WritePacket(uint32_t aChannel, const uint8_t* apData, size_t aLength, uint8_t* apOutput)
+{
+    if (!IsConnected() || aChannel >= MaxChannels || aLength > MaxPayloadSize || m_fec[aChannel])
+        return 0;
+
+    WriteHeader(aChannel, aLength, apOutput);
+
+    if (m_pCommunication->IsTrusted())
+        std::copy(apData, apData + aLength, apOutput + HeaderSize);
+    else
+        m_filter.PostSend(apData, apOutput + HeaderSize, aLength, m_sendSequence);
+
+    ++m_sendSequence;
+    ++m_statistics.SentPackets;
+    m_statistics.SentBytes += HeaderSize + aLength;
+
+    return HeaderSize + aLength;
+}
+
+size_t Connection::WritePacket(uint32_t aChannel, size_t aLength, uint8_t* apOutput)
+{
+    if (!IsConnected() || aChannel >= MaxChannels || aLength > MaxPayloadSize || m_fec[aChannel])
+        return 0;
+
+    WriteHeader(aChannel, aLength, apOutput);
+
+    if (!m_pCommunication->IsTrusted())
+        m_filter.PostSend(apOutput + HeaderSize, aLength, m_sendSequence);
+
+    ++m_sendSequence;
+    ++m_statistics.SentPackets;
+    m_statistics.SentBytes += HeaderSize + aLength;
+
+    return HeaderSize + aLength;
+}
+
+void Connection::WriteHeader(uint32_t aChannel, size_t aLength, uint8_t* apOutput)
+{
+    Buffer::Writer writer(apOutput, HeaderSize);
+    WriteHeader(writer, Header::kConnection, aLength);
+    writer.WriteBits(m_sendSequence, 32);
+    writer.WriteBits(aChannel, 4);
+
+    // Echo the peer's last send time with how long we held it so it can measure the round trip without extra packets
+    const auto now = Clock::GetTimestamp();
+    writer.WriteBits((now / 1000) & 0xFFFFFFFFFFFF, 48);
+    writer.WriteBits(m_remoteTransmit & 0xFFFFFFFF, 32);
+    writer.WriteBits(m_remoteTransmitTime ? std::min((now - m_remoteTransmitTime) / 1000, s_noEcho - 1) : s_noEcho, 24);
+}
+
+bool Connection::Receive(Message& aMessage)
+{
+    if (m_receiveQueue.empty())
+        return false;
+
+    aMessage = std::move(m_receiveQueue.front());
+    m_receiveQueue.pop_front();
+
+    return true;
+}
+
+bool Connection::IsNegotiating() const
+{
+    return m_state == kNegociating;
+}
+
+bool Connection::IsConnected() const
+{
+    return m_state == kConnected;
+}
+
+Connection::State Connection::GetState() const
+{
+    return m_state;
+}
+
+const Endpoint& Connection::GetRemoteEndpoint() const
+{
+    return m_remoteEndpoint;
+}
+
+const Connection::ICommunication& Connection::GetCommunication() const
+{
+    return *m_pCommunication;
+}
+
+int64_t Connection::GetClockOffset() const
+{
+    return m_clockSync.GetOffset(Clock::GetNow());
+}
+
+uint64_t Connection::GetClockError() const
+{
+    return m_clockSync.GetError();
+}
+
+const ClockSync& Connection::GetClockSync() const
+{
+    return m_clockSync;
+}
+
+const Connection::Statistics& Connection::GetStatistics() const
+{
+    return m_statistics;
+}
+
+void Connection::SetAllocator(Allocator* apAllocator, size_t aMaxQueued)
+{
+    m_pAllocator = apAllocator;
+    m_maxQueued = aMaxQueued;
+
+    std::deque<Message, StlAllocator<Message>> queue{ StlAllocator<Message>(apAllocator) };
+    for (auto& message : m_receiveQueue)
+        queue.push_back(std::move(message));
+
+    m_receiveQueue = std::move(queue);
+}
+
+bool Connection::IsReceiveQueueFull() const
+{
+    return m_maxQueued != 0 && m_receiveQueue.size() >= m_maxQueued;
+}
+
+Buffer Connection::AllocateBuffer(size_t aSize) const
+{
+    if (m_pAllocator == nullptr)
+        return Buffer(aSize);
+
+    ScopedAllocator allocator(m_pAllocator);
+    return Buffer(aSize);
+}
+
+void Connection::Update(uint64_t aNow)
+{
+    if (aNow >= m_timeoutDeadline)
+    {
+        if (m_state != kNone)
+            LOG_INFO("Connection from port %u timed out", m_remoteEndpoint.GetPort());
+
+        m_state = kNone;
+        return;
+    }
+
+    switch (m_state)
+    {
+    case Connection::kNone:
+        break;
+    case Connection::kNegociating:
+        SendNegotiation();
+        break;
+    case Connection::kConnected:
+        // Groups left open when a channel goes quiet get their parity rather than waiting for more traffic
+        for (uint32_t channel = 0; channel < MaxChannels; ++channel)
+        {
+            if (!m_fec[channel])
+                continue;
+
+            m_fec[channel]->FlushIdle([this, channel](const uint8_t* apParity, size_t aParityLength)
+            {
+                SendPacket(channel, apParity, aParityLength);
+            });
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+bool Connection::Save(Buffer::Writer& aWriter) const
+{
+    // Deadlines are process local, only the remaining time is transferred
+    const auto now = Clock::GetNow();
+    const uint64_t remaining = m_timeoutDeadline > now ? m_timeoutDeadline - now : 0;
+
+    if (!aWriter.WriteBits(m_state, 8) ||
+        !aWriter.WriteBits(remaining, 64) ||
+        !aWriter.WriteBits(m_sendSequence, 32) ||
+        !aWriter.WriteBits(m_remoteEndpoint.GetType(), 8) ||
+        !aWriter.WriteBits(m_remoteEndpoint.GetPort(), 16) ||
+        !aWriter.WriteBytes((const uint8_t*)m_remoteEndpoint.GetIPv6(), 16))
+        return false;
+
+    return m_filter.Save(&aWriter);
+}
+
+bool Connection::Load(Buffer::Reader& aReader)
+{
+    uint64_t state, remaining, sequence, type, port;
+    if (!aReader.ReadBits(state, 8) ||
+        !aReader.ReadBits(remaining, 64) ||
+        !aReader.ReadBits(sequence, 32) ||
+        !aReader.ReadBits(type, 8) ||
+        !aReader.ReadBits(port, 16))
+        return false;
+
+    if (state > kConnected || type > Endpoint::kIPv6)
+        return false;
+
+    // Endpoints store both address families in the same 16 bytes
+    uint16_t address[8];
+    if (!aReader.ReadBytes((uint8_t*)address, 16))
+        return false;
+
+    if (type == Endpoint::kIPv4)
+    {
+        uint32_t netIPv4;
+        std::copy((const uint8_t*)address, (const uint8_t*)address + 4, (uint8_t*)&netIPv4);
+        m_remoteEndpoint = Endpoint(netIPv4, (uint16_t)port);
+    }
+    else if (type == Endpoint::kIPv6)
+    {
+        for (auto& part : address)
+            part = htons(part);
+
+        m_remoteEndpoint = Endpoint(address, (uint16_t)port);
+    }
+
+    if (!m_filter.Load(&aReader))
+        return false;
+
+    m_state = (State)state;
+    m_timeoutDeadline = Clock::GetNow() + std::min(remaining, Timeout);
+    m_sendSequence = (uint32_t)sequence;
+
+    return true;
+}
+
+void Connection::SendNegotiation()
+{
+    StackAllocator<1 << 13> allocator;
+    auto* pBuffer = allocator.New<Buffer>(1200);
+
+    Buffer::Writer writer(pBuffer);
+    WriteHeader(writer, Header::kNegotiation, 0);
+
+    // Tells the other side whether it still has to answer with its own key
+    writer.WriteBits(IsConnected() ? 1 : 0, 8);
+
+    if (!m_pCommunication->IsTrusted())
+        m_filter.PreConnect(&writer);
+
+    ++m_statistics.SentPackets;
+    m_statistics.SentBytes += pBuffer->GetSize();
+
+    m_pCommunication->Send(m_remoteEndpoint, *pBuffer);
+
+    allocator.Delete(pBuffer);
+}
+
+bool Connection::HandleNegotiation(Buffer::Reader& aReader)
+{
+    uint64_t remoteConnected = 0;
+    if (!aReader.ReadBits(remoteConnected, 8))
+        return false;
+
+    if (IsNegotiating())
+    {
+        if (m_pCommunication->IsTrusted() || m_filter.ReceiveConnect(&aReader))
+            m_state = kConnected;
+    }
+
+    if (IsConnected() && remoteConnected == 0)
+        SendNegotiation();
+
+    return IsNegotiating() || IsConnected();
+}
+
+bool Connection::ReadPayloadHeader(Buffer::Reader& aReader, const Header& acHeader, size_t aPacketSize, uint32_t& aSequence, uint32_t& aChannel)
+{
+    if (!IsConnected())
+        return false;
+
+    uint64_t sequence = 0, channel = 0, transmit = 0, echo = 0, echoDelay = 0;
+    if (!aReader.ReadBits(sequence, 32) || !aReader.ReadBits(channel, 4) ||
+        !aReader.ReadBits(transmit, 48) || !aReader.ReadBits(echo, 32) || !aReader.ReadBits(echoDelay, 24))
+        return false;
+
+    if (HeaderSize + acHeader.Length > aPacketSize)
+        return false;
+
+    ProcessTimestamps(transmit, echo, echoDelay);
+
+    aSequence = (uint32_t)sequence;
+    aChannel = (uint32_t)channel;
+
+    return true;
+}
+
+void Connection::ProcessTimestamps(uint64_t aTransmit, uint64_t aEcho, uint64_t aEchoDelay)
+{
+    const auto now = Clock::GetTimestamp();
+    const auto nowMicroseconds = now / 1000;
+
+    // Reordered packets would echo an older send time and inflate the peer's round trip
+    if (m_remoteTransmitTime == 0 || int64_t(aTransmit - m_remoteTransmit) > 0)
+    {
+        m_remoteTransmit = aTransmit;
+        m_remoteTransmitTime = now;
+    }
+
+    if (aEchoDelay == s_noEcho)
+        return;
+
+    // Only the low 32 bits of our send time come back, enough for round trips up to an hour
+    const uint64_t elapsed = uint32_t(nowMicroseconds - aEcho);
+    if (elapsed < aEchoDelay)
+        return;
+
+    const auto sent = int64_t(nowMicroseconds - elapsed);
+    const auto remoteReceived = int64_t(aTransmit - aEchoDelay);
+    const auto offset = ((remoteReceived - sent) + (int64_t(aTransmit) - int64_t(nowMicroseconds))) / 2;
+
+    m_clockSync.AddSample(now, offset * 1000, (elapsed - aEchoDelay) * 1000);
+}
+
+void Connection::QueuePayload(Buffer aData, size_t aOffset, size_t aLength, uint32_t aSequence, uint32_t aChannel)
+{
+    if (!m_pCommunication->IsTrusted())
+        m_filter.PreReceive(aData.GetWriteData() + aOffset, aLength, aSequence);
+
+    if (auto& pFec = m_fec[aChannel])
+    {
+        const bool isData = pFec->Decode(aData.GetData() + aOffset, aLength, [this, aChannel](const uint8_t* apPayload, size_t aPayloadLength)
+        {
+            if (IsReceiveQueueFull())
+            {
+                ++m_statistics.DroppedPackets;
+                return;
+            }
+
+            auto payload = AllocateBuffer(aPayloadLength);
+            std::copy(apPayload, apPayload + aPayloadLength, payload.GetWriteData());
+
+            m_receiveQueue.push_back(Message{ aChannel, std::move(payload), 0, aPayloadLength });
+        });
+
+        // Parity and duplicates never reach the application
+        if (!isData)
+            return;
+
+        aOffset += ForwardErrorCorrection::HeaderSize;
+        aLength -= ForwardErrorCorrection::HeaderSize;
+    }
+
+    if (IsReceiveQueueFull())
+    {
+        ++m_statistics.DroppedPackets;
+        return;
+    }
+
+    Message message{ aChannel, std::move(aData), aOffset, aLength };
+    m_receiveQueue.push_back(std::move(message));
+}
+
+void Connection::WriteHeader(Buffer::Writer& aWriter, uint64_t aType, size_t aLength)
+{
+    aWriter.WriteBytes((const uint8_t*)s_headerSignature, 2);
+    aWriter.WriteBits(1, 6);
+    aWriter.WriteBits(aType, 3);
+    aWriter.WriteBits(aLength, 11);
+}
+
+Outcome<Connection::Header, Connection::HeaderErrors> Connection::ProcessHeader(Buffer::Reader& aReader)
+{
+    Header header;
+
+    aReader.ReadBytes((uint8_t*)&header.Signature, 2);
+
+    if (header.Signature[0] != 'M' || header.Signature[1] != 'G')
+        return kBadSignature;
+
+    aReader.ReadBits(header.Version, 6);
+
+    if (header.Version != 1)
+        return kBadVersion;
+
+    aReader.ReadBits(header.Type, 3);
+
+    if (header.Type >= Header::kCount)
+        return kBadPacketType;
+
+    aReader.ReadBits(header.Length, 11);
+
+    if (header.Length > 1200)
+        return kTooLarge;
+
+    return header;
 }
\ No newline at end of file
@@ -1,51 +1,126 @@
-#include "ConnectionManager.h"
-
-
-
-ConnectionManager::ConnectionManager(size_t aMaxConnections)
-    : m_maxConnections(aMaxConnections)
-{
-
-}
-
-Connection* ConnectionManager::Find(const Endpoint& acEndpoint)
-{
-    auto itor = m_connections.find(acEndpoint);
-    if (itor != std::end(m_connections))
-    {
-        return &itor->second;
-    }
-
-    return nullptr;
-}
-
-const Connection* ConnectionManager::Find(const Endpoint& acEndpoint) const
-{
-    auto itor = m_connections.find(acEndpoint);
-    if (itor != std::end(m_connections))
-    {
-        return &itor->second;
-    }
-
-    return nullptr;
-}
-
-bool ConnectionManager::IsFull() const
-{
-    return m_connections.size() >= m_maxConnections;
-}
-
-void ConnectionManager::Update(uint64_t aElapsedMilliSeconds)
-{
-    for (auto& kvp : m_connections)
-    {
-        auto& connection = kvp.second;
-
-        connection.Update(aElapsedMilliSeconds);
-    }
-}
-
-void ConnectionManager::Add(Connection aConnection)
-{
-    m_connections.emplace(aConnection.GetRemoteEndpoint(), std::move(aConnection));
+#include "ConnectionManager.h"
+#include <algorithm>
+
+
+
+ConnectionManager::ConnectionManager(size_t aMaxConnections)
+    : m_maxConnections(0)
+{
+    SetCapacity(aMaxConnections);
+}
+
+Connection* ConnectionManager::Find(const Endpoint& acEndpoint)
+{
+    const auto index = m_index[GetSlot(acEndpoint)];
+
+    return index != kEmpty ? &m_connections[index] : nullptr;
+}
+
+const Connection* ConnectionManager::Find(const Endpoint& acEndpoint) const
+{
+    const auto index = m_index[GetSlot(acEndpoint)];
+
+    return index != kEmpty ? &m_connections[index] : nullptr;
+}
+
+bool ConnectionManager::SetCapacity(size_t aMaxConnections)
+{
+    if (!m_connections.empty())
+        return false;
+
+    // Keep the load factor at or below one half so probes stay short
+    size_t indexSize = 16;
+    while (indexSize < aMaxConnections * 2)
+        indexSize *= 2;
+
+    m_connections.reserve(aMaxConnections);
+    m_index.assign(indexSize, kEmpty);
+    m_maxConnections = aMaxConnections;
+
+    return true;
+}
+
+size_t ConnectionManager::GetCapacity() const
+{
+    return m_maxConnections;
+}
+
+bool ConnectionManager::IsFull() const
+{
+    return m_connections.size() >= m_maxConnections;
+}
+
+size_t ConnectionManager::GetCount() const
+{
+    return m_connections.size();
+}
+
+void ConnectionManager::Update(uint64_t aNow)
+{
+    for (auto& connection : m_connections)
+        connection.Update(aNow);
+}
+
+void ConnectionManager::Add(Connection aConnection)
+{
+    if (IsFull())
+        return;
+
+    const auto slot = GetSlot(aConnection.GetRemoteEndpoint());
+    if (m_index[slot] != kEmpty)
+        return;
+
+    m_index[slot] = (uint32_t)m_connections.size();
+    m_connections.push_back(std::move(aConnection));
+}
+
+size_t ConnectionManager::GetSlot(const Endpoint& acEndpoint) const
+{
+    const auto mask = m_index.size() - 1;
+    auto slot = std::hash<Endpoint>()(acEndpoint) & mask;
+
+    // Connections are never removed so the first empty slot ends the probe
+    while (m_index[slot] != kEmpty && !(m_connections[m_index[slot]].GetRemoteEndpoint() == acEndpoint))
+        slot = (slot + 1) & mask;
+
+    return slot;
+}
+
+bool ConnectionManager::Save(Buffer::Writer& aWriter) const
+{
+    // Timed out peers stay behind, the successor would only have to drop them
+    const auto isAlive = [](const Connection& acConnection) { return acConnection.GetState() != Connection::kNone; };
+
+    if (!aWriter.WriteBits(std::count_if(std::begin(m_connections), std::end(m_connections), isAlive), 32))
+        return false;
+
+    for (auto& connection : m_connections)
+    {
+        if (isAlive(connection) && !connection.Save(aWriter))
+            return false;
+    }
+
+    return true;
+}
+
+bool ConnectionManager::Load(Buffer::Reader& aReader, Connection::ICommunication& aCommunicationInterface)
+{
+    uint64_t count = 0;
+    if (!aReader.ReadBits(count, 32))
+        return false;
+
+    // A predecessor may have been configured for more peers, none of them is turned away
+    if (count > m_maxConnections && !SetCapacity(count))
+        return false;
+
+    for (uint64_t i = 0; i < count; ++i)
+    {
+        Connection connection(aCommunicationInterface, aReader);
+        if (connection.GetState() == Connection::kNone)
+            return false;
+
+        Add(std::move(connection));
+    }
+
+    return true;
 }
\ No newline at end of file
@@ -0,0 +1,225 @@
+#include "ForwardErrorCorrection.h"
+#include "GaloisField.h"
+#include <algorithm>
+#include <cstring>
+
+ForwardErrorCorrection::ForwardErrorCorrection(const Config& acConfig, size_t aMaxPayloadSize)
+    : m_config{acConfig}
+    , m_shardSize{aMaxPayloadSize - ParityHeaderSize}
+    , m_sendGroup{0}
+    , m_sendIndex{0}
+    , m_sendActive{false}
+    , m_parityLength{0}
+    , m_parity(acConfig.ParityCount * aMaxPayloadSize, 0)
+    , m_groups{}
+{
+}
+
+bool ForwardErrorCorrection::IsValid(const Config& acConfig)
+{
+    if (acConfig.DataCount == 0 || acConfig.ParityCount == 0 || acConfig.DataCount + acConfig.ParityCount > MaxGroupSize)
+        return false;
+
+    return acConfig.Type == kReedSolomon || (acConfig.Type == kXor && acConfig.ParityCount == 1);
+}
+
+const ForwardErrorCorrection::Config& ForwardErrorCorrection::GetConfig() const
+{
+    return m_config;
+}
+
+size_t ForwardErrorCorrection::Encode(const uint8_t* apData, size_t aLength, uint8_t* apOutput)
+{
+    if (aLength + 2 > m_shardSize || m_sendIndex >= m_config.DataCount)
+        return 0;
+
+    apOutput[0] = (uint8_t)(m_sendGroup & 0xFF);
+    apOutput[1] = (uint8_t)(m_sendGroup >> 8);
+    apOutput[2] = m_sendIndex;
+    std::memcpy(apOutput + HeaderSize, apData, aLength);
+
+    // Parity is accumulated as packets go out so the group never has to be buffered
+    const uint8_t prefix[2] = { (uint8_t)(aLength & 0xFF), (uint8_t)(aLength >> 8) };
+    const size_t stride = ParityHeaderSize + m_shardSize;
+    for (size_t i = 0; i < m_config.ParityCount; ++i)
+    {
+        auto* pParity = m_parity.data() + i * stride + ParityHeaderSize;
+        const auto coefficient = GetCoefficient(i, m_sendIndex);
+
+        GaloisField::MultiplyAdd(pParity, prefix, coefficient, 2);
+        GaloisField::MultiplyAdd(pParity + 2, apData, coefficient, aLength);
+    }
+
+    m_parityLength = std::max(m_parityLength, aLength + 2);
+    ++m_sendIndex;
+    m_sendActive = true;
+
+    return aLength + HeaderSize;
+}
+
+uint8_t ForwardErrorCorrection::GetCoefficient(size_t aParity, size_t aData) const
+{
+    if (m_config.Type == kXor)
+        return 1;
+
+    // Cauchy matrix, every square sub matrix is invertible so any DataCount shards can rebuild the group
+    return GaloisField::Inverse((uint8_t)(aParity ^ (m_config.ParityCount + aData)));
+}
+
+ForwardErrorCorrection::Group* ForwardErrorCorrection::Store(uint16_t aGroup, uint8_t aIndex, uint8_t aDataCount, const uint8_t* apData, size_t aLength)
+{
+    auto& group = m_groups[aGroup % MaxGroupsInFlight];
+
+    if (!group.Active || group.Id != aGroup)
+    {
+        // Groups that already left the window are not stored again
+        if (group.Active && int16_t(aGroup - group.Id) < 0)
+            return nullptr;
+
+        group.Id = aGroup;
+        group.DataCount = 0;
+        group.Active = true;
+        group.Recovered = false;
+        group.ReceivedMask = 0;
+        group.ParityLength = 0;
+
+        if (group.Shards.empty())
+            group.Shards.resize((m_config.DataCount + m_config.ParityCount) * m_shardSize);
+    }
+
+    if (group.ReceivedMask & (1u << aIndex))
+        return nullptr;
+
+    auto* pShard = group.Shards.data() + aIndex * m_shardSize;
+
+    if (aIndex < m_config.DataCount)
+    {
+        if (aLength + 2 > m_shardSize)
+            return nullptr;
+
+        pShard[0] = (uint8_t)(aLength & 0xFF);
+        pShard[1] = (uint8_t)(aLength >> 8);
+        std::memcpy(pShard + 2, apData, aLength);
+    }
+    else
+    {
+        if (aLength > m_shardSize || (group.ParityLength != 0 && group.ParityLength != aLength))
+            return nullptr;
+
+        if (aDataCount == 0 || aDataCount > m_config.DataCount || (group.DataCount != 0 && group.DataCount != aDataCount))
+            return nullptr;
+
+        std::memcpy(pShard, apData, aLength);
+        group.ParityLength = aLength;
+        group.DataCount = aDataCount;
+    }
+
+    group.Lengths[aIndex] = aLength;
+    group.ReceivedMask |= 1u << aIndex;
+
+    return &group;
+}
+
+size_t ForwardErrorCorrection::Recover(Group& aGroup, uint8_t* apRecovered)
+{
+    // Parity indices follow the configured data count even when the group was closed with fewer packets
+    const size_t dataCount = aGroup.DataCount;
+    const size_t firstParity = m_config.DataCount;
+    const size_t total = firstParity + m_config.ParityCount;
+    const uint32_t dataMask = (1u << dataCount) - 1;
+
+    if (aGroup.Recovered || aGroup.ParityLength == 0 || (aGroup.ReceivedMask & dataMask) == dataMask)
+        return 0;
+
+    // Pick any dataCount received shards, data first since their rows are trivial
+    uint8_t rows[MaxGroupSize];
+    size_t rowCount = 0;
+    for (size_t i = 0; i < total && rowCount < dataCount; ++i)
+    {
+        if ((i < dataCount || i >= firstParity) && (aGroup.ReceivedMask & (1u << i)))
+            rows[rowCount++] = (uint8_t)i;
+    }
+
+    if (rowCount < dataCount)
+        return 0;
+
+    const size_t length = aGroup.ParityLength;
+    for (size_t r = 0; r < rowCount && rows[r] < dataCount; ++r)
+    {
+        const auto used = aGroup.Lengths[rows[r]] + 2;
+        if (used > length)
+            return 0;
+
+        auto* pShard = aGroup.Shards.data() + rows[r] * m_shardSize;
+        std::fill(pShard + used, pShard + length, 0);
+    }
+
+    // Invert the encoding rows of the received shards with Gauss-Jordan elimination
+    uint8_t matrix[MaxGroupSize][MaxGroupSize] = {};
+    uint8_t inverse[MaxGroupSize][MaxGroupSize] = {};
+    for (size_t r = 0; r < dataCount; ++r)
+    {
+        for (size_t c = 0; c < dataCount; ++c)
+            matrix[r][c] = rows[r] < dataCount ? (rows[r] == c ? 1 : 0) : GetCoefficient(rows[r] - firstParity, c);
+
+        inverse[r][r] = 1;
+    }
+
+    for (size_t c = 0; c < dataCount; ++c)
+    {
+        size_t pivot = c;
+        while (pivot < dataCount && matrix[pivot][c] == 0)
+            ++pivot;
+
+        if (pivot == dataCount)
+            return 0;
+
+        std::swap(matrix[pivot], matrix[c]);
+        std::swap(inverse[pivot], inverse[c]);
+
+        const auto scale = GaloisField::Inverse(matrix[c][c]);
+        for (size_t k = 0; k < dataCount; ++k)
+        {
+            matrix[c][k] = GaloisField::Multiply(matrix[c][k], scale);
+            inverse[c][k] = GaloisField::Multiply(inverse[c][k], scale);
+        }
+
+        for (size_t r = 0; r < dataCount; ++r)
+        {
+            const auto factor = matrix[r][c];
+            if (r == c || factor == 0)
+                continue;
+
+            for (size_t k = 0; k < dataCount; ++k)
+            {
+                matrix[r][k] ^= GaloisField::Multiply(factor, matrix[c][k]);
+                inverse[r][k] ^= GaloisField::Multiply(factor, inverse[c][k]);
+            }
+        }
+    }
+
+    size_t count = 0;
+    for (size_t i = 0; i < dataCount; ++i)
+    {
+        if (aGroup.ReceivedMask & (1u << i))
+            continue;
+
+        auto* pShard = aGroup.Shards.data() + i * m_shardSize;
+        std::fill(pShard, pShard + length, 0);
+
+        for (size_t r = 0; r < dataCount; ++r)
+            GaloisField::MultiplyAdd(pShard, aGroup.Shards.data() + rows[r] * m_shardSize, inverse[i][r], length);
+
+        const size_t payloadLength = pShard[0] | (pShard[1] << 8);
+        if (payloadLength + 2 > length)
+            continue;
+
+        aGroup.Lengths[i] = payloadLength;
+        aGroup.ReceivedMask |= 1u << i;
+        apRecovered[count++] = (uint8_t)i;
+    }
+
+    aGroup.Recovered = true;
+
+    return count;
+}
\ No newline at end of file
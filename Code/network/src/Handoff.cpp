@@ -0,0 +1,259 @@
+#include "Handoff.h"
+
+#ifdef __linux__
+#include <sys/un.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include <cstring>
+
+#ifdef __linux__
+namespace
+{
+    // The other end gets our listening sockets and session keys, it has to run as the same user
+    bool IsSameUser(int aSocket)
+    {
+        ucred credentials;
+        socklen_t length = sizeof(credentials);
+        if (getsockopt(aSocket, SOL_SOCKET, SO_PEERCRED, &credentials, &length) < 0)
+            return false;
+
+        return credentials.uid == geteuid();
+    }
+}
+#endif
+
+Handoff::Handoff()
+    : m_listener{ -1 }
+    , m_peer{ -1 }
+{
+}
+
+Handoff::~Handoff()
+{
+#ifdef __linux__
+    if (m_peer >= 0)
+        close(m_peer);
+
+    if (m_listener >= 0)
+    {
+        close(m_listener);
+        unlink(m_path.c_str());
+    }
+#endif
+}
+
+bool Handoff::Listen(const std::string& acPath)
+{
+#ifdef __linux__
+    sockaddr_un addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+
+    if (acPath.size() >= sizeof(addr.sun_path))
+        return false;
+
+    std::copy(std::begin(acPath), std::end(acPath), addr.sun_path);
+
+    m_listener = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    if (m_listener < 0)
+        return false;
+
+    // A stale path left behind by a crashed process would make bind fail
+    unlink(acPath.c_str());
+
+    // The path is created with the mode of the socket, other users must not be able to connect
+    if (fchmod(m_listener, S_IRUSR | S_IWUSR) < 0 ||
+        bind(m_listener, (sockaddr*)&addr, sizeof(addr)) < 0 || listen(m_listener, 1) < 0)
+    {
+        close(m_listener);
+        m_listener = -1;
+        return false;
+    }
+
+    m_path = acPath;
+
+    return true;
+#else
+    (void)acPath;
+    return false;
+#endif
+}
+
+bool Handoff::Accept()
+{
+#ifdef __linux__
+    if (m_listener < 0)
+        return false;
+
+    auto peer = accept(m_listener, nullptr, nullptr);
+    if (peer < 0)
+        return false;
+
+    if (!IsSameUser(peer))
+    {
+        close(peer);
+        return false;
+    }
+
+    // Only the latest successor is served
+    if (m_peer >= 0)
+        close(m_peer);
+
+    m_peer = peer;
+
+    // The listener is non-blocking but the transfer itself must complete in one go
+    int flags = fcntl(m_peer, F_GETFL, 0);
+    fcntl(m_peer, F_SETFL, flags & ~O_NONBLOCK);
+
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool Handoff::Connect(const std::string& acPath)
+{
+#ifdef __linux__
+    sockaddr_un addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+
+    if (acPath.size() >= sizeof(addr.sun_path))
+        return false;
+
+    std::copy(std::begin(acPath), std::end(acPath), addr.sun_path);
+
+    m_peer = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (m_peer < 0)
+        return false;
+
+    if (connect(m_peer, (sockaddr*)&addr, sizeof(addr)) < 0 || !IsSameUser(m_peer))
+    {
+        close(m_peer);
+        m_peer = -1;
+        return false;
+    }
+
+    return true;
+#else
+    (void)acPath;
+    return false;
+#endif
+}
+
+bool Handoff::Send(std::initializer_list<Socket*> aSockets, const Buffer& acState, size_t aStateSize)
+{
+#ifdef __linux__
+    if (m_peer < 0 || aSockets.size() > MaxSocketCount || aStateSize > acState.GetSize())
+        return false;
+
+    // The descriptors travel with the size of the state that follows
+    uint64_t stateSize = aStateSize;
+
+    iovec iov;
+    iov.iov_base = &stateSize;
+    iov.iov_len = sizeof(stateSize);
+
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int) * MaxSocketCount)];
+    std::memset(control, 0, sizeof(control));
+
+    msghdr msg;
+    std::memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = CMSG_SPACE(sizeof(int) * aSockets.size());
+
+    auto* pHeader = CMSG_FIRSTHDR(&msg);
+    pHeader->cmsg_level = SOL_SOCKET;
+    pHeader->cmsg_type = SCM_RIGHTS;
+    pHeader->cmsg_len = CMSG_LEN(sizeof(int) * aSockets.size());
+
+    auto* pDescriptors = (int*)CMSG_DATA(pHeader);
+    for (auto* pSocket : aSockets)
+        *pDescriptors++ = pSocket->m_sock;
+
+    if (sendmsg(m_peer, &msg, 0) != sizeof(stateSize))
+        return false;
+
+    size_t sent = 0;
+    while (sent < aStateSize)
+    {
+        auto result = send(m_peer, acState.GetData() + sent, aStateSize - sent, MSG_NOSIGNAL);
+        if (result <= 0)
+            return false;
+
+        sent += result;
+    }
+
+    return true;
+#else
+    (void)aSockets;
+    (void)acState;
+    (void)aStateSize;
+    return false;
+#endif
+}
+
+bool Handoff::Receive(std::initializer_list<Socket*> aSockets, Buffer& aState)
+{
+#ifdef __linux__
+    if (m_peer < 0 || aSockets.size() > MaxSocketCount)
+        return false;
+
+    uint64_t stateSize = 0;
+
+    iovec iov;
+    iov.iov_base = &stateSize;
+    iov.iov_len = sizeof(stateSize);
+
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int) * MaxSocketCount)];
+
+    msghdr msg;
+    std::memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    if (recvmsg(m_peer, &msg, MSG_WAITALL | MSG_CMSG_CLOEXEC) != sizeof(stateSize))
+        return false;
+
+    auto* pHeader = CMSG_FIRSTHDR(&msg);
+    if (pHeader == nullptr || pHeader->cmsg_type != SCM_RIGHTS || 
+        pHeader->cmsg_len != CMSG_LEN(sizeof(int) * aSockets.size()))
+        return false;
+
+    auto* pDescriptors = (int*)CMSG_DATA(pHeader);
+    for (auto* pSocket : aSockets)
+        pSocket->Adopt(*pDescriptors++);
+
+    Buffer state(stateSize);
+
+    size_t received = 0;
+    while (received < stateSize)
+    {
+        auto result = recv(m_peer, state.GetWriteData() + received, stateSize - received, 0);
+        if (result <= 0)
+            return false;
+
+        received += result;
+    }
+
+    aState = std::move(state);
+
+    return true;
+#else
+    (void)aSockets;
+    (void)aState;
+    return false;
+#endif
+}
+
+bool Handoff::IsConnected() const
+{
+    return m_peer >= 0;
+}
@@ -0,0 +1,257 @@
+#include "InterestGrid.h"
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <iterator>
+#include <mutex>
+#include <thread>
+
+namespace
+{
+    // Fewer views than this per thread are not worth waking a worker for
+    constexpr size_t s_viewsPerThread = 16;
+}
+
+// Threads kept between calls, each one runs the chunk matching its index once per job
+struct InterestGrid::Workers
+{
+    explicit Workers(size_t aCount)
+    {
+        for (size_t i = 0; i < aCount; ++i)
+            Threads.emplace_back([this, i]() { Run(i + 1); });
+    }
+
+    ~Workers()
+    {
+        {
+            std::lock_guard<std::mutex> _(Lock);
+            Stop = true;
+        }
+
+        Wake.notify_all();
+
+        for (auto& thread : Threads)
+            thread.join();
+    }
+
+    void Execute(size_t aChunkCount, void (*apJob)(void*, size_t), void* apContext)
+    {
+        {
+            std::lock_guard<std::mutex> _(Lock);
+            pJob = apJob;
+            pContext = apContext;
+            ChunkCount = aChunkCount;
+            Pending = Threads.size();
+            ++Generation;
+        }
+
+        Wake.notify_all();
+
+        apJob(apContext, 0);
+
+        std::unique_lock<std::mutex> lock(Lock);
+        Done.wait(lock, [this]() { return Pending == 0; });
+    }
+
+    void Run(size_t aChunk)
+    {
+        uint64_t generation = 0;
+
+        std::unique_lock<std::mutex> lock(Lock);
+        while (true)
+        {
+            Wake.wait(lock, [this, generation]() { return Stop || Generation != generation; });
+            if (Stop)
+                return;
+
+            generation = Generation;
+
+            if (aChunk < ChunkCount)
+            {
+                lock.unlock();
+                pJob(pContext, aChunk);
+                lock.lock();
+            }
+
+            if (--Pending == 0)
+                Done.notify_one();
+        }
+    }
+
+    std::mutex Lock;
+    std::condition_variable Wake;
+    std::condition_variable Done;
+    std::vector<std::thread> Threads;
+
+    void (*pJob)(void*, size_t){ nullptr };
+    void* pContext{ nullptr };
+    size_t ChunkCount{ 0 };
+    size_t Pending{ 0 };
+    uint64_t Generation{ 0 };
+    bool Stop{ false };
+};
+
+template<class T>
+void InterestGrid::ParallelFor(size_t aThreadCount, size_t aCount, T&& aFunction) const
+{
+    aThreadCount = std::max<size_t>(1, std::min(aThreadCount, aCount));
+
+    const auto chunkSize = (aCount + aThreadCount - 1) / aThreadCount;
+    if (aThreadCount == 1)
+    {
+        aFunction(0, aCount, 0);
+        return;
+    }
+
+    if (!m_pWorkers || m_pWorkers->Threads.size() < aThreadCount - 1)
+        m_pWorkers = std::make_unique<Workers>(aThreadCount - 1);
+
+    struct Context
+    {
+        T& Function;
+        size_t Count;
+        size_t ChunkSize;
+    } context{ aFunction, aCount, chunkSize };
+
+    m_pWorkers->Execute(aThreadCount, [](void* apContext, size_t aChunk)
+    {
+        auto& context = *static_cast<Context*>(apContext);
+        const auto begin = std::min(context.Count, aChunk * context.ChunkSize);
+        const auto end = std::min(context.Count, begin + context.ChunkSize);
+        context.Function(begin, end, aChunk);
+    }, &context);
+}
+
+InterestGrid::InterestGrid(float aMinX, float aMinY, float aWidth, float aHeight, float aCellSize)
+    : m_minX{aMinX}
+    , m_minY{aMinY}
+    , m_inverseCellSize{1.f / aCellSize}
+    , m_columns{std::max(1u, (uint32_t)std::ceil(aWidth / aCellSize))}
+    , m_rows{std::max(1u, (uint32_t)std::ceil(aHeight / aCellSize))}
+{
+}
+
+InterestGrid::~InterestGrid() = default;
+
+void InterestGrid::Clear()
+{
+    m_ids.clear();
+    m_xs.clear();
+    m_ys.clear();
+}
+
+void InterestGrid::Add(uint32_t aId, float aX, float aY)
+{
+    m_ids.push_back(aId);
+    m_xs.push_back(aX);
+    m_ys.push_back(aY);
+}
+
+void InterestGrid::Build(size_t aThreadCount)
+{
+    const size_t count = m_ids.size();
+    const size_t cellCount = GetCellCount();
+
+    // Counting sort: every chunk counts its entities per cell, the prefix sum over cells then chunks
+    // gives each chunk its own write position in every cell so the scatter needs no synchronization
+    aThreadCount = std::max<size_t>(1, std::min(aThreadCount, count / 4096 + 1));
+
+    m_cells.resize(count);
+    std::vector<std::vector<uint32_t>> histograms(aThreadCount, std::vector<uint32_t>(cellCount, 0));
+
+    ParallelFor(aThreadCount, count, [this, &histograms](size_t aBegin, size_t aEnd, size_t aChunk)
+    {
+        auto& histogram = histograms[aChunk];
+        for (size_t i = aBegin; i < aEnd; ++i)
+        {
+            m_cells[i] = GetCell(m_xs[i], m_ys[i]);
+            ++histogram[m_cells[i]];
+        }
+    });
+
+    m_cellStart.resize(cellCount + 1);
+
+    uint32_t offset = 0;
+    for (size_t cell = 0; cell < cellCount; ++cell)
+    {
+        m_cellStart[cell] = offset;
+        for (auto& histogram : histograms)
+        {
+            const auto cellCountInChunk = histogram[cell];
+            histogram[cell] = offset;
+            offset += cellCountInChunk;
+        }
+    }
+    m_cellStart[cellCount] = offset;
+
+    m_sortedIds.resize(count);
+    m_sortedXs.resize(count);
+    m_sortedYs.resize(count);
+
+    ParallelFor(aThreadCount, count, [this, &histograms](size_t aBegin, size_t aEnd, size_t aChunk)
+    {
+        auto& positions = histograms[aChunk];
+        for (size_t i = aBegin; i < aEnd; ++i)
+        {
+            const auto destination = positions[m_cells[i]]++;
+            m_sortedIds[destination] = m_ids[i];
+            m_sortedXs[destination] = m_xs[i];
+            m_sortedYs[destination] = m_ys[i];
+        }
+    });
+}
+
+void InterestGrid::Update(View& aView) const
+{
+    auto& current = aView.m_scratch;
+    current.clear();
+
+    Query(aView.X, aView.Y, aView.Radius, [&current](uint32_t aId) { current.push_back(aId); });
+    std::sort(current.begin(), current.end());
+
+    aView.Entered.clear();
+    aView.Left.clear();
+    std::set_difference(current.begin(), current.end(), aView.Visible.begin(), aView.Visible.end(), std::back_inserter(aView.Entered));
+    std::set_difference(aView.Visible.begin(), aView.Visible.end(), current.begin(), current.end(), std::back_inserter(aView.Left));
+
+    aView.Visible.swap(current);
+}
+
+void InterestGrid::Update(View* apViews, size_t aCount, size_t aThreadCount) const
+{
+    aThreadCount = std::min(aThreadCount, aCount / s_viewsPerThread + 1);
+
+    ParallelFor(aThreadCount, aCount, [this, apViews](size_t aBegin, size_t aEnd, size_t)
+    {
+        for (size_t i = aBegin; i < aEnd; ++i)
+            Update(apViews[i]);
+    });
+}
+
+size_t InterestGrid::GetEntityCount() const
+{
+    return m_sortedIds.size();
+}
+
+size_t InterestGrid::GetCellCount() const
+{
+    return (size_t)m_columns * m_rows;
+}
+
+uint32_t InterestGrid::GetCell(float aX, float aY) const
+{
+    return GetRow(aY) * m_columns + GetColumn(aX);
+}
+
+uint32_t InterestGrid::GetColumn(float aX) const
+{
+    // Clamped before the conversion, a float past the range of uint32_t does not convert. NaN lands in the first column.
+    const auto column = (aX - m_minX) * m_inverseCellSize;
+    return column > 0.f ? (uint32_t)std::min(column, float(m_columns - 1)) : 0;
+}
+
+uint32_t InterestGrid::GetRow(float aY) const
+{
+    const auto row = (aY - m_minY) * m_inverseCellSize;
+    return row > 0.f ? (uint32_t)std::min(row, float(m_rows - 1)) : 0;
+}
\ No newline at end of file
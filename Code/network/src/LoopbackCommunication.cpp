@@ -0,0 +1,64 @@
+#include "LoopbackCommunication.h"
+
+
+LoopbackCommunication::LoopbackCommunication(const Endpoint& acLocal, bool aTrusted)
+    : m_pPeer(nullptr)
+    , m_local(acLocal)
+    , m_trusted(aTrusted)
+{
+
+}
+
+LoopbackCommunication::~LoopbackCommunication()
+{
+    if (m_pPeer)
+        m_pPeer->m_pPeer = nullptr;
+}
+
+void LoopbackCommunication::Link(LoopbackCommunication& aPeer)
+{
+    m_pPeer = &aPeer;
+    aPeer.m_pPeer = this;
+}
+
+bool LoopbackCommunication::Send(const Endpoint& acRemote, Buffer aBuffer)
+{
+    if (m_pPeer == nullptr || acRemote != m_pPeer->m_local)
+        return false;
+
+    m_pPeer->m_queue.push_back(Socket::Packet{ m_local, std::move(aBuffer) });
+
+    return true;
+}
+
+bool LoopbackCommunication::IsTrusted() const
+{
+    return m_trusted;
+}
+
+Outcome<Socket::Packet, Socket::Error> LoopbackCommunication::Receive()
+{
+    if (m_queue.empty())
+        return Socket::kDiscardError;
+
+    Socket::Packet packet = std::move(m_queue.front());
+    m_queue.pop_front();
+
+    return packet;
+}
+
+const Endpoint& LoopbackCommunication::GetLocalEndpoint() const
+{
+    return m_local;
+}
+
+bool LoopbackCommunication::IsReady() const
+{
+    return !m_queue.empty();
+}
+
+
+size_t LoopbackCommunication::GetQueuedCount() const
+{
+    return m_queue.size();
+}
\ No newline at end of file
@@ -0,0 +1,390 @@
+#include "Replication.h"
+#include "Connection.h"
+#include "Profiler.h"
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define REPLICATION_SSE2 1
+#endif
+
+namespace
+{
+    // Index of the first non zero mask in [aBegin, aCount), aCount if there is none
+    size_t FindPending(const uint64_t* apMasks, size_t aBegin, size_t aCount)
+    {
+        size_t i = aBegin;
+#if REPLICATION_SSE2
+        const auto zero = _mm_setzero_si128();
+        for (; i + 4 <= aCount; i += 4)
+        {
+            const auto first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(apMasks + i));
+            const auto second = _mm_loadu_si128(reinterpret_cast<const __m128i*>(apMasks + i + 2));
+            if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_or_si128(first, second), zero)) != 0xFFFF)
+                break;
+        }
+#endif
+        for (; i < aCount; ++i)
+        {
+            if (apMasks[i])
+                return i;
+        }
+
+        return aCount;
+    }
+
+    uint64_t GetValueMask(size_t aBits)
+    {
+        return aBits >= 64 ? ~uint64_t(0) : (uint64_t(1) << aBits) - 1;
+    }
+
+    // Objects are written in increasing order, their ids are encoded as the gap with the previous one
+    constexpr size_t s_gapBits[] = { 4, 8, 16, 32 };
+
+    size_t GetGapClass(uint32_t aGap)
+    {
+        return aGap < (1 << 4) ? 0 : aGap < (1 << 8) ? 1 : aGap < (1 << 16) ? 2 : 3;
+    }
+}
+
+Replication::Peer::Peer(Replication& aReplication)
+    : m_replication(aReplication)
+    , m_sequence{0}
+{
+    m_replication.m_peers.push_back(this);
+
+    // Everything that already exists has to be sent
+    m_pending.resize(m_replication.m_objectTypes.size(), 0);
+    for (ObjectId i = 0; i < m_pending.size(); ++i)
+    {
+        if (m_replication.IsAlive(i))
+            m_pending[i] = m_replication.m_types[m_replication.m_objectTypes[i]].Mask | ExistenceBit;
+    }
+}
+
+Replication::Peer::~Peer()
+{
+    auto& peers = m_replication.m_peers;
+    peers.erase(std::remove(peers.begin(), peers.end(), this), peers.end());
+}
+
+void Replication::Peer::Acknowledge(uint32_t aSequence)
+{
+    while (!m_inFlight.empty() && int32_t(m_inFlight.front().Sequence - aSequence) <= 0)
+    {
+        if (m_inFlight.front().Sequence != aSequence)
+            Resend(m_inFlight.front());
+
+        m_inFlight.pop_front();
+    }
+}
+
+bool Replication::Peer::HasPending() const
+{
+    return FindPending(m_pending.data(), 0, m_pending.size()) != m_pending.size();
+}
+
+void Replication::Peer::Resend(const Update& acUpdate)
+{
+    for (size_t i = 0; i < acUpdate.Objects.size(); ++i)
+    {
+        const auto object = acUpdate.Objects[i];
+        if (object >= m_pending.size())
+            m_pending.resize(object + 1, 0);
+
+        m_pending[object] |= acUpdate.Masks[i];
+    }
+}
+
+Replication::~Replication() = default;
+
+uint32_t Replication::RegisterType(std::initializer_list<uint8_t> aFieldBits)
+{
+    if (m_types.size() >= MaxTypes || aFieldBits.size() > MaxFields)
+        return InvalidType;
+
+    for (auto bits : aFieldBits)
+    {
+        if (bits == 0 || bits > 64)
+            return InvalidType;
+    }
+
+    Type type;
+    type.Bits = aFieldBits;
+    type.Mask = GetValueMask(aFieldBits.size());
+
+    m_types.push_back(std::move(type));
+
+    return (uint32_t)(m_types.size() - 1);
+}
+
+Replication::ObjectId Replication::Create(uint32_t aType)
+{
+    if (aType >= m_types.size())
+        return InvalidObject;
+
+    ObjectId object;
+    if (!m_free.empty())
+    {
+        object = m_free.back();
+        m_free.pop_back();
+    }
+    else if (m_objectTypes.size() < MaxObjects)
+        object = (ObjectId)m_objectTypes.size();
+    else
+        return InvalidObject;
+
+    Allocate(object, aType);
+    m_dirty[object] |= m_types[aType].Mask | ExistenceBit;
+
+    return object;
+}
+
+void Replication::Destroy(ObjectId aObject)
+{
+    if (!IsAlive(aObject))
+        return;
+
+    m_objectTypes[aObject] = InvalidType;
+    m_dirty[aObject] = ExistenceBit;
+    m_free.push_back(aObject);
+}
+
+void Replication::Set(ObjectId aObject, uint32_t aField, uint64_t aValue)
+{
+    if (!IsAlive(aObject))
+        return;
+
+    const auto& type = m_types[m_objectTypes[aObject]];
+    if (aField >= type.Bits.size())
+        return;
+
+    aValue &= GetValueMask(type.Bits[aField]);
+
+    auto& value = m_values[m_offsets[aObject] + aField];
+    if (value != aValue)
+    {
+        value = aValue;
+        m_dirty[aObject] |= uint64_t(1) << aField;
+    }
+}
+
+uint64_t Replication::Get(ObjectId aObject, uint32_t aField) const
+{
+    if (!IsAlive(aObject) || aField >= m_types[m_objectTypes[aObject]].Bits.size())
+        return 0;
+
+    return m_values[m_offsets[aObject] + aField];
+}
+
+uint32_t Replication::GetType(ObjectId aObject) const
+{
+    return aObject < m_objectTypes.size() ? m_objectTypes[aObject] : InvalidType;
+}
+
+bool Replication::IsAlive(ObjectId aObject) const
+{
+    return GetType(aObject) != InvalidType;
+}
+
+size_t Replication::GetObjectCount() const
+{
+    return std::count_if(m_objectTypes.begin(), m_objectTypes.end(), [](uint32_t aType) { return aType != InvalidType; });
+}
+
+void Replication::Commit()
+{
+    const auto count = m_dirty.size();
+    const auto* pDirty = m_dirty.data();
+
+    for (auto* pPeer : m_peers)
+    {
+        pPeer->m_pending.resize(count, 0);
+
+        auto* pPending = pPeer->m_pending.data();
+        for (size_t i = 0; i < count; ++i)
+            pPending[i] |= pDirty[i];
+    }
+
+    std::fill(m_dirty.begin(), m_dirty.end(), 0);
+}
+
+bool Replication::Write(Peer& aPeer, Buffer::Writer& aWriter)
+{
+    PROFILE_ZONE(zone, "Replication::Write");
+
+    auto& pending = aPeer.m_pending;
+    const auto count = pending.size();
+
+    auto object = FindPending(pending.data(), 0, count);
+    // Room for the sequence and the end marker
+    if (object == count || aWriter.GetRemainingBits() < 33)
+        return false;
+
+    Peer::Update update;
+    update.Sequence = aPeer.m_sequence;
+
+    aWriter.WriteBits(update.Sequence, 32);
+
+    int64_t previous = -1;
+    for (; object < count; object = FindPending(pending.data(), object + 1, count))
+    {
+        const auto mask = pending[object];
+        const auto gap = uint32_t(object - previous - 1);
+        const auto gapClass = GetGapClass(gap);
+
+        size_t bits = 1 + 2 + s_gapBits[gapClass] + 1;
+
+        const bool alive = IsAlive((ObjectId)object);
+        const Type* pType = alive ? &m_types[m_objectTypes[object]] : nullptr;
+        if (pType)
+        {
+            bits += 8 + pType->Bits.size();
+            for (size_t field = 0; field < pType->Bits.size(); ++field)
+            {
+                if (mask & (uint64_t(1) << field))
+                    bits += pType->Bits[field];
+            }
+        }
+
+        if (bits + 1 > aWriter.GetRemainingBits())
+            break;
+
+        aWriter.WriteBits(1, 1);
+        aWriter.WriteBits(gapClass, 2);
+        aWriter.WriteBits(gap, s_gapBits[gapClass]);
+        aWriter.WriteBits(alive ? 1 : 0, 1);
+
+        if (pType)
+        {
+            const auto fieldCount = pType->Bits.size();
+            const auto* pValues = m_values.data() + m_offsets[object];
+
+            aWriter.WriteBits(m_objectTypes[object], 8);
+            aWriter.WriteBits(mask & pType->Mask, fieldCount);
+
+            for (size_t field = 0; field < fieldCount; ++field)
+            {
+                if (mask & (uint64_t(1) << field))
+                    aWriter.WriteBits(pValues[field], pType->Bits[field]);
+            }
+        }
+
+        update.Objects.push_back((ObjectId)object);
+        update.Masks.push_back(mask);
+        pending[object] = 0;
+        previous = (int64_t)object;
+    }
+
+    aWriter.WriteBits(0, 1);
+
+    ++aPeer.m_sequence;
+    aPeer.m_inFlight.push_back(std::move(update));
+
+    if (aPeer.m_inFlight.size() > Peer::MaxInFlight)
+    {
+        aPeer.Resend(aPeer.m_inFlight.front());
+        aPeer.m_inFlight.pop_front();
+    }
+
+    return true;
+}
+
+bool Replication::Send(Peer& aPeer, Connection& aConnection, uint32_t aChannel)
+{
+    // Leaves room for forward error correction in case the channel uses it
+    uint8_t data[Connection::MaxPayloadSize - ForwardErrorCorrection::Overhead];
+    Buffer::Writer writer(data, sizeof(data));
+
+    if (!Write(aPeer, writer))
+        return false;
+
+    return aConnection.Send(aChannel, data, (writer.GetBitPosition() + 7) / 8);
+}
+
+bool Replication::Read(Buffer::Reader& aReader, uint32_t& aSequence)
+{
+    PROFILE_ZONE(zone, "Replication::Read");
+
+    uint64_t sequence;
+    if (!aReader.ReadBits(sequence, 32))
+        return false;
+
+    if (m_hasReceived && int32_t(uint32_t(sequence) - m_receiveSequence) <= 0)
+        return false;
+
+    int64_t previous = -1;
+    for (;;)
+    {
+        uint64_t more, gapClass, gap, alive;
+        if (!aReader.ReadBits(more, 1))
+            return false;
+
+        if (!more)
+            break;
+
+        if (!aReader.ReadBits(gapClass, 2) || !aReader.ReadBits(gap, s_gapBits[gapClass]) || !aReader.ReadBits(alive, 1))
+            return false;
+
+        const auto object = uint64_t(previous + 1) + gap;
+        if (object >= MaxObjects)
+            return false;
+
+        previous = (int64_t)object;
+
+        if (!alive)
+        {
+            if (IsAlive((ObjectId)object))
+                m_objectTypes[object] = InvalidType;
+
+            continue;
+        }
+
+        uint64_t typeIndex, mask;
+        if (!aReader.ReadBits(typeIndex, 8) || typeIndex >= m_types.size())
+            return false;
+
+        const auto& type = m_types[typeIndex];
+        if (!aReader.ReadBits(mask, type.Bits.size()))
+            return false;
+
+        if (GetType((ObjectId)object) != typeIndex)
+            Allocate((ObjectId)object, (uint32_t)typeIndex);
+
+        auto* pValues = m_values.data() + m_offsets[object];
+        for (size_t field = 0; field < type.Bits.size(); ++field)
+        {
+            if ((mask & (uint64_t(1) << field)) && !aReader.ReadBits(pValues[field], type.Bits[field]))
+                return false;
+        }
+    }
+
+    m_hasReceived = true;
+    m_receiveSequence = (uint32_t)sequence;
+    aSequence = (uint32_t)sequence;
+
+    return true;
+}
+
+void Replication::Allocate(ObjectId aObject, uint32_t aType)
+{
+    if (aObject >= m_objectTypes.size())
+    {
+        m_objectTypes.resize(aObject + 1, InvalidType);
+        m_offsets.resize(aObject + 1, 0);
+        m_capacities.resize(aObject + 1, 0);
+        m_dirty.resize(aObject + 1, 0);
+    }
+
+    // Slots keep their values when reused by a type with as many fields or less
+    const auto fieldCount = m_types[aType].Bits.size();
+    if (m_capacities[aObject] < fieldCount)
+    {
+        m_offsets[aObject] = (uint32_t)m_values.size();
+        m_capacities[aObject] = (uint8_t)fieldCount;
+        m_values.resize(m_values.size() + fieldCount, 0);
+    }
+
+    std::fill_n(m_values.begin() + m_offsets[aObject], fieldCount, 0);
+    m_objectTypes[aObject] = aType;
+}
\ No newline at end of file
@@ -1,28 +1,52 @@
-#include "Selector.h"
-
-Selector::Selector(Socket& aSocket)
-    : m_sock{aSocket.m_sock}
-{
-}
-
-bool Selector::IsReady() const
-{
-    fd_set set;
-#ifdef _WIN32
-    set.fd_count = 1;
-    set.fd_array[0] = m_sock;
-#else
-    FD_ZERO(&set);
-    FD_SET(m_sock, &set);
-#endif
-
-    timeval tm;
-    tm.tv_sec = 0;
-    tm.tv_usec = 0;
-
-#ifdef _WIN32
-    return select(set.fd_count, &set, nullptr, nullptr, &tm) == 1;
-#else
-    return select(m_sock + 1, &set, nullptr, nullptr, &tm) == 1;
-#endif
+#include "Selector.h"
+#include <algorithm>
+
+Selector::Selector(Socket& aSocket)
+    : m_count{1}
+{
+    m_socks[0] = aSocket.m_sock;
+}
+
+Selector::Selector(std::initializer_list<Socket*> aSockets)
+    : m_count{0}
+{
+    for (auto* pSocket : aSockets)
+    {
+        if (m_count < MaxSockets)
+            m_socks[m_count++] = pSocket->m_sock;
+    }
+}
+
+bool Selector::IsReady() const
+{
+    return Wait(0);
+}
+
+bool Selector::Wait(uint64_t aTimeoutMicroseconds) const
+{
+    fd_set set;
+#ifdef _WIN32
+    set.fd_count = (u_int)m_count;
+    for (size_t i = 0; i < m_count; ++i)
+        set.fd_array[i] = m_socks[i];
+#else
+    FD_ZERO(&set);
+
+    Socket_t highest = 0;
+    for (size_t i = 0; i < m_count; ++i)
+    {
+        FD_SET(m_socks[i], &set);
+        highest = std::max(highest, m_socks[i]);
+    }
+#endif
+
+    timeval tm;
+    tm.tv_sec = long(aTimeoutMicroseconds / 1000000);
+    tm.tv_usec = long(aTimeoutMicroseconds % 1000000);
+
+#ifdef _WIN32
+    return select(set.fd_count, &set, nullptr, nullptr, &tm) >= 1;
+#else
+    return select(highest + 1, &set, nullptr, nullptr, &tm) >= 1;
+#endif
 }
\ No newline at end of file
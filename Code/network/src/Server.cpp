@@ -1,110 +1,515 @@
-#include "Server.h"
-#include "Selector.h"
-
-Server::Server()
-    : m_connectionManager(64)
-    , m_v4Listener(Endpoint::kIPv4)
-    , m_v6Listener(Endpoint::kIPv6)
-{
-
-}
-
-Server::~Server()
-{
-}
-
-bool Server::Start(uint16_t aPort)
-{
-    if (m_v4Listener.Bind(aPort) == false)
-    {
-        return false;
-    }
-    return m_v6Listener.Bind(m_v4Listener.GetPort());
-}
-
-uint32_t Server::Update(uint64_t aElapsedMilliSeconds)
-{
-    m_connectionManager.Update(aElapsedMilliSeconds);
-
-    return Work();
-}
-
-uint16_t Server::GetPort() const
-{
-    return m_v4Listener.GetPort();
-}
-
-bool Server::Send(const Endpoint& acRemoteEndpoint, Buffer aBuffer)
-{
-    if (acRemoteEndpoint.IsIPv6())
-    {
-        Socket::Packet packet{ acRemoteEndpoint, std::move(aBuffer) };
-
-        m_v6Listener.Send(packet);
-    }
-
-    return false;
-}
-
-bool Server::ProcessPacket(Socket::Packet& aPacket)
-{
-    auto pConnection = m_connectionManager.Find(aPacket.Remote);
-    if (!pConnection)
-    {
-        Connection connection(*this, aPacket.Remote);
-
-        m_connectionManager.Add(std::move(connection));
-
-        return true;
-    }
-    else if(m_connectionManager.IsFull() == false)
-    {
-        // New connection
-
-
-        return true;
-    }
-
-    return false;
-}
-
-uint32_t Server::Work()
-{
-    uint32_t processedPackets = 0;
-
-    Selector selector(m_v4Listener);
-    while (selector.IsReady())
-    {
-        auto result = m_v4Listener.Receive();
-        if (result.HasError())
-        {
-            // do some error handling
-            continue;
-        }
-        else
-        {
-            // Route packet to a connection
-            if (ProcessPacket(result.GetResult()))
-                ++processedPackets;
-        }
-    }
-
-    Selector selectorv6(m_v6Listener);
-    while (selectorv6.IsReady())
-    {
-        auto result = m_v6Listener.Receive();
-        if (result.HasError())
-        {
-            // do some error handling
-            continue;
-        }
-        else
-        {
-            // Route packet to a connection
-            if (ProcessPacket(result.GetResult()))
-                ++processedPackets;
-        }
-    }
-
-    return processedPackets;
+#include "Server.h"
+#include "Log.h"
+#include "Selector.h"
+#include "Realtime.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cstring>
+
+Server::Server()
+    : m_packetsPerConnection(0)
+    , m_connectionManager(64)
+    , m_v4Listener(Endpoint::kIPv4)
+    , m_v6Listener(Endpoint::kIPv6)
+    , m_handedOff(false)
+    , m_pStatisticsAllocator(nullptr)
+    , m_tick(0)
+    , m_lastTickStart(0)
+    , m_maxTickDuration(0)
+    , m_spin(false)
+{
+
+}
+
+Server::~Server()
+{
+}
+
+bool Server::Start(uint16_t aPort)
+{
+    if (m_v4Listener.Bind(aPort) == false)
+    {
+        return false;
+    }
+    return m_v6Listener.Bind(m_v4Listener.GetPort());
+}
+
+bool Server::Start(uint16_t aPort, const CapacityPlan& acPlan)
+{
+    return Reserve(acPlan) && Start(aPort);
+}
+
+bool Server::Reserve(const CapacityPlan& acPlan)
+{
+    if (m_connectionManager.GetCount() > 0 || !m_connectionManager.SetCapacity(acPlan.MaxConnections))
+        return false;
+
+    m_pPacketPool = std::make_unique<PoolAllocator>(Connection::MaxPacketSize, acPlan.MaxConnections * acPlan.PacketsPerConnection);
+    m_packetsPerConnection = acPlan.PacketsPerConnection;
+    if (!m_pPacketPool->IsValid())
+    {
+        m_pPacketPool.reset();
+        return false;
+    }
+
+    if (acPlan.PrefaultStack)
+        Realtime::PrefaultStack(acPlan.PrefaultStack);
+
+    return true;
+}
+
+uint32_t Server::Update()
+{
+    const auto now = Clock::Tick();
+
+    if (m_handedOff)
+        return 0;
+
+    if (m_handoff.Accept())
+    {
+        m_handedOff = Transfer();
+        if (m_handedOff)
+            return 0;
+    }
+
+    m_connectionManager.Update(now);
+
+    const auto processed = Work();
+
+    if (m_statistics.IsValid())
+        Publish(now);
+
+    return processed;
+}
+
+bool Server::Wait(uint64_t aTimeout)
+{
+    for (auto* pLoopback : m_loopbacks)
+    {
+        if (pLoopback->IsReady())
+            return true;
+    }
+
+    const auto deadline = Clock::GetTimestamp() + aTimeout;
+
+    // The descriptors can change on Resume so the selector is built on demand
+    Selector selector({ &m_v4Listener, &m_v6Listener });
+
+    if (m_spin)
+    {
+        for (;;)
+        {
+            if (selector.IsReady())
+                return true;
+
+            for (auto* pLoopback : m_loopbacks)
+            {
+                if (pLoopback->IsReady())
+                    return true;
+            }
+
+            const auto now = Clock::GetTimestamp();
+            if (now >= deadline)
+            {
+                m_timerOvershoot.Record(now - deadline);
+                return false;
+            }
+
+            Realtime::Relax();
+        }
+    }
+
+    if (selector.Wait(aTimeout / 1000))
+        return true;
+
+    const auto now = Clock::GetTimestamp();
+    m_timerOvershoot.Record(now > deadline ? now - deadline : 0);
+
+    return false;
+}
+
+bool Server::EnableLowLatency(const LowLatency& acConfig)
+{
+    bool result = true;
+
+    if (acConfig.Core >= 0 && !Realtime::PinCurrentThread((uint32_t)acConfig.Core))
+    {
+        LOG_WARNING("Failed to pin the server thread to core %d", acConfig.Core);
+        result = false;
+    }
+
+    if (acConfig.BusyPoll && (!m_v4Listener.EnableBusyPoll(acConfig.BusyPoll) || !m_v6Listener.EnableBusyPoll(acConfig.BusyPoll)))
+    {
+        LOG_WARNING("Socket busy polling was refused");
+        result = false;
+    }
+
+    if (acConfig.LockMemory && !Realtime::LockMemory())
+    {
+        LOG_WARNING("Failed to lock the process memory");
+        result = false;
+    }
+
+    if (acConfig.PrefaultStack)
+        Realtime::PrefaultStack(acConfig.PrefaultStack);
+
+    m_spin = acConfig.Spin;
+
+    return result;
+}
+
+const Histogram& Server::GetTimerOvershoot() const
+{
+    return m_timerOvershoot;
+}
+
+void Server::ResetTimerOvershoot()
+{
+    m_timerOvershoot.Reset();
+}
+
+uint16_t Server::GetPort() const
+{
+    return m_v4Listener.GetPort();
+}
+
+size_t Server::GetConnectionCount() const
+{
+    return m_connectionManager.GetCount();
+}
+
+bool Server::EnableStatistics(const std::string& acName, const Allocator* apAllocator)
+{
+    m_pStatisticsAllocator = apAllocator;
+
+    return m_statistics.Create(acName);
+}
+
+void Server::SetBudget(const Budget& acBudget)
+{
+    m_budget = acBudget;
+}
+
+const Server::WorkReport& Server::GetWorkReport() const
+{
+    return m_workReport;
+}
+
+Connection* Server::Accept()
+{
+    for (size_t i = 0; i < m_unaccepted.size();)
+    {
+        auto* pConnection = m_unaccepted[i];
+
+        // Peers that never finish their handshake are forgotten once they time out
+        if (pConnection->IsConnected() || pConnection->GetState() == Connection::kNone)
+        {
+            m_unaccepted.erase(std::begin(m_unaccepted) + i);
+            if (pConnection->IsConnected())
+                return pConnection;
+
+            continue;
+        }
+
+        ++i;
+    }
+
+    return nullptr;
+}
+
+const PoolAllocator* Server::GetPacketPool() const
+{
+    return m_pPacketPool.get();
+}
+
+Connection* Server::GetConnection(const Endpoint& acRemoteEndpoint)
+{
+    return m_connectionManager.Find(acRemoteEndpoint);
+}
+
+void Server::Attach(LoopbackCommunication& aCommunication)
+{
+    m_loopbacks.push_back(&aCommunication);
+}
+
+void Server::Detach(LoopbackCommunication& aCommunication)
+{
+    m_loopbacks.erase(std::remove(std::begin(m_loopbacks), std::end(m_loopbacks), &aCommunication), std::end(m_loopbacks));
+
+    // Connections routed through it would keep sending to it once it is destroyed
+    m_connectionManager.ForEach([&aCommunication](Connection& aConnection)
+    {
+        if (&aConnection.GetCommunication() == &aCommunication)
+            aConnection.Close();
+    });
+}
+
+bool Server::EnableHandoff(const std::string& acPath)
+{
+    return m_handoff.Listen(acPath);
+}
+
+bool Server::IsHandedOff() const
+{
+    return m_handedOff;
+}
+
+bool Server::Resume(const std::string& acPath)
+{
+    Handoff handoff;
+    if (handoff.Connect(acPath) == false)
+        return false;
+
+    Buffer state;
+    if (handoff.Receive({ &m_v4Listener, &m_v6Listener }, state) == false)
+        return false;
+
+    Buffer::Reader reader(&state);
+    if (!m_connectionManager.Load(reader, *this))
+        return false;
+
+    if (m_pPacketPool)
+        m_connectionManager.ForEach([this](Connection& aConnection) { aConnection.SetAllocator(m_pPacketPool.get(), m_packetsPerConnection); });
+
+    return true;
+}
+
+bool Server::Resume(const std::string& acPath, const CapacityPlan& acPlan)
+{
+    return Reserve(acPlan) && Resume(acPath);
+}
+
+bool Server::Send(const Endpoint& acRemoteEndpoint, Buffer aBuffer)
+{
+    Socket::Packet packet{ acRemoteEndpoint, std::move(aBuffer) };
+
+    if (acRemoteEndpoint.IsIPv6())
+        return m_v6Listener.Send(packet);
+
+    return m_v4Listener.Send(packet);
+}
+
+size_t Server::Broadcast(uint32_t aChannel, const uint8_t* apData, size_t aLength)
+{
+    return Broadcast(aChannel, apData, aLength, [](const Connection&) { return true; });
+}
+
+bool Server::Enqueue(Connection& aConnection, uint32_t aChannel, const uint8_t* apData, size_t aLength)
+{
+    // In-process peers and channels with parity packets take the regular path
+    if (&aConnection.GetCommunication() != this)
+        return aConnection.Send(aChannel, apData, aLength);
+
+    auto& listener = aConnection.GetRemoteEndpoint().IsIPv6() ? m_v6Listener : m_v4Listener;
+
+    auto* pSlot = listener.Reserve();
+    if (pSlot == nullptr)
+    {
+        listener.Flush();
+        pSlot = listener.Reserve();
+    }
+
+    // The slab is still full when the kernel queue is, the packet then goes out on its own
+    const auto size = pSlot ? aConnection.WritePacket(aChannel, apData, aLength, pSlot) : 0;
+    if (size == 0)
+        return aConnection.Send(aChannel, apData, aLength);
+
+    listener.Commit(aConnection.GetRemoteEndpoint(), size);
+
+    return true;
+}
+
+bool Server::ProcessPacket(Socket::Packet& aPacket, Connection::ICommunication& aCommunication)
+{
+    PROFILE_ZONE(zone, "Server::ProcessPacket");
+    zone.AddItems(1);
+
+    auto pConnection = Route(aPacket.Remote, aCommunication);
+    if (!pConnection)
+        return false;
+
+    // Packets that fail validation are dropped by the connection
+    pConnection->ProcessPacket(std::move(aPacket.Payload));
+
+    return true;
+}
+
+bool Server::ProcessPacket(const uint8_t* apData, size_t aLength, const Endpoint& acRemote)
+{
+    PROFILE_ZONE(zone, "Server::ProcessPacket");
+    zone.AddItems(1);
+
+    auto pConnection = Route(acRemote, *this);
+    if (!pConnection)
+        return false;
+
+    pConnection->ProcessPacket(apData, aLength);
+
+    return true;
+}
+
+Connection* Server::Route(const Endpoint& acRemote, Connection::ICommunication& aCommunication)
+{
+    auto pConnection = m_connectionManager.Find(acRemote);
+    if (pConnection)
+        return pConnection;
+
+    if (m_connectionManager.IsFull())
+    {
+        LOG_WARNING("Connection table full, dropping packet from port %u", acRemote.GetPort());
+        return nullptr;
+    }
+
+    // New connection
+    m_connectionManager.Add(Connection(aCommunication, acRemote));
+
+    pConnection = m_connectionManager.Find(acRemote);
+    if (pConnection && m_pPacketPool)
+        pConnection->SetAllocator(m_pPacketPool.get(), m_packetsPerConnection);
+
+    if (pConnection)
+        m_unaccepted.push_back(pConnection);
+
+    return pConnection;
+}
+
+bool Server::Transfer()
+{
+    // Anything that arrives from now on stays queued in the shared sockets for the successor
+    Buffer state(4 + m_connectionManager.GetCount() * Connection::MaxSerializedSize);
+
+    Buffer::Writer writer(&state);
+    if (m_connectionManager.Save(writer) == false)
+        return false;
+
+    return m_handoff.Send({ &m_v4Listener, &m_v6Listener }, state, writer.GetBytePosition());
+}
+
+uint32_t Server::Work()
+{
+    PROFILE_ZONE(zone, "Server::Work");
+
+    const auto deadline = Clock::GetNow() + Clock::Microseconds(m_budget.MaxMicroseconds);
+
+    // New peers are only welcome once the previous backlog has been cleared
+    const bool shedNewConnections = m_workReport.Backlogged;
+
+    WorkReport report;
+    size_t remaining = m_budget.MaxPackets;
+
+    auto exhausted = [&]()
+    {
+        return remaining == 0 || (m_budget.MaxMicroseconds != 0 && Clock::GetTimestamp() >= deadline);
+    };
+
+    auto route = [&](const uint8_t* apData, size_t aLength, const Endpoint& acRemote)
+    {
+        if (shedNewConnections && m_connectionManager.Find(acRemote) == nullptr)
+            ++report.ShedPackets;
+        else if (ProcessPacket(apData, aLength, acRemote))
+            ++report.ProcessedPackets;
+    };
+
+    // Take turns between sources one batch at a time so none of them can starve the others
+    bool progress = true;
+    while (progress && !exhausted())
+    {
+        progress = false;
+
+        for (auto* pListener : { &m_v4Listener, &m_v6Listener })
+        {
+            auto count = pListener->ReceiveAll(route, std::min(remaining, Socket::ReceiveBatchSize));
+            remaining -= count;
+            progress |= count != 0;
+        }
+
+        for (auto* pLoopback : m_loopbacks)
+        {
+            for (size_t i = 0; i < Socket::ReceiveBatchSize && remaining > 0 && pLoopback->IsReady(); ++i, --remaining)
+            {
+                auto result = pLoopback->Receive();
+                if (result.HasError())
+                    continue;
+
+                auto& packet = result.GetResult();
+                if (shedNewConnections && m_connectionManager.Find(packet.Remote) == nullptr)
+                    ++report.ShedPackets;
+                else if (ProcessPacket(packet, *pLoopback))
+                    ++report.ProcessedPackets;
+
+                progress = true;
+            }
+        }
+    }
+
+    report.QueuedBytes = m_v4Listener.GetQueuedBytes() + m_v6Listener.GetQueuedBytes();
+    for (auto* pLoopback : m_loopbacks)
+        report.QueuedLoopbackPackets += pLoopback->GetQueuedCount();
+
+    report.Backlogged = progress && (report.QueuedBytes != 0 || report.QueuedLoopbackPackets != 0);
+
+    m_workReport = report;
+
+    zone.AddItems(report.ProcessedPackets + report.ShedPackets);
+
+    return report.ProcessedPackets;
+}
+
+void Server::Publish(uint64_t aStart)
+{
+    const auto end = Clock::GetTimestamp();
+    const auto duration = end - aStart;
+    m_maxTickDuration = std::max(m_maxTickDuration, duration);
+
+    auto& snapshot = m_statistics.Begin();
+
+    snapshot.Tick = ++m_tick;
+    snapshot.Timestamp = end;
+    snapshot.TickInterval = m_lastTickStart ? aStart - m_lastTickStart : 0;
+    snapshot.TickDuration = duration;
+    snapshot.MaxTickDuration = m_maxTickDuration;
+    snapshot.ProcessedPackets = m_workReport.ProcessedPackets;
+    snapshot.ShedPackets = m_workReport.ShedPackets;
+    snapshot.QueuedBytes = m_workReport.QueuedBytes;
+    snapshot.AllocatedBytes = m_pStatisticsAllocator ? m_pStatisticsAllocator->GetUsedMemory() : 0;
+    snapshot.ConnectionCount = (uint32_t)m_connectionManager.GetCount();
+
+    uint32_t count = 0;
+    m_connectionManager.ForEach([&snapshot, &count](Connection& aConnection)
+    {
+        if (count == ServerStatistics::MaxConnections)
+            return;
+
+        auto& peer = snapshot.Connections[count++];
+        const auto& remote = aConnection.GetRemoteEndpoint();
+        const auto& statistics = aConnection.GetStatistics();
+
+        std::memset(peer.Address, 0, sizeof(peer.Address));
+        if (remote.IsIPv6())
+        {
+            for (int i = 0; i < 8; ++i)
+            {
+                peer.Address[i * 2] = uint8_t(remote.GetIPv6()[i] >> 8);
+                peer.Address[i * 2 + 1] = uint8_t(remote.GetIPv6()[i]);
+            }
+        }
+        else
+            std::memcpy(peer.Address, remote.GetIPv4(), 4);
+
+        peer.Port = remote.GetPort();
+        peer.IPv6 = remote.IsIPv6();
+        peer.State = (uint8_t)aConnection.GetState();
+        peer.RoundTrip = aConnection.GetClockSync().GetRoundTrip();
+        peer.SentPackets = statistics.SentPackets;
+        peer.SentBytes = statistics.SentBytes;
+        peer.ReceivedPackets = statistics.ReceivedPackets;
+        peer.ReceivedBytes = statistics.ReceivedBytes;
+        peer.DroppedPackets = statistics.DroppedPackets;
+    });
+
+    snapshot.ListedCount = count;
+
+    m_statistics.End();
+
+    m_lastTickStart = aStart;
 }
\ No newline at end of file
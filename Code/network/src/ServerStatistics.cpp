@@ -0,0 +1,87 @@
+#include "ServerStatistics.h"
+#include <cstring>
+#include <new>
+#include <thread>
+
+ServerStatistics::ServerStatistics()
+    : m_pSegment(nullptr)
+{
+}
+
+ServerStatistics::~ServerStatistics()
+{
+}
+
+bool ServerStatistics::Create(const std::string& acName)
+{
+    m_pSegment = nullptr;
+
+    if (!m_memory.Create(acName, sizeof(Segment)))
+        return false;
+
+    m_pSegment = new (m_memory.GetData()) Segment();
+    m_pSegment->Version = Version;
+    m_pSegment->Sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    m_pSegment->Magic = Magic;
+
+    return true;
+}
+
+bool ServerStatistics::Open(const std::string& acName)
+{
+    m_pSegment = nullptr;
+
+    if (!m_memory.Open(acName, true) || m_memory.GetSize() < sizeof(Segment))
+        return false;
+
+    auto* pSegment = static_cast<Segment*>(m_memory.GetData());
+    if (pSegment->Magic != Magic || pSegment->Version != Version)
+        return false;
+
+    m_pSegment = pSegment;
+
+    return true;
+}
+
+bool ServerStatistics::IsValid() const
+{
+    return m_pSegment != nullptr;
+}
+
+ServerStatistics::Snapshot& ServerStatistics::Begin()
+{
+    m_pSegment->Sequence.store(m_pSegment->Sequence.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    return m_pSegment->Data;
+}
+
+void ServerStatistics::End()
+{
+    m_pSegment->Sequence.store(m_pSegment->Sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+bool ServerStatistics::Read(Snapshot& aSnapshot, size_t aAttempts) const
+{
+    if (!m_pSegment)
+        return false;
+
+    for (size_t i = 0; i < aAttempts; ++i)
+    {
+        const auto before = m_pSegment->Sequence.load(std::memory_order_acquire);
+        if (before & 1)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        std::memcpy(&aSnapshot, &m_pSegment->Data, sizeof(Snapshot));
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        if (m_pSegment->Sequence.load(std::memory_order_relaxed) == before)
+            return true;
+    }
+
+    return false;
+}
\ No newline at end of file
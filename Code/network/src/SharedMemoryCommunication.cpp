@@ -0,0 +1,159 @@
+#include "SharedMemoryCommunication.h"
+#include <algorithm>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <climits>
+#else
+#include <chrono>
+#include <thread>
+#endif
+
+static constexpr uint32_t s_controlMagic = 0x444F5753;
+
+static size_t GetControlSize()
+{
+    // Keep the rings cache line aligned
+    return 64 * 2;
+}
+
+SharedMemoryCommunication::SharedMemoryCommunication(const Endpoint& acRemote)
+    : m_pControl(nullptr)
+    , m_side(0)
+    , m_remote(acRemote)
+{
+    static_assert(sizeof(Control) <= 128, "Control block does not fit");
+}
+
+bool SharedMemoryCommunication::Create(const std::string& acName, size_t aRingCapacity)
+{
+    if ((aRingCapacity & (aRingCapacity - 1)) != 0)
+        return false;
+
+    if (m_memory.Create(acName, GetControlSize() + RingBuffer::GetRequiredSize(aRingCapacity) * 2) == false)
+        return false;
+
+    m_side = 0;
+    m_pControl = (Control*)m_memory.GetData();
+    m_pControl->RingCapacity = (uint32_t)aRingCapacity;
+
+    if (Attach(true) == false)
+        return false;
+
+    // Publish last so the other side never sees a half initialized segment
+    std::atomic_thread_fence(std::memory_order_release);
+    m_pControl->Magic = s_controlMagic;
+
+    return true;
+}
+
+bool SharedMemoryCommunication::Open(const std::string& acName)
+{
+    if (m_memory.Open(acName) == false)
+        return false;
+
+    m_side = 1;
+    m_pControl = (Control*)m_memory.GetData();
+
+    if (m_pControl->Magic != s_controlMagic)
+        return false;
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    return Attach(false);
+}
+
+bool SharedMemoryCommunication::Attach(bool aInitialize)
+{
+    const size_t capacity = m_pControl->RingCapacity;
+    if (m_memory.GetSize() < GetControlSize() + RingBuffer::GetRequiredSize(capacity) * 2)
+        return false;
+
+    auto* pRings = (uint8_t*)m_memory.GetData() + GetControlSize();
+
+    RingBuffer first(pRings, capacity, aInitialize);
+    RingBuffer second(pRings + RingBuffer::GetRequiredSize(capacity), capacity, aInitialize);
+
+    // The creator writes in the first ring, the other side in the second one
+    m_send = m_side == 0 ? first : second;
+    m_receive = m_side == 0 ? second : first;
+
+    return m_send.IsValid() && m_receive.IsValid();
+}
+
+bool SharedMemoryCommunication::Send(const Endpoint& acRemote, Buffer aBuffer)
+{
+    (void)acRemote;
+
+    if (!IsReady() || m_send.Push(aBuffer.GetData(), aBuffer.GetSize()) == false)
+        return false;
+
+    const auto peer = 1 - m_side;
+
+    m_pControl->Signal[peer].fetch_add(1);
+
+    // Only pay for a syscall when the peer is actually sleeping
+    if (m_pControl->Waiting[peer].load())
+    {
+#ifdef __linux__
+        syscall(SYS_futex, (uint32_t*)&m_pControl->Signal[peer], FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+#endif
+    }
+
+    return true;
+}
+
+Outcome<Socket::Packet, Socket::Error> SharedMemoryCommunication::Receive()
+{
+    if (!IsReady())
+        return Socket::kInvalidSocket;
+
+    Buffer buffer;
+    auto popped = m_receive.Pop([&buffer](const uint8_t* apData, size_t aLength)
+    {
+        Buffer payload(aLength);
+        std::copy(apData, apData + aLength, payload.GetWriteData());
+        buffer = std::move(payload);
+    });
+
+    if (!popped)
+        return Socket::kDiscardError;
+
+    Socket::Packet packet{ m_remote, std::move(buffer) };
+
+    return packet;
+}
+
+bool SharedMemoryCommunication::Wait(uint64_t aTimeoutMicroseconds)
+{
+    if (!IsReady())
+        return false;
+
+#ifdef __linux__
+    m_pControl->Waiting[m_side].store(1);
+
+    const auto signal = m_pControl->Signal[m_side].load();
+    if (m_receive.IsEmpty())
+    {
+        timespec timeout;
+        timeout.tv_sec = aTimeoutMicroseconds / 1000000;
+        timeout.tv_nsec = (aTimeoutMicroseconds % 1000000) * 1000;
+
+        syscall(SYS_futex, (uint32_t*)&m_pControl->Signal[m_side], FUTEX_WAIT, signal, &timeout, nullptr, 0);
+    }
+
+    m_pControl->Waiting[m_side].store(0);
+#else
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(aTimeoutMicroseconds);
+    while (m_receive.IsEmpty() && std::chrono::steady_clock::now() < deadline)
+        std::this_thread::yield();
+#endif
+
+    return !m_receive.IsEmpty();
+}
+
+bool SharedMemoryCommunication::IsReady() const
+{
+    return m_pControl != nullptr && m_send.IsValid() && m_receive.IsValid();
+}
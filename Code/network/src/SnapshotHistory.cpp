@@ -0,0 +1,179 @@
+#include "SnapshotHistory.h"
+#include <algorithm>
+
+SnapshotHistory::Baseline::Baseline(SnapshotHistory& aHistory)
+    : m_history(aHistory)
+    , m_slot(InvalidSlot)
+    , m_tick(0)
+{
+}
+
+SnapshotHistory::Baseline::~Baseline()
+{
+    Reset();
+}
+
+bool SnapshotHistory::Baseline::Acknowledge(uint32_t aTick)
+{
+    if (Get() && (int32_t)(aTick - m_tick) <= 0)
+        return true;
+
+    const auto slot = m_history.FindSlot(aTick);
+    if (slot == InvalidSlot)
+        return false;
+
+    // Take the new reference first, the old one may be the last thing keeping a slot alive
+    m_history.AddReference(slot);
+    Reset();
+
+    m_slot = slot;
+    m_tick = aTick;
+
+    return true;
+}
+
+const SnapshotHistory::Snapshot* SnapshotHistory::Baseline::Get() const
+{
+    return m_history.IsValid(m_slot, m_tick) ? &m_history.m_snapshots[m_slot] : nullptr;
+}
+
+void SnapshotHistory::Baseline::Reset()
+{
+    // An evicted baseline holds nothing anymore, its slot may already belong to another tick
+    if (m_history.IsValid(m_slot, m_tick))
+        m_history.RemoveReference(m_slot);
+
+    m_slot = InvalidSlot;
+}
+
+SnapshotHistory::SnapshotHistory(size_t aWindow, size_t aCapacity)
+    : m_snapshots(std::max(aCapacity, aWindow + 1))
+    , m_window(std::max<size_t>(aWindow, 1), InvalidSlot)
+    , m_latest(0)
+    , m_empty(true)
+    , m_count(0)
+    , m_usedMemory(0)
+{
+    m_free.reserve(m_snapshots.size());
+    for (size_t i = m_snapshots.size(); i > 0; --i)
+    {
+        m_snapshots[i - 1].References = 0;
+        m_free.push_back((uint32_t)i - 1);
+    }
+}
+
+bool SnapshotHistory::Push(uint32_t aTick, const uint8_t* apData, size_t aSize)
+{
+    if (!m_empty && (int32_t)(aTick - m_latest) <= 0)
+        return false;
+
+    // Every tick skipped or overwritten in the window loses the history's reference
+    const auto window = (uint32_t)m_window.size();
+    const auto leaving = m_empty ? 0 : std::min(aTick - m_latest, window);
+    for (uint32_t i = 0; i < leaving; ++i)
+    {
+        auto& slot = m_window[(aTick - i) % window];
+        if (slot != InvalidSlot)
+            RemoveReference(slot);
+        slot = InvalidSlot;
+    }
+
+    const auto index = AllocateSlot();
+    auto& snapshot = m_snapshots[index];
+
+    if (snapshot.Data.GetSize() < aSize)
+        snapshot.Data = Buffer(aSize);
+    std::copy(apData, apData + aSize, snapshot.Data.GetWriteData());
+
+    snapshot.Tick = aTick;
+    snapshot.Size = aSize;
+    snapshot.References = 1;
+
+    m_window[aTick % window] = index;
+    m_latest = aTick;
+    m_empty = false;
+    m_usedMemory += aSize;
+
+    return true;
+}
+
+const SnapshotHistory::Snapshot* SnapshotHistory::Find(uint32_t aTick) const
+{
+    const auto slot = FindSlot(aTick);
+
+    return slot != InvalidSlot ? &m_snapshots[slot] : nullptr;
+}
+
+const SnapshotHistory::Snapshot* SnapshotHistory::GetLatest() const
+{
+    return m_empty ? nullptr : Find(m_latest);
+}
+
+size_t SnapshotHistory::GetSnapshotCount() const
+{
+    return m_count;
+}
+
+size_t SnapshotHistory::GetUsedMemory() const
+{
+    return m_usedMemory;
+}
+
+size_t SnapshotHistory::GetWindow() const
+{
+    return m_window.size();
+}
+
+uint32_t SnapshotHistory::FindSlot(uint32_t aTick) const
+{
+    if (m_empty || (int32_t)(m_latest - aTick) < 0 || m_latest - aTick >= m_window.size())
+        return InvalidSlot;
+
+    const auto slot = m_window[aTick % m_window.size()];
+
+    return IsValid(slot, aTick) ? slot : InvalidSlot;
+}
+
+uint32_t SnapshotHistory::AllocateSlot()
+{
+    if (m_free.empty())
+    {
+        // Only baselines outside the window can be left, the oldest one goes and its peers start over
+        uint32_t oldest = InvalidSlot;
+        for (uint32_t i = 0; i < m_snapshots.size(); ++i)
+        {
+            if (m_snapshots[i].References && (oldest == InvalidSlot || (int32_t)(m_snapshots[i].Tick - m_snapshots[oldest].Tick) < 0))
+                oldest = i;
+        }
+
+        m_snapshots[oldest].References = 1;
+        RemoveReference(oldest);
+    }
+
+    const auto slot = m_free.back();
+    m_free.pop_back();
+    ++m_count;
+
+    return slot;
+}
+
+void SnapshotHistory::AddReference(uint32_t aSlot)
+{
+    ++m_snapshots[aSlot].References;
+}
+
+void SnapshotHistory::RemoveReference(uint32_t aSlot)
+{
+    auto& snapshot = m_snapshots[aSlot];
+    if (--snapshot.References)
+        return;
+
+    m_usedMemory -= snapshot.Size;
+    --m_count;
+    m_free.push_back(aSlot);
+}
+
+bool SnapshotHistory::IsValid(uint32_t aSlot, uint32_t aTick) const
+{
+    return aSlot != InvalidSlot && m_snapshots[aSlot].References != 0 && m_snapshots[aSlot].Tick == aTick;
+}
\ No newline at end of file
@@ -1,181 +1,435 @@
-#include "Socket.h"
-#include <cstring>
-
-Socket::Socket(Endpoint::Type aEndpointType, bool aBlocking)
-    : m_type{aEndpointType}
-{
-    m_port = 0;
-    m_sock = socket(aEndpointType == Endpoint::kIPv6 ? AF_INET6 : AF_INET, SOCK_DGRAM, 0);
-    if (m_sock < 0)
-        return; // error handling
-
-    int on = 1;
-#ifdef _WIN32
-    if (setsockopt(m_sock, SOL_SOCKET, SO_REUSEADDR, (const char*)& on, sizeof(on)) != 0)
-#else
-    if (setsockopt(m_sock, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on)) != 0)
-#endif
-        return;
-
-    if (aBlocking == false)
-    {
-#ifdef _WIN32
-        if (ioctlsocket(m_sock, FIONBIO, (u_long*)& on) != 0)
-#else
-        if (ioctl(m_sock, FIONBIO, (char*)&on) != 0)
-#endif
-            return;
-    }
-}
-
-Socket::~Socket()
-{
-#ifdef _WIN32
-    closesocket(m_sock);
-#else
-    close(m_sock);
-#endif
-}
-
-Outcome<Socket::Packet, Socket::Error> Socket::Receive()
-{
-    Buffer buffer(MaxPacketSize);
-
-    sockaddr_storage from;
-#ifdef _WIN32
-    using socklen_t = int;
-#endif
-    socklen_t len = sizeof(sockaddr_storage);
-
-    auto result = recvfrom(m_sock, (char*)buffer.GetWriteData(), MaxPacketSize, 0, (sockaddr*)&from, &len);
-#ifdef _WIN32
-    if (result == SOCKET_ERROR)
-    {
-        auto error = WSAGetLastError();
-
-        if(error == WSAEWOULDBLOCK || error == WSAECONNRESET)
-            return kDiscardError;
-
-        return kCallFailure;
-    }
-#else
-    if (result <= 0)
-    {
-        if (errno == EAGAIN)
-            return kDiscardError;
-
-        return kCallFailure;
-    }
-#endif
-
-    Packet packet{ Endpoint{}, std::move(buffer) };
-    if (from.ss_family == AF_INET)
-    {
-        auto* pAddr = (sockaddr_in*)&from;
-        new (&packet.Remote) Endpoint(pAddr->sin_addr.s_addr, ntohs(pAddr->sin_port));
-    }
-    else
-    {
-        auto* pAddr = (sockaddr_in6*)&from;
-        new (&packet.Remote) Endpoint((uint16_t*)&pAddr->sin6_addr, ntohs(pAddr->sin6_port));
-    }
-
-    return std::move(packet);
-}
-
-bool Socket::Send(const Socket::Packet& acPacket)
-{
-    if (acPacket.Remote.GetType() != m_type)
-        return false;
-
-    if (m_type == Endpoint::kIPv6)
-    {
-        sockaddr_in6 ipv6;
-        std::memset(&ipv6, 0, sizeof(ipv6));
-        ipv6.sin6_port = htons(acPacket.Remote.GetPort());
-        ipv6.sin6_family = AF_INET6;
-        acPacket.Remote.ToNetIPv6(ipv6.sin6_addr);
-
-        if (sendto(m_sock, (const char*)acPacket.Payload.GetData(), acPacket.Payload.GetSize(), 0, (sockaddr*)& ipv6, sizeof(ipv6)) < 0)
-            return false;
-    }
-    else
-    {
-        sockaddr_in ipv4;
-        std::memset(&ipv4, 0, sizeof(ipv4));
-        ipv4.sin_port = htons(acPacket.Remote.GetPort());
-        ipv4.sin_family = AF_INET;
-        acPacket.Remote.ToNetIPv4((uint32_t&)ipv4.sin_addr.s_addr);
-
-        if (sendto(m_sock, (const char*)acPacket.Payload.GetData(), acPacket.Payload.GetSize(), 0, (sockaddr*)&ipv4, sizeof(sockaddr_in)) < 0)
-            return false; 
-    }
-
-    return true;
-}
-
-bool Socket::Bind(uint16_t aPort)
-{
-    if (m_type == Endpoint::kIPv6)
-        return Bindv6(aPort);
-
-    return Bindv4(aPort);
-}
-
-bool Socket::Bindv6(uint16_t aPort)
-{
-    sockaddr_in6 saddr;
-    std::memset(&saddr, 0, sizeof(saddr));
-    saddr.sin6_family = AF_INET6;
-    saddr.sin6_addr = in6addr_any;
-    saddr.sin6_port = htons(aPort);
-
-    int v6only = 1;
-#ifdef _WIN32
-    if (setsockopt(m_sock, IPPROTO_IPV6, IPV6_V6ONLY, (const char*)& v6only, sizeof(v6only)) != 0)
-#else
-    if (setsockopt(m_sock, IPPROTO_IPV6, IPV6_V6ONLY, &v6only, sizeof(v6only)) != 0)
-#endif
-        return false;
-
-
-    if (bind(m_sock, (sockaddr*)& saddr, sizeof(saddr)) < 0)
-        return false;
-
-#ifdef _WIN32
-    using socklen_t = int;
-#endif
-    socklen_t len = sizeof(saddr);
-    getsockname(m_sock, (sockaddr*)& saddr, &len);
-
-    m_port = ntohs(saddr.sin6_port);
-
-    return true;
-}
-
-bool Socket::Bindv4(uint16_t aPort)
-{
-    sockaddr_in saddr;
-    std::memset(&saddr, 0, sizeof(saddr));
-    saddr.sin_family = AF_INET;
-    saddr.sin_addr.s_addr = htonl(INADDR_ANY);
-    saddr.sin_port = htons(aPort);
-
-    if (bind(m_sock, (sockaddr*)& saddr, sizeof(saddr)) < 0)
-        return false;
-
-#ifdef _WIN32
-    using socklen_t = int;
-#endif
-    socklen_t len = sizeof(saddr);
-    getsockname(m_sock, (sockaddr*)& saddr, &len);
-
-    m_port = ntohs(saddr.sin_port);
-
-    return true;
-}
-
-uint16_t Socket::GetPort() const
-{
-    return m_port;
-}
+#include "Socket.h"
+#include "Log.h"
+#include <cstring>
+
+#ifdef __linux__
+#include <linux/sock_diag.h>
+#endif
+
+Socket::Socket(Endpoint::Type aEndpointType, bool aBlocking)
+    : m_type{aEndpointType}
+    , m_slab{ReceiveBatchSize * MaxPacketSize}
+    , m_sendSlab{SendBatchSize * MaxPacketSize}
+    , m_sendCount{0}
+    , m_droppedCount{0}
+{
+    m_port = 0;
+    m_sock = socket(aEndpointType == Endpoint::kIPv6 ? AF_INET6 : AF_INET, SOCK_DGRAM, 0);
+    if (m_sock < 0)
+        return; // error handling
+
+    int on = 1;
+#ifdef _WIN32
+    if (setsockopt(m_sock, SOL_SOCKET, SO_REUSEADDR, (const char*)& on, sizeof(on)) != 0)
+#else
+    if (setsockopt(m_sock, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on)) != 0)
+#endif
+        return;
+
+    if (aBlocking == false)
+    {
+#ifdef _WIN32
+        if (ioctlsocket(m_sock, FIONBIO, (u_long*)& on) != 0)
+#else
+        if (ioctl(m_sock, FIONBIO, (char*)&on) != 0)
+#endif
+            return;
+    }
+}
+
+Socket::~Socket()
+{
+#ifdef _WIN32
+    closesocket(m_sock);
+#else
+    close(m_sock);
+#endif
+}
+
+Outcome<Socket::Packet, Socket::Error> Socket::Receive()
+{
+    Buffer buffer(MaxPacketSize);
+
+    sockaddr_storage from;
+#ifdef _WIN32
+    using socklen_t = int;
+#endif
+    socklen_t len = sizeof(sockaddr_storage);
+
+    auto result = recvfrom(m_sock, (char*)buffer.GetWriteData(), MaxPacketSize, 0, (sockaddr*)&from, &len);
+#ifdef _WIN32
+    if (result == SOCKET_ERROR)
+    {
+        auto error = WSAGetLastError();
+
+        if(error == WSAEWOULDBLOCK || error == WSAECONNRESET)
+            return kDiscardError;
+
+        return kCallFailure;
+    }
+#else
+    if (result <= 0)
+    {
+        if (errno == EAGAIN)
+            return kDiscardError;
+
+        return kCallFailure;
+    }
+#endif
+
+    Packet packet{ Endpoint{}, std::move(buffer) };
+    if (from.ss_family == AF_INET)
+    {
+        auto* pAddr = (sockaddr_in*)&from;
+        new (&packet.Remote) Endpoint(pAddr->sin_addr.s_addr, ntohs(pAddr->sin_port));
+    }
+    else
+    {
+        auto* pAddr = (sockaddr_in6*)&from;
+        new (&packet.Remote) Endpoint((uint16_t*)&pAddr->sin6_addr, ntohs(pAddr->sin6_port));
+    }
+
+    return std::move(packet);
+}
+
+static void ToEndpoint(const sockaddr_storage& acAddress, Endpoint& aEndpoint)
+{
+    if (acAddress.ss_family == AF_INET)
+    {
+        auto* pAddr = (const sockaddr_in*)&acAddress;
+        aEndpoint = Endpoint(pAddr->sin_addr.s_addr, ntohs(pAddr->sin_port));
+    }
+    else
+    {
+        auto* pAddr = (const sockaddr_in6*)&acAddress;
+        aEndpoint = Endpoint((const uint16_t*)&pAddr->sin6_addr, ntohs(pAddr->sin6_port));
+    }
+}
+
+size_t Socket::ReceiveBatch(size_t aMaxCount)
+{
+    sockaddr_storage from[ReceiveBatchSize];
+    const auto batchSize = aMaxCount < ReceiveBatchSize ? aMaxCount : ReceiveBatchSize;
+
+#ifdef __linux__
+    mmsghdr messages[ReceiveBatchSize];
+    iovec vectors[ReceiveBatchSize];
+
+    std::memset(messages, 0, sizeof(messages));
+
+    for (size_t i = 0; i < batchSize; ++i)
+    {
+        vectors[i].iov_base = m_slab.GetWriteData() + i * MaxPacketSize;
+        vectors[i].iov_len = MaxPacketSize;
+
+        messages[i].msg_hdr.msg_iov = &vectors[i];
+        messages[i].msg_hdr.msg_iovlen = 1;
+        messages[i].msg_hdr.msg_name = &from[i];
+        messages[i].msg_hdr.msg_namelen = sizeof(sockaddr_storage);
+    }
+
+    // A single syscall drains up to a full batch
+    auto result = recvmmsg(m_sock, messages, batchSize, MSG_DONTWAIT, nullptr);
+    if (result <= 0)
+    {
+        if (result < 0 && errno != EAGAIN && errno != EWOULDBLOCK)
+            LOG_ERROR("recvmmsg failed on port %u with errno %d", m_port, errno);
+
+        return 0;
+    }
+
+    const size_t count = result;
+    for (size_t i = 0; i < count; ++i)
+    {
+        m_slabLengths[i] = messages[i].msg_len;
+        ToEndpoint(from[i], m_slabEndpoints[i]);
+    }
+
+    return count;
+#else
+#ifdef _WIN32
+    using socklen_t = int;
+#endif
+
+    size_t count = 0;
+    for (; count < batchSize; ++count)
+    {
+        u_long available = 0;
+        if (ioctlsocket(m_sock, FIONREAD, &available) != 0 || available == 0)
+            break;
+
+        socklen_t len = sizeof(sockaddr_storage);
+        auto result = recvfrom(m_sock, (char*)m_slab.GetWriteData() + count * MaxPacketSize, MaxPacketSize, 0, (sockaddr*)&from[count], &len);
+        if (result == SOCKET_ERROR)
+            break;
+
+        m_slabLengths[count] = result;
+        ToEndpoint(from[count], m_slabEndpoints[count]);
+    }
+
+    return count;
+#endif
+}
+
+static int ToAddress(const Endpoint& acRemote, sockaddr_storage& aAddress)
+{
+    std::memset(&aAddress, 0, sizeof(aAddress));
+
+    if (acRemote.IsIPv6())
+    {
+        auto* pAddr = (sockaddr_in6*)&aAddress;
+        pAddr->sin6_port = htons(acRemote.GetPort());
+        pAddr->sin6_family = AF_INET6;
+        acRemote.ToNetIPv6(pAddr->sin6_addr);
+
+        return sizeof(sockaddr_in6);
+    }
+
+    auto* pAddr = (sockaddr_in*)&aAddress;
+    pAddr->sin_port = htons(acRemote.GetPort());
+    pAddr->sin_family = AF_INET;
+    acRemote.ToNetIPv4((uint32_t&)pAddr->sin_addr.s_addr);
+
+    return sizeof(sockaddr_in);
+}
+
+bool Socket::Send(const Socket::Packet& acPacket)
+{
+    if (acPacket.Remote.GetType() != m_type)
+        return false;
+
+    sockaddr_storage address;
+    const auto length = ToAddress(acPacket.Remote, address);
+
+    return sendto(m_sock, (const char*)acPacket.Payload.GetData(), acPacket.Payload.GetSize(), 0, (sockaddr*)&address, length) >= 0;
+}
+
+uint8_t* Socket::Reserve()
+{
+    if (m_sendCount == SendBatchSize)
+        return nullptr;
+
+    return m_sendSlab.GetWriteData() + m_sendCount * MaxPacketSize;
+}
+
+void Socket::Commit(const Endpoint& acRemote, size_t aLength)
+{
+    if (m_sendCount == SendBatchSize || acRemote.GetType() != m_type || aLength > MaxPacketSize)
+        return;
+
+    m_sendLengths[m_sendCount] = aLength;
+    m_sendEndpoints[m_sendCount] = acRemote;
+    ++m_sendCount;
+}
+
+size_t Socket::Flush()
+{
+    const auto count = m_sendCount;
+
+    sockaddr_storage addresses[SendBatchSize];
+
+    // Datagrams the kernel refuses are skipped, a full send queue keeps the rest for the next Flush
+    size_t sent = 0;
+    size_t delivered = 0;
+
+#ifdef __linux__
+    mmsghdr messages[SendBatchSize];
+    iovec vectors[SendBatchSize];
+
+    std::memset(messages, 0, sizeof(mmsghdr) * count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        vectors[i].iov_base = m_sendSlab.GetWriteData() + i * MaxPacketSize;
+        vectors[i].iov_len = m_sendLengths[i];
+
+        messages[i].msg_hdr.msg_iov = &vectors[i];
+        messages[i].msg_hdr.msg_iovlen = 1;
+        messages[i].msg_hdr.msg_name = &addresses[i];
+        messages[i].msg_hdr.msg_namelen = (socklen_t)ToAddress(m_sendEndpoints[i], addresses[i]);
+    }
+
+    // The kernel may take less than the whole batch and stops at the first datagram it refuses
+    while (sent < count)
+    {
+        auto result = sendmmsg(m_sock, messages + sent, count - sent, 0);
+        if (result > 0)
+        {
+            sent += result;
+            delivered += result;
+            continue;
+        }
+
+        if (errno == EINTR)
+            continue;
+
+        if (errno == EAGAIN || errno == EWOULDBLOCK)
+            break;
+
+        ++m_droppedCount;
+        ++sent;
+    }
+#else
+    for (; sent < count; ++sent)
+    {
+        const auto length = ToAddress(m_sendEndpoints[sent], addresses[sent]);
+        if (sendto(m_sock, (const char*)m_sendSlab.GetData() + sent * MaxPacketSize, (int)m_sendLengths[sent], 0, (sockaddr*)&addresses[sent], length) >= 0)
+        {
+            ++delivered;
+            continue;
+        }
+
+        if (WSAGetLastError() == WSAEWOULDBLOCK)
+            break;
+
+        ++m_droppedCount;
+    }
+#endif
+
+    m_sendCount = count - sent;
+    if (m_sendCount > 0 && sent > 0)
+    {
+        auto* pSlab = m_sendSlab.GetWriteData();
+        std::memmove(pSlab, pSlab + sent * MaxPacketSize, m_sendCount * MaxPacketSize);
+        for (size_t i = 0; i < m_sendCount; ++i)
+        {
+            m_sendLengths[i] = m_sendLengths[sent + i];
+            m_sendEndpoints[i] = m_sendEndpoints[sent + i];
+        }
+    }
+
+    return delivered;
+}
+
+size_t Socket::GetPendingCount() const
+{
+    return m_sendCount;
+}
+
+uint64_t Socket::GetDroppedCount() const
+{
+    return m_droppedCount;
+}
+
+bool Socket::Bind(uint16_t aPort)
+{
+    if (m_type == Endpoint::kIPv6)
+        return Bindv6(aPort);
+
+    return Bindv4(aPort);
+}
+
+bool Socket::Bindv6(uint16_t aPort)
+{
+    sockaddr_in6 saddr;
+    std::memset(&saddr, 0, sizeof(saddr));
+    saddr.sin6_family = AF_INET6;
+    saddr.sin6_addr = in6addr_any;
+    saddr.sin6_port = htons(aPort);
+
+    int v6only = 1;
+#ifdef _WIN32
+    if (setsockopt(m_sock, IPPROTO_IPV6, IPV6_V6ONLY, (const char*)& v6only, sizeof(v6only)) != 0)
+#else
+    if (setsockopt(m_sock, IPPROTO_IPV6, IPV6_V6ONLY, &v6only, sizeof(v6only)) != 0)
+#endif
+        return false;
+
+
+    if (bind(m_sock, (sockaddr*)& saddr, sizeof(saddr)) < 0)
+        return false;
+
+#ifdef _WIN32
+    using socklen_t = int;
+#endif
+    socklen_t len = sizeof(saddr);
+    getsockname(m_sock, (sockaddr*)& saddr, &len);
+
+    m_port = ntohs(saddr.sin6_port);
+
+    return true;
+}
+
+bool Socket::Bindv4(uint16_t aPort)
+{
+    sockaddr_in saddr;
+    std::memset(&saddr, 0, sizeof(saddr));
+    saddr.sin_family = AF_INET;
+    saddr.sin_addr.s_addr = htonl(INADDR_ANY);
+    saddr.sin_port = htons(aPort);
+
+    if (bind(m_sock, (sockaddr*)& saddr, sizeof(saddr)) < 0)
+        return false;
+
+#ifdef _WIN32
+    using socklen_t = int;
+#endif
+    socklen_t len = sizeof(saddr);
+    getsockname(m_sock, (sockaddr*)& saddr, &len);
+
+    m_port = ntohs(saddr.sin_port);
+
+    return true;
+}
+
+void Socket::Adopt(Socket_t aSock)
+{
+#ifdef _WIN32
+    closesocket(m_sock);
+#else
+    close(m_sock);
+#endif
+
+    m_sock = aSock;
+
+    sockaddr_storage saddr;
+#ifdef _WIN32
+    using socklen_t = int;
+#endif
+    socklen_t len = sizeof(saddr);
+    if (getsockname(m_sock, (sockaddr*)& saddr, &len) != 0)
+    {
+        m_port = 0;
+        return;
+    }
+
+    if (saddr.ss_family == AF_INET6)
+        m_port = ntohs(((sockaddr_in6*)&saddr)->sin6_port);
+    else
+        m_port = ntohs(((sockaddr_in*)&saddr)->sin_port);
+}
+
+bool Socket::EnableBusyPoll(uint32_t aMicroseconds)
+{
+#if defined(__linux__) && defined(SO_BUSY_POLL)
+    int value = (int)aMicroseconds;
+    return setsockopt(m_sock, SOL_SOCKET, SO_BUSY_POLL, &value, sizeof(value)) == 0;
+#else
+    (void)aMicroseconds;
+    return false;
+#endif
+}
+
+uint16_t Socket::GetPort() const
+{
+    return m_port;
+}
+
+size_t Socket::GetQueuedBytes() const
+{
+#ifdef __linux__
+    // Includes the kernel's per datagram overhead, good enough to gauge the backlog
+    uint32_t memInfo[SK_MEMINFO_VARS];
+    socklen_t len = sizeof(memInfo);
+    if (getsockopt(m_sock, SOL_SOCKET, SO_MEMINFO, memInfo, &len) == 0)
+        return memInfo[SK_MEMINFO_RMEM_ALLOC];
+
+    return 0;
+#elif _WIN32
+    // Only reports the size of the next datagram
+    u_long available = 0;
+    if (ioctlsocket(m_sock, FIONREAD, &available) == 0)
+        return available;
+
+    return 0;
+#endif
+}
@@ -0,0 +1,317 @@
+#include "StringTable.h"
+#include <algorithm>
+#include <functional>
+
+namespace
+{
+    // Tags in front of every string
+    enum
+    {
+        kLiteral,
+        kDefinition
+    };
+
+    size_t HashText(std::string_view aString)
+    {
+        return std::hash<std::string_view>()(aString);
+    }
+
+    bool WriteText(Buffer::Writer& aWriter, std::string_view aString)
+    {
+        aWriter.WriteBits(aString.size(), 8);
+        for (auto c : aString)
+            aWriter.WriteBits(uint8_t(c), 8);
+
+        return true;
+    }
+
+    bool ReadText(Buffer::Reader& aReader, std::string& aString)
+    {
+        uint64_t length;
+        if (!aReader.ReadBits(length, 8) || aReader.GetRemainingBits() < length * 8)
+            return false;
+
+        aString.resize(length);
+        for (auto& c : aString)
+        {
+            uint64_t value;
+            aReader.ReadBits(value, 8);
+            c = char(value);
+        }
+
+        return true;
+    }
+}
+
+StringTable::StringTable(uint32_t aCapacity)
+    : m_capacity{aCapacity < 2 ? 2 : aCapacity}
+    , m_idBits{1}
+    , m_head{Empty}
+    , m_tail{Empty}
+{
+    while ((uint64_t(1) << m_idBits) < m_capacity)
+        ++m_idBits;
+
+    // At most half full so probe sequences stay short
+    size_t bucketCount = 1;
+    while (bucketCount < m_capacity * 2)
+        bucketCount <<= 1;
+
+    m_local.reserve(m_capacity);
+    m_buckets.resize(bucketCount, Empty);
+}
+
+bool StringTable::Write(Buffer::Writer& aWriter, std::string_view aString, uint64_t aNow)
+{
+    if (aString.size() > MaxLength)
+        return false;
+
+    const auto definitionBits = 2 + m_idBits + 8 + 8 + aString.size() * 8;
+    const auto hash = HashText(aString);
+
+    auto id = Find(aString, hash);
+    if (id != Empty)
+    {
+        auto& entry = m_local[id];
+        const auto bits = entry.Acknowledged ? 1 + m_idBits : definitionBits;
+        if (aWriter.GetRemainingBits() < bits)
+            return false;
+
+        entry.LastUse = aNow;
+        Unlink(id);
+        PushFront(id);
+
+        if (entry.Acknowledged)
+        {
+            aWriter.WriteBits(1, 1);
+            aWriter.WriteBits(id, m_idBits);
+            return true;
+        }
+    }
+    else
+    {
+        if (m_local.size() < m_capacity)
+            id = (uint32_t)m_local.size();
+        else if (aNow - m_local[m_tail].LastUse >= ReuseDelay)
+            id = m_tail;
+
+        // Everything is in use, send it without interning
+        if (id == Empty)
+        {
+            if (aWriter.GetRemainingBits() < 2 + 8 + aString.size() * 8)
+                return false;
+
+            aWriter.WriteBits(0, 1);
+            aWriter.WriteBits(kLiteral, 1);
+            return WriteText(aWriter, aString);
+        }
+
+        if (aWriter.GetRemainingBits() < definitionBits)
+            return false;
+
+        if (id == m_local.size())
+            m_local.emplace_back();
+        else
+        {
+            Erase(id);
+            Unlink(id);
+        }
+
+        auto& entry = m_local[id];
+        entry.Text = aString;
+        entry.Hash = hash;
+        entry.LastUse = aNow;
+        entry.Acknowledged = false;
+        ++entry.Generation;
+
+        Insert(id);
+        PushFront(id);
+    }
+
+    aWriter.WriteBits(0, 1);
+    aWriter.WriteBits(kDefinition, 1);
+    aWriter.WriteBits(id, m_idBits);
+    aWriter.WriteBits(m_local[id].Generation, 8);
+    return WriteText(aWriter, aString);
+}
+
+bool StringTable::Read(Buffer::Reader& aReader, std::string_view& aString)
+{
+    uint64_t reference, type, id, generation;
+    if (!aReader.ReadBits(reference, 1))
+        return false;
+
+    if (reference)
+    {
+        if (!aReader.ReadBits(id, m_idBits) || id >= m_remote.size())
+            return false;
+
+        aString = m_remote[id].Text;
+        return true;
+    }
+
+    if (!aReader.ReadBits(type, 1))
+        return false;
+
+    if (type == kLiteral)
+    {
+        if (!ReadText(aReader, m_literal))
+            return false;
+
+        aString = m_literal;
+        return true;
+    }
+
+    if (!aReader.ReadBits(id, m_idBits) || id >= m_capacity || !aReader.ReadBits(generation, 8))
+        return false;
+
+    if (id >= m_remote.size())
+        m_remote.resize(id + 1);
+
+    auto& entry = m_remote[id];
+    if (!ReadText(aReader, entry.Text))
+        return false;
+
+    entry.Generation = (uint8_t)generation;
+    m_acknowledgements.push_back({ (uint32_t)id, (uint8_t)generation });
+
+    aString = entry.Text;
+    return true;
+}
+
+bool StringTable::WriteAcknowledgements(Buffer::Writer& aWriter)
+{
+    const auto entryBits = m_idBits + 8;
+    if (m_acknowledgements.empty() || aWriter.GetRemainingBits() < 8 + entryBits)
+        return false;
+
+    size_t count = std::min<size_t>({ m_acknowledgements.size(), 255, (aWriter.GetRemainingBits() - 8) / entryBits });
+
+    aWriter.WriteBits(count, 8);
+    for (size_t i = 0; i < count; ++i)
+    {
+        aWriter.WriteBits(m_acknowledgements[i].Id, m_idBits);
+        aWriter.WriteBits(m_acknowledgements[i].Generation, 8);
+    }
+
+    m_acknowledgements.erase(m_acknowledgements.begin(), m_acknowledgements.begin() + count);
+
+    return true;
+}
+
+bool StringTable::ReadAcknowledgements(Buffer::Reader& aReader)
+{
+    uint64_t count;
+    if (!aReader.ReadBits(count, 8))
+        return false;
+
+    for (uint64_t i = 0; i < count; ++i)
+    {
+        uint64_t id, generation;
+        if (!aReader.ReadBits(id, m_idBits) || !aReader.ReadBits(generation, 8))
+            return false;
+
+        // Acknowledgements of a string the slot no longer holds are ignored
+        if (id < m_local.size() && m_local[id].Generation == generation)
+            m_local[id].Acknowledged = true;
+    }
+
+    return true;
+}
+
+bool StringTable::HasAcknowledgements() const
+{
+    return !m_acknowledgements.empty();
+}
+
+uint32_t StringTable::GetCapacity() const
+{
+    return m_capacity;
+}
+
+size_t StringTable::GetIdBits() const
+{
+    return m_idBits;
+}
+
+size_t StringTable::GetSize() const
+{
+    return m_local.size();
+}
+
+uint32_t StringTable::Find(std::string_view aString, size_t aHash) const
+{
+    const auto mask = m_buckets.size() - 1;
+    for (auto bucket = aHash & mask; m_buckets[bucket] != Empty; bucket = (bucket + 1) & mask)
+    {
+        const auto& entry = m_local[m_buckets[bucket]];
+        if (entry.Hash == aHash && entry.Text == aString)
+            return m_buckets[bucket];
+    }
+
+    return Empty;
+}
+
+void StringTable::Insert(uint32_t aId)
+{
+    const auto mask = m_buckets.size() - 1;
+    auto bucket = m_local[aId].Hash & mask;
+    while (m_buckets[bucket] != Empty)
+        bucket = (bucket + 1) & mask;
+
+    m_buckets[bucket] = aId;
+}
+
+void StringTable::Erase(uint32_t aId)
+{
+    const auto mask = m_buckets.size() - 1;
+    auto bucket = m_local[aId].Hash & mask;
+    while (m_buckets[bucket] != aId)
+        bucket = (bucket + 1) & mask;
+
+    // Backward shift deletion, moves the following entries up unless that would put them before their home bucket
+    for (auto next = (bucket + 1) & mask; m_buckets[next] != Empty; next = (next + 1) & mask)
+    {
+        const auto home = m_local[m_buckets[next]].Hash & mask;
+        const bool between = bucket <= next ? (bucket < home && home <= next) : (bucket < home || home <= next);
+        if (!between)
+        {
+            m_buckets[bucket] = m_buckets[next];
+            bucket = next;
+        }
+    }
+
+    m_buckets[bucket] = Empty;
+}
+
+void StringTable::Unlink(uint32_t aId)
+{
+    auto& entry = m_local[aId];
+
+    if (entry.Previous != Empty)
+        m_local[entry.Previous].Next = entry.Next;
+    else if (m_head == aId)
+        m_head = entry.Next;
+
+    if (entry.Next != Empty)
+        m_local[entry.Next].Previous = entry.Previous;
+    else if (m_tail == aId)
+        m_tail = entry.Previous;
+
+    entry.Previous = entry.Next = Empty;
+}
+
+void StringTable::PushFront(uint32_t aId)
+{
+    auto& entry = m_local[aId];
+    entry.Next = m_head;
+    entry.Previous = Empty;
+
+    if (m_head != Empty)
+        m_local[m_head].Previous = aId;
+
+    m_head = aId;
+
+    if (m_tail == Empty)
+        m_tail = aId;
+}
\ No newline at end of file
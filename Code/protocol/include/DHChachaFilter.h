@@ -1,32 +1,43 @@
-#pragma once
-
-#include "Buffer.h"
-#include "Allocator.h"
-#include <array>
-
-
-struct DHChachaFilterPimpl;
-class DHChachaFilter : public AllocatorCompatible
-{
-public:
-
-    DHChachaFilter();
-    ~DHChachaFilter();
-
-    bool PreConnect(Buffer::Writer* apBuffer);
-    bool ReceiveConnect(Buffer::Reader* apBuffer);
-    
-    // Called before the packet gets sent
-    bool PreSend(Buffer::Writer* apBuffer, uint32_t aSequenceNumber);
-    // Called after the payload is generated
-    bool PostSend(uint8_t* apPayload, size_t aLength, uint32_t aSequenceNumber);
-    // Called with the raw payload
-    bool PreReceive(uint8_t* apPayload, size_t aLength, uint32_t aSequenceNumber);
-
-private:
-
-    void GenerateKeys();
-
-    DHChachaFilterPimpl* m_pPimpl;
-    std::array<uint8_t, 20> m_iv;
+#pragma once
+
+#include "Buffer.h"
+#include "Allocator.h"
+#include <array>
+
+
+struct DHChachaFilterPimpl;
+class DHChachaFilter : public AllocatorCompatible
+{
+public:
+
+    DHChachaFilter(bool aGenerateKeys = true);
+    DHChachaFilter(const DHChachaFilter& acRhs) = delete;
+    DHChachaFilter(DHChachaFilter&& aRhs) noexcept;
+    ~DHChachaFilter();
+
+    DHChachaFilter& operator=(const DHChachaFilter& acRhs) = delete;
+    DHChachaFilter& operator=(DHChachaFilter&& aRhs) noexcept;
+
+    bool PreConnect(Buffer::Writer* apBuffer);
+    bool ReceiveConnect(Buffer::Reader* apBuffer);
+    
+    // Called before the packet gets sent
+    bool PreSend(Buffer::Writer* apBuffer, uint32_t aSequenceNumber);
+    // Called after the payload is generated
+    bool PostSend(uint8_t* apPayload, size_t aLength, uint32_t aSequenceNumber);
+    // Encrypts while copying, used when a shared payload is sent to many peers
+    bool PostSend(const uint8_t* apPayload, uint8_t* apOutput, size_t aLength, uint32_t aSequenceNumber);
+    // Called with the raw payload
+    bool PreReceive(uint8_t* apPayload, size_t aLength, uint32_t aSequenceNumber);
+
+    // Key material, used to carry an established session over to another process
+    bool Save(Buffer::Writer* apBuffer) const;
+    bool Load(Buffer::Reader* apBuffer);
+
+private:
+
+    void GenerateKeys();
+
+    DHChachaFilterPimpl* m_pPimpl;
+    std::array<uint8_t, 20> m_iv;
 };
\ No newline at end of file
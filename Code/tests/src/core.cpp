@@ -1,444 +1,1147 @@
-#include "catch.hpp"
-
-#include "Buffer.h"
-#include "Outcome.h"
-#include "StandardAllocator.h"
-#include "BoundedAllocator.h"
-#include "ScratchAllocator.h"
-#include "StackAllocator.h"
-#include "TrackAllocator.h"
-
-#include <string>
-#include <thread>
-#include <future>
-#include <cstring>
-
-TEST_CASE("Outcome saves the result and errors", "[core.outcome]")
-{
-    SECTION("Clean")
-    {
-        Outcome<int, std::string> outcome;
-        REQUIRE(outcome.HasError());
-    }
-
-    SECTION("Result")
-    {
-        Outcome<int, std::string> outcome(42);
-        REQUIRE_FALSE(outcome.HasError());
-        REQUIRE(outcome.GetResult() == 42);
-        REQUIRE(outcome.GetError() == std::string{});
-
-        Outcome<int, std::string> outcomeCopy{ outcome };
-        REQUIRE_FALSE(outcomeCopy.HasError());
-        REQUIRE(outcomeCopy.GetResult() == 42);
-        REQUIRE(outcomeCopy.GetError() == std::string{});
-
-        Outcome<int, std::string> outcomeMove{ std::move(outcome) };
-        REQUIRE_FALSE(outcomeMove.HasError());
-        REQUIRE(outcomeMove.GetResult() == 42);
-        REQUIRE(outcomeMove.GetError() == std::string{});
-    }
-
-    SECTION("Error")
-    {
-        Outcome<int, std::string> outcome("hello");
-        REQUIRE(outcome.HasError());
-        REQUIRE(outcome.GetError() == std::string{ "hello" });
-
-        Outcome<int, std::string> outcomeCopy{ outcome };
-        REQUIRE(outcomeCopy.HasError());
-        REQUIRE(outcomeCopy.GetError() == std::string{ "hello" });
-
-        Outcome<int, std::string> outcomeMove{ std::move(outcome) };
-        REQUIRE(outcomeMove.HasError());
-        REQUIRE(outcomeMove.GetError() == std::string{ "hello" });
-    }
-}
-
-TEST_CASE("Allocators allocate memory", "[core.allocators]")
-{
-    GIVEN("A StandardAllocator")
-    {
-        StandardAllocator allocator;
-
-        auto pData = allocator.Allocate(100);
-        REQUIRE(pData != nullptr);
-        REQUIRE(allocator.Size(pData) >= 100);
-        allocator.Free(pData);
-
-        WHEN("Using new/delete")
-        {
-            auto pInteger = allocator.New<uint32_t>();
-            REQUIRE(pInteger != nullptr);
-            allocator.Delete(pInteger);
-
-            struct Dummy
-            {
-                Dummy(int& aValue) : m_value(aValue) { m_value++; }
-                ~Dummy() { m_value++; }
-                int& m_value;
-            };
-
-            int value = 0;
-            auto pDummy = allocator.New<Dummy>(std::ref(value));
-            REQUIRE(pDummy != nullptr);
-            REQUIRE(value == 1);
-            allocator.Delete(pDummy);
-            REQUIRE(value == 2);
-        }
-    }
-
-    GIVEN("A BoundedAllocator")
-    {
-        BoundedAllocator allocator(1000);
-        WHEN("Capacity is sufficient")
-        {
-            auto pData = allocator.Allocate(1000);
-            REQUIRE(pData != nullptr);
-            REQUIRE(allocator.Size(pData) >= 1000);
-            allocator.Free(pData);
-
-            pData = allocator.Allocate(1000);
-            REQUIRE(pData != nullptr);
-            REQUIRE(allocator.Size(pData) >= 1000);
-            allocator.Free(pData);
-
-            pData = allocator.Allocate(900);
-            REQUIRE(pData != nullptr);
-            REQUIRE(allocator.Size(pData) >= 900);
-
-            auto pDataBis = allocator.Allocate(100);
-            REQUIRE(pDataBis != nullptr);
-            REQUIRE(allocator.Size(pDataBis) >= 100);
-
-            allocator.Free(pData);
-            allocator.Free(pDataBis);
-        }
-        WHEN("Capacity is insufficient")
-        {
-            auto pData = allocator.Allocate(1001);
-            REQUIRE(pData == nullptr);
-
-            pData = allocator.Allocate(900);
-            REQUIRE(pData != nullptr);
-            REQUIRE(allocator.Size(pData) >= 900);
-
-            auto pDataBis = allocator.Allocate(101);
-            REQUIRE(pDataBis == nullptr);
-
-            allocator.Free(pData);
-        }
-    }
-}
-
-TEST_CASE("Making sure allocator stacks work corrently", "[core.allocator.stack]")
-{
-    GIVEN("No allocator has been pushed")
-    {
-        REQUIRE(Allocator::Get() != nullptr);
-        auto pAllocation = Allocator::Get()->Allocate(100);
-        REQUIRE(pAllocation != nullptr);
-        Allocator::Get()->Free(pAllocation);
-
-        WHEN("Pushing an allocator")
-        {
-            BoundedAllocator allocator(1000);
-
-            Allocator::Push(&allocator);
-
-            REQUIRE(Allocator::Get() == &allocator);
-            auto futureResult = std::async(std::launch::async, []() { return Allocator::Get(); });
-            REQUIRE(futureResult.get() != &allocator);
-            REQUIRE(Allocator::Pop() == &allocator);
-            REQUIRE(Allocator::Get() != &allocator);
-        }
-
-        TrackAllocator<StandardAllocator> tracker;
-        ScopedAllocator _(&tracker);
-
-        WHEN("Using allocators indirectly")
-        {
-            GIVEN("A pod type")
-            {
-                auto pValue = New<int>(42);
-                // PODs use the default pool
-                REQUIRE(tracker.GetUsedMemory() == 0);
-                REQUIRE(pValue != nullptr);
-                REQUIRE(*pValue == 42);
-                Delete(pValue);
-            }
-
-            REQUIRE(tracker.GetUsedMemory() == 0);
-
-            GIVEN("An AllocatorCompatible type")
-            {
-                struct Dummy : AllocatorCompatible
-                {
-                    Dummy()
-                    {
-                        REQUIRE(GetAllocator() != nullptr);
-                        auto pData = GetAllocator()->Allocate(100);
-                        REQUIRE(pData != nullptr);
-                        GetAllocator()->Free(pData);
-                    }
-
-                    ~Dummy() {}
-                };
-
-                auto pDummy = New<Dummy>();
-
-                REQUIRE(tracker.GetUsedMemory() != 0);
-
-                Delete(pDummy);
-            }
-
-            REQUIRE(tracker.GetUsedMemory() == 0);
-        }
-    }
-}
-
-TEST_CASE("Using a scratch allocator", "[core.allocator.scratch]")
-{
-    ScratchAllocator allocator(1000);
-
-    REQUIRE(allocator.Size(nullptr) == 1000);
-
-    void* pResult = allocator.Allocate(10);
-    REQUIRE(pResult != nullptr);
-    pResult = allocator.Allocate(1000);
-    REQUIRE(pResult == nullptr);
-}
-
-TEST_CASE("Allocating memory on the stack", "[core.allocator.stack]")
-{
-    StackAllocator<1000> allocator;
-    REQUIRE(allocator.Size(nullptr) == 1000);
-
-    for (auto i{ 0 }; i < 10; ++i)
-    {
-        auto pResult = allocator.Allocate(3);
-        REQUIRE(pResult != nullptr);
-        REQUIRE((uintptr_t(pResult) & (alignof(std::max_align_t) - 1)) == 0);
-        REQUIRE(allocator.Allocate(1000) == nullptr);
-    }
-
-}
-
-TEST_CASE("Buffers", "[core.buffer]")
-{
-    TrackAllocator<StandardAllocator> tracker;
-    ScopedAllocator _{ &tracker };
-
-    GIVEN("Two buffers")
-    {
-        Buffer buffer1(100);
-        Buffer buffer2(200);
-
-        REQUIRE(buffer1.GetSize() == 100);
-        REQUIRE(buffer2.GetSize() == 200);
-
-        buffer1[0] = 42;
-        buffer1[99] = 84;
-        buffer2[0] = 1;
-        buffer2[199] = 2;
-
-        REQUIRE(buffer1[0] == 42);
-        REQUIRE(buffer1[99] == 84);
-        REQUIRE(buffer2[0] == 1);
-        REQUIRE(buffer2[199] == 2);
-
-        WHEN("Copying one")
-        {
-            Buffer buffer3(buffer1);
-            Buffer buffer4;
-
-            REQUIRE(buffer4.GetSize() == 0);
-            REQUIRE(buffer4.GetData() == nullptr);
-
-            REQUIRE(buffer3.GetSize() == 100);
-            REQUIRE(buffer3[0] == 42);
-            REQUIRE(buffer3[99] == 84);
-
-            buffer4 = buffer3;
-
-            REQUIRE(buffer4.GetSize() == 100);
-            REQUIRE(buffer4[0] == 42);
-            REQUIRE(buffer4[99] == 84);
-        }
-        WHEN("Moving one")
-        {
-            Buffer buffer3(std::move(buffer1));
-            Buffer buffer4;
-
-            REQUIRE(buffer1.GetSize() == 0);
-            REQUIRE(buffer1.GetData() == nullptr);
-
-            REQUIRE(buffer3.GetSize() == 100);
-            REQUIRE(buffer3[0] == 42);
-            REQUIRE(buffer3[99] == 84);
-
-            buffer4 = std::move(buffer3);
-
-            REQUIRE(buffer3.GetSize() == 0);
-            REQUIRE(buffer3.GetData() == nullptr);
-
-            REQUIRE(buffer4.GetSize() == 100);
-            REQUIRE(buffer4[0] == 42);
-            REQUIRE(buffer4[99] == 84);
-        }
-    }
-
-    GIVEN("Views")
-    {
-        WHEN("Using a cursor")
-        {
-            Buffer buffer(100);
-            Buffer::Cursor cursor(&buffer);
-
-            REQUIRE(cursor.GetBitPosition() == 0);
-            REQUIRE(cursor.GetBytePosition() == 0);
-            REQUIRE(cursor.Eof() == false);
-
-            cursor.Advance(10);
-
-            REQUIRE(cursor.GetBitPosition() == 80);
-            REQUIRE(cursor.GetBytePosition() == 10);
-            REQUIRE(cursor.Eof() == false);
-
-            cursor.Reverse(5);
-
-            REQUIRE(cursor.GetBitPosition() == 40);
-            REQUIRE(cursor.GetBytePosition() == 5);
-
-            cursor.Reset();
-
-            REQUIRE(cursor.GetBitPosition() == 0);
-            REQUIRE(cursor.GetBytePosition() == 0);
-
-            cursor.Advance(100);
-
-            REQUIRE(cursor.Eof() == true);
-        }
-        
-        WHEN("Using a writer")
-        {
-            Buffer buffer(100);
-
-            Buffer::Writer writer(&buffer);
-
-            REQUIRE(writer.GetBitPosition() == 0);
-            REQUIRE(writer.GetBytePosition() == 0);
-            REQUIRE(writer.Eof() == false);
-
-            const char* testData = "atest";
-            writer.WriteBytes((uint8_t*)testData, 1);
-
-            REQUIRE(writer.GetBitPosition() == 8);
-            REQUIRE(writer.GetBytePosition() == 1);
-            REQUIRE(writer.Eof() == false);
-
-            
-            writer.WriteBytes((uint8_t*)testData + 1, 4);
-            REQUIRE(writer.GetBitPosition() == 40);
-            REQUIRE(writer.GetBytePosition() == 5);
-            REQUIRE(writer.Eof() == false);
-
-            REQUIRE(memcmp(testData, buffer.GetData(), 5) == 0);
-
-            WHEN("Using a reader")
-            {
-                Buffer::Reader reader(&buffer);
-
-                REQUIRE(reader.GetBitPosition() == 0);
-                REQUIRE(reader.GetBytePosition() == 0);
-                REQUIRE(reader.Eof() == false);
-
-                char rawBuffer[5];
-                reader.ReadBytes((uint8_t*)rawBuffer, 1);
-                REQUIRE(reader.GetBitPosition() == 8);
-                REQUIRE(reader.GetBytePosition() == 1);
-                REQUIRE(reader.Eof() == false);
-
-                reader.ReadBytes((uint8_t*)rawBuffer + 1, 4);
-                REQUIRE(reader.GetBitPosition() == 40);
-                REQUIRE(reader.GetBytePosition() == 5);
-                REQUIRE(reader.Eof() == false);
-
-                REQUIRE(memcmp(testData, rawBuffer, 5) == 0);
-            }
-        }
-        WHEN("Using bits accessors")
-        {
-            Buffer buffer(100);
-            Buffer::Writer writer(&buffer);
-
-            const uint8_t test = 0xE4;
-            const uint64_t test64 = 0x123456789ABCDEFULL;
-
-            writer.WriteBytes(&test, 1);
-            writer.WriteBytes((uint8_t*)&test64, 8);
-
-            {
-                uint64_t dest = 0;
-
-                Buffer::Reader reader(&buffer);
-                reader.ReadBits(dest, 8);
-
-                REQUIRE(dest == test);
-            }
-
-            
-            {
-                uint64_t dest = 0;
-
-                Buffer::Reader reader(&buffer);
-                reader.ReadBits(dest, 4);
-
-                REQUIRE(dest == 0x4);
-
-                reader.ReadBits(dest, 4);
-
-                REQUIRE(dest == 0xE);
-
-                reader.ReadBits(dest, 4);
-
-                REQUIRE(dest == 0xF);
-
-                reader.ReadBits(dest, 12);
-
-                REQUIRE(dest == 0xCDE);
-            }
-            
-            writer.Reset();
-            for (auto i = 0; i < 8; ++i)
-            {
-                writer.WriteBits(1, 1);
-                writer.WriteBits(0, 1);
-            }
-            writer.WriteBits(1, 3);
-            writer.WriteBits(0x28FE, 16);
-            
-            {
-                uint64_t dest = 0;
-                Buffer::Reader reader(&buffer);
-
-                for (auto i = 0; i < 8; ++i)
-                {
-                    reader.ReadBits(dest, 1);
-                    REQUIRE(dest == 1);
-
-                    reader.ReadBits(dest, 1);
-                    REQUIRE(dest == 0);
-                }
-
-                reader.ReadBits(dest, 3);
-                REQUIRE(dest == 1);
-
-                reader.ReadBits(dest, 16);
-                REQUIRE(dest == 0x28FE);
-            }
-        }
-    }
-
-    REQUIRE(tracker.GetUsedMemory() == 0);
+#include "catch.hpp"
+
+#include "Buffer.h"
+#include "Outcome.h"
+#include "StandardAllocator.h"
+#include "BoundedAllocator.h"
+#include "ScratchAllocator.h"
+#include "StackAllocator.h"
+#include "TrackAllocator.h"
+#include "RingBuffer.h"
+#include "Log.h"
+#include "Clock.h"
+#include "TickScheduler.h"
+#include "GaloisField.h"
+#include "Memory.h"
+#include "Histogram.h"
+#include "PoolAllocator.h"
+#include "StlAllocator.h"
+#include "TraceAllocator.h"
+#include "Profiler.h"
+
+#include <string>
+#include <thread>
+#include <future>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+#include <sstream>
+#include <set>
+
+TEST_CASE("Outcome saves the result and errors", "[core.outcome]")
+{
+    SECTION("Clean")
+    {
+        Outcome<int, std::string> outcome;
+        REQUIRE(outcome.HasError());
+    }
+
+    SECTION("Result")
+    {
+        Outcome<int, std::string> outcome(42);
+        REQUIRE_FALSE(outcome.HasError());
+        REQUIRE(outcome.GetResult() == 42);
+        REQUIRE(outcome.GetError() == std::string{});
+
+        Outcome<int, std::string> outcomeCopy{ outcome };
+        REQUIRE_FALSE(outcomeCopy.HasError());
+        REQUIRE(outcomeCopy.GetResult() == 42);
+        REQUIRE(outcomeCopy.GetError() == std::string{});
+
+        Outcome<int, std::string> outcomeMove{ std::move(outcome) };
+        REQUIRE_FALSE(outcomeMove.HasError());
+        REQUIRE(outcomeMove.GetResult() == 42);
+        REQUIRE(outcomeMove.GetError() == std::string{});
+    }
+
+    SECTION("Error")
+    {
+        Outcome<int, std::string> outcome("hello");
+        REQUIRE(outcome.HasError());
+        REQUIRE(outcome.GetError() == std::string{ "hello" });
+
+        Outcome<int, std::string> outcomeCopy{ outcome };
+        REQUIRE(outcomeCopy.HasError());
+        REQUIRE(outcomeCopy.GetError() == std::string{ "hello" });
+
+        Outcome<int, std::string> outcomeMove{ std::move(outcome) };
+        REQUIRE(outcomeMove.HasError());
+        REQUIRE(outcomeMove.GetError() == std::string{ "hello" });
+    }
+}
+
+TEST_CASE("Allocators allocate memory", "[core.allocators]")
+{
+    GIVEN("A StandardAllocator")
+    {
+        StandardAllocator allocator;
+
+        auto pData = allocator.Allocate(100);
+        REQUIRE(pData != nullptr);
+        REQUIRE(allocator.Size(pData) >= 100);
+        allocator.Free(pData);
+
+        WHEN("Using new/delete")
+        {
+            auto pInteger = allocator.New<uint32_t>();
+            REQUIRE(pInteger != nullptr);
+            allocator.Delete(pInteger);
+
+            struct Dummy
+            {
+                Dummy(int& aValue) : m_value(aValue) { m_value++; }
+                ~Dummy() { m_value++; }
+                int& m_value;
+            };
+
+            int value = 0;
+            auto pDummy = allocator.New<Dummy>(std::ref(value));
+            REQUIRE(pDummy != nullptr);
+            REQUIRE(value == 1);
+            allocator.Delete(pDummy);
+            REQUIRE(value == 2);
+        }
+    }
+
+    GIVEN("A BoundedAllocator")
+    {
+        BoundedAllocator allocator(1000);
+        WHEN("Capacity is sufficient")
+        {
+            auto pData = allocator.Allocate(1000);
+            REQUIRE(pData != nullptr);
+            REQUIRE(allocator.Size(pData) >= 1000);
+            allocator.Free(pData);
+
+            pData = allocator.Allocate(1000);
+            REQUIRE(pData != nullptr);
+            REQUIRE(allocator.Size(pData) >= 1000);
+            allocator.Free(pData);
+
+            pData = allocator.Allocate(900);
+            REQUIRE(pData != nullptr);
+            REQUIRE(allocator.Size(pData) >= 900);
+
+            auto pDataBis = allocator.Allocate(100);
+            REQUIRE(pDataBis != nullptr);
+            REQUIRE(allocator.Size(pDataBis) >= 100);
+
+            allocator.Free(pData);
+            allocator.Free(pDataBis);
+        }
+        WHEN("Capacity is insufficient")
+        {
+            auto pData = allocator.Allocate(1001);
+            REQUIRE(pData == nullptr);
+
+            pData = allocator.Allocate(900);
+            REQUIRE(pData != nullptr);
+            REQUIRE(allocator.Size(pData) >= 900);
+
+            auto pDataBis = allocator.Allocate(101);
+            REQUIRE(pDataBis == nullptr);
+
+            allocator.Free(pData);
+        }
+    }
+}
+
+TEST_CASE("Making sure allocator stacks work corrently", "[core.allocator.stack]")
+{
+    GIVEN("No allocator has been pushed")
+    {
+        REQUIRE(Allocator::Get() != nullptr);
+        auto pAllocation = Allocator::Get()->Allocate(100);
+        REQUIRE(pAllocation != nullptr);
+        Allocator::Get()->Free(pAllocation);
+
+        WHEN("Pushing an allocator")
+        {
+            BoundedAllocator allocator(1000);
+
+            Allocator::Push(&allocator);
+
+            REQUIRE(Allocator::Get() == &allocator);
+            auto futureResult = std::async(std::launch::async, []() { return Allocator::Get(); });
+            REQUIRE(futureResult.get() != &allocator);
+            REQUIRE(Allocator::Pop() == &allocator);
+            REQUIRE(Allocator::Get() != &allocator);
+        }
+
+        TrackAllocator<StandardAllocator> tracker;
+        ScopedAllocator _(&tracker);
+
+        WHEN("Using allocators indirectly")
+        {
+            GIVEN("A pod type")
+            {
+                auto pValue = New<int>(42);
+                // PODs use the default pool
+                REQUIRE(tracker.GetUsedMemory() == 0);
+                REQUIRE(pValue != nullptr);
+                REQUIRE(*pValue == 42);
+                Delete(pValue);
+            }
+
+            REQUIRE(tracker.GetUsedMemory() == 0);
+
+            GIVEN("An AllocatorCompatible type")
+            {
+                struct Dummy : AllocatorCompatible
+                {
+                    Dummy()
+                    {
+                        REQUIRE(GetAllocator() != nullptr);
+                        auto pData = GetAllocator()->Allocate(100);
+                        REQUIRE(pData != nullptr);
+                        GetAllocator()->Free(pData);
+                    }
+
+                    ~Dummy() {}
+                };
+
+                auto pDummy = New<Dummy>();
+
+                REQUIRE(tracker.GetUsedMemory() != 0);
+
+                Delete(pDummy);
+            }
+
+            REQUIRE(tracker.GetUsedMemory() == 0);
+        }
+    }
+}
+
+TEST_CASE("Using a scratch allocator", "[core.allocator.scratch]")
+{
+    ScratchAllocator allocator(1000);
+
+    REQUIRE(allocator.Size(nullptr) == 1000);
+
+    void* pResult = allocator.Allocate(10);
+    REQUIRE(pResult != nullptr);
+    pResult = allocator.Allocate(1000);
+    REQUIRE(pResult == nullptr);
+}
+
+TEST_CASE("Allocating memory on the stack", "[core.allocator.stack]")
+{
+    StackAllocator<1000> allocator;
+    REQUIRE(allocator.Size(nullptr) == 1000);
+
+    for (auto i{ 0 }; i < 10; ++i)
+    {
+        auto pResult = allocator.Allocate(3);
+        REQUIRE(pResult != nullptr);
+        REQUIRE((uintptr_t(pResult) & (alignof(std::max_align_t) - 1)) == 0);
+        REQUIRE(allocator.Allocate(1000) == nullptr);
+    }
+
+}
+
+TEST_CASE("Buffers", "[core.buffer]")
+{
+    TrackAllocator<StandardAllocator> tracker;
+    ScopedAllocator _{ &tracker };
+
+    GIVEN("Two buffers")
+    {
+        Buffer buffer1(100);
+        Buffer buffer2(200);
+
+        REQUIRE(buffer1.GetSize() == 100);
+        REQUIRE(buffer2.GetSize() == 200);
+
+        buffer1[0] = 42;
+        buffer1[99] = 84;
+        buffer2[0] = 1;
+        buffer2[199] = 2;
+
+        REQUIRE(buffer1[0] == 42);
+        REQUIRE(buffer1[99] == 84);
+        REQUIRE(buffer2[0] == 1);
+        REQUIRE(buffer2[199] == 2);
+
+        WHEN("Copying one")
+        {
+            Buffer buffer3(buffer1);
+            Buffer buffer4;
+
+            REQUIRE(buffer4.GetSize() == 0);
+            REQUIRE(buffer4.GetData() == nullptr);
+
+            REQUIRE(buffer3.GetSize() == 100);
+            REQUIRE(buffer3[0] == 42);
+            REQUIRE(buffer3[99] == 84);
+
+            buffer4 = buffer3;
+
+            REQUIRE(buffer4.GetSize() == 100);
+            REQUIRE(buffer4[0] == 42);
+            REQUIRE(buffer4[99] == 84);
+        }
+        WHEN("Moving one")
+        {
+            Buffer buffer3(std::move(buffer1));
+            Buffer buffer4;
+
+            REQUIRE(buffer1.GetSize() == 0);
+            REQUIRE(buffer1.GetData() == nullptr);
+
+            REQUIRE(buffer3.GetSize() == 100);
+            REQUIRE(buffer3[0] == 42);
+            REQUIRE(buffer3[99] == 84);
+
+            buffer4 = std::move(buffer3);
+
+            REQUIRE(buffer3.GetSize() == 0);
+            REQUIRE(buffer3.GetData() == nullptr);
+
+            REQUIRE(buffer4.GetSize() == 100);
+            REQUIRE(buffer4[0] == 42);
+            REQUIRE(buffer4[99] == 84);
+        }
+    }
+
+    GIVEN("Views")
+    {
+        WHEN("Using a cursor")
+        {
+            Buffer buffer(100);
+            Buffer::Cursor cursor(&buffer);
+
+            REQUIRE(cursor.GetBitPosition() == 0);
+            REQUIRE(cursor.GetBytePosition() == 0);
+            REQUIRE(cursor.Eof() == false);
+
+            cursor.Advance(10);
+
+            REQUIRE(cursor.GetBitPosition() == 80);
+            REQUIRE(cursor.GetBytePosition() == 10);
+            REQUIRE(cursor.Eof() == false);
+
+            cursor.Reverse(5);
+
+            REQUIRE(cursor.GetBitPosition() == 40);
+            REQUIRE(cursor.GetBytePosition() == 5);
+
+            cursor.Reset();
+
+            REQUIRE(cursor.GetBitPosition() == 0);
+            REQUIRE(cursor.GetBytePosition() == 0);
+
+            cursor.Advance(100);
+
+            REQUIRE(cursor.Eof() == true);
+        }
+        
+        WHEN("Using a writer")
+        {
+            Buffer buffer(100);
+
+            Buffer::Writer writer(&buffer);
+
+            REQUIRE(writer.GetBitPosition() == 0);
+            REQUIRE(writer.GetBytePosition() == 0);
+            REQUIRE(writer.Eof() == false);
+
+            const char* testData = "atest";
+            writer.WriteBytes((uint8_t*)testData, 1);
+
+            REQUIRE(writer.GetBitPosition() == 8);
+            REQUIRE(writer.GetBytePosition() == 1);
+            REQUIRE(writer.Eof() == false);
+
+            
+            writer.WriteBytes((uint8_t*)testData + 1, 4);
+            REQUIRE(writer.GetBitPosition() == 40);
+            REQUIRE(writer.GetBytePosition() == 5);
+            REQUIRE(writer.Eof() == false);
+
+            REQUIRE(memcmp(testData, buffer.GetData(), 5) == 0);
+
+            WHEN("Using a reader")
+            {
+                Buffer::Reader reader(&buffer);
+
+                REQUIRE(reader.GetBitPosition() == 0);
+                REQUIRE(reader.GetBytePosition() == 0);
+                REQUIRE(reader.Eof() == false);
+
+                char rawBuffer[5];
+                reader.ReadBytes((uint8_t*)rawBuffer, 1);
+                REQUIRE(reader.GetBitPosition() == 8);
+                REQUIRE(reader.GetBytePosition() == 1);
+                REQUIRE(reader.Eof() == false);
+
+                reader.ReadBytes((uint8_t*)rawBuffer + 1, 4);
+                REQUIRE(reader.GetBitPosition() == 40);
+                REQUIRE(reader.GetBytePosition() == 5);
+                REQUIRE(reader.Eof() == false);
+
+                REQUIRE(memcmp(testData, rawBuffer, 5) == 0);
+            }
+
+            WHEN("Using a reader on raw memory")
+            {
+                Buffer::Reader reader(buffer.GetData(), 5);
+
+                char rawBuffer[5];
+                REQUIRE(reader.ReadBytes((uint8_t*)rawBuffer, 5));
+                REQUIRE(reader.Eof());
+                REQUIRE(memcmp(testData, rawBuffer, 5) == 0);
+                REQUIRE(reader.ReadBytes((uint8_t*)rawBuffer, 1) == false);
+            }
+        }
+        WHEN("Using bits accessors")
+        {
+            Buffer buffer(100);
+            Buffer::Writer writer(&buffer);
+
+            const uint8_t test = 0xE4;
+            const uint64_t test64 = 0x123456789ABCDEFULL;
+
+            writer.WriteBytes(&test, 1);
+            writer.WriteBytes((uint8_t*)&test64, 8);
+
+            {
+                uint64_t dest = 0;
+
+                Buffer::Reader reader(&buffer);
+                reader.ReadBits(dest, 8);
+
+                REQUIRE(dest == test);
+            }
+
+            
+            {
+                uint64_t dest = 0;
+
+                Buffer::Reader reader(&buffer);
+                reader.ReadBits(dest, 4);
+
+                REQUIRE(dest == 0x4);
+
+                reader.ReadBits(dest, 4);
+
+                REQUIRE(dest == 0xE);
+
+                reader.ReadBits(dest, 4);
+
+                REQUIRE(dest == 0xF);
+
+                reader.ReadBits(dest, 12);
+
+                REQUIRE(dest == 0xCDE);
+            }
+            
+            writer.Reset();
+            for (auto i = 0; i < 8; ++i)
+            {
+                writer.WriteBits(1, 1);
+                writer.WriteBits(0, 1);
+            }
+            writer.WriteBits(1, 3);
+            writer.WriteBits(0x28FE, 16);
+            
+            {
+                uint64_t dest = 0;
+                Buffer::Reader reader(&buffer);
+
+                for (auto i = 0; i < 8; ++i)
+                {
+                    reader.ReadBits(dest, 1);
+                    REQUIRE(dest == 1);
+
+                    reader.ReadBits(dest, 1);
+                    REQUIRE(dest == 0);
+                }
+
+                reader.ReadBits(dest, 3);
+                REQUIRE(dest == 1);
+
+                reader.ReadBits(dest, 16);
+                REQUIRE(dest == 0x28FE);
+            }
+        }
+        WHEN("Writing 64 bits at an unaligned position")
+        {
+            Buffer buffer(20);
+            {
+                Buffer::Writer writer(&buffer);
+                writer.WriteBits(5, 3);
+                writer.WriteBits(0xFEDCBA9876543210ull, 64);
+                writer.WriteBits(0x1FFFFFFFFFFFFFull, 61);
+                REQUIRE(writer.WriteBits(0, 64) == false);
+            }
+            {
+                uint64_t dest = 0;
+                Buffer::Reader reader(&buffer);
+
+                REQUIRE(reader.ReadBits(dest, 3));
+                REQUIRE(dest == 5);
+                REQUIRE(reader.ReadBits(dest, 64));
+                REQUIRE(dest == 0xFEDCBA9876543210ull);
+                REQUIRE(reader.ReadBits(dest, 61));
+                REQUIRE(dest == 0x1FFFFFFFFFFFFFull);
+                REQUIRE(reader.ReadBits(dest, 64) == false);
+            }
+        }
+    }
+
+    REQUIRE(tracker.GetUsedMemory() == 0);
+}
+
+TEST_CASE("Ring buffers", "[core.ringbuffer]")
+{
+    std::vector<uint8_t> memory(RingBuffer::GetRequiredSize(256));
+    RingBuffer ring(memory.data(), 256, true);
+
+    REQUIRE(ring.IsValid());
+    REQUIRE(ring.IsEmpty());
+    REQUIRE(ring.Pop([](const uint8_t*, size_t) {}) == false);
+
+    GIVEN("Messages wrapping around the end of the ring")
+    {
+        for (uint8_t i = 0; i < 100; ++i)
+        {
+            uint8_t message[37];
+            std::fill(std::begin(message), std::end(message), i);
+
+            REQUIRE(ring.Push(message, i % 37));
+
+            bool valid = false;
+            REQUIRE(ring.Pop([&valid, i](const uint8_t* apData, size_t aLength)
+            {
+                valid = aLength == size_t(i % 37) && std::all_of(apData, apData + aLength, [i](uint8_t c) { return c == i; });
+            }));
+
+            REQUIRE(valid);
+            REQUIRE(ring.IsEmpty());
+        }
+    }
+
+    GIVEN("A full ring")
+    {
+        uint8_t message[60] = {};
+
+        auto count = 0;
+        while (ring.Push(message, sizeof(message)))
+            ++count;
+
+        REQUIRE(count == 4);
+        REQUIRE(ring.Push(message, 200) == false);
+
+        RingBuffer attached(memory.data(), 256, false);
+        REQUIRE(attached.IsValid());
+        REQUIRE(attached.Pop([](const uint8_t*, size_t aLength) { REQUIRE(aLength == 60); }));
+        REQUIRE(ring.Push(message, sizeof(message)));
+    }
+
+    GIVEN("Memory that does not start on a cache line")
+    {
+        std::vector<uint8_t> unaligned(RingBuffer::GetRequiredSize(256) + 1);
+        RingBuffer shifted(unaligned.data() + 1, 256, true);
+
+        const uint8_t message[100] = { 1, 2, 3 };
+        REQUIRE(shifted.Push(message, sizeof(message)));
+        REQUIRE(shifted.Push(message, sizeof(message)));
+
+        RingBuffer attached(unaligned.data() + 1, 256, false);
+        REQUIRE(attached.IsValid());
+        REQUIRE(attached.Pop([&message](const uint8_t* apData, size_t aLength) { REQUIRE(std::equal(apData, apData + aLength, message, message + sizeof(message))); }));
+        REQUIRE(attached.GetUsedSize() == shifted.GetUsedSize());
+    }
+}
+
+TEST_CASE("Binary logging", "[core.log]")
+{
+    GIVEN("Raw arguments")
+    {
+        const uint64_t arguments[] = { details::ToLogArgument(-42), details::ToLogArgument(255u), details::ToLogArgument(1.5) };
+
+        REQUIRE(Log::Format("%d %x %.2f%%", arguments, 3) == "-42 ff 1.50%");
+        REQUIRE(Log::Format("%5lu|%-4hhd|", arguments + 1, 1) == "  255|<missing>|");
+        REQUIRE(Log::Format("%d %d", arguments, 1) == "-42 <missing>");
+    }
+
+    GIVEN("Records from several threads")
+    {
+        const std::string path = "dow_log_test.bin";
+
+        REQUIRE(Log::Start(path));
+        REQUIRE(Log::Start(path) == false);
+
+        auto producer = [](int aThread)
+        {
+            for (int i = 0; i < 100; ++i)
+                LOG_INFO("thread %d record %d", aThread, i);
+        };
+
+        std::thread first(producer, 1);
+        std::thread second(producer, 2);
+        first.join();
+        second.join();
+
+        LOG_ERROR("value %.1f", 0.5f);
+
+        Log::Stop();
+        REQUIRE(Log::IsEnabled() == false);
+
+        LOG_ERROR("dropped silently");
+
+        std::ostringstream output;
+        REQUIRE(Log::Decode(path, output));
+
+        const auto text = output.str();
+        REQUIRE(std::count(text.begin(), text.end(), '\n') == 201);
+        REQUIRE(text.find("[INFO]") != std::string::npos);
+        REQUIRE(text.find("thread 1 record 99") != std::string::npos);
+        REQUIRE(text.find("thread 2 record 0") != std::string::npos);
+        REQUIRE(text.find("[ERROR]") != std::string::npos);
+        REQUIRE(text.find("value 0.5") != std::string::npos);
+        REQUIRE(text.find("dropped silently") == std::string::npos);
+
+        std::remove(path.c_str());
+    }
+
+    GIVEN("Short lived threads")
+    {
+        const std::string path = "dow_log_threads.bin";
+
+        // Stop drains every ring, each new thread takes over the one the previous thread left
+        std::set<std::string> rings;
+        for (int i = 0; i < 5; ++i)
+        {
+            REQUIRE(Log::Start(path));
+            std::thread([i]() { LOG_INFO("short %d", i); }).join();
+            Log::Stop();
+
+            std::ostringstream output;
+            REQUIRE(Log::Decode(path, output));
+
+            const auto text = output.str();
+            REQUIRE(text.find("short " + std::to_string(i)) != std::string::npos);
+            rings.insert(text.substr(text.find('('), text.find(')') - text.find('(') + 1));
+        }
+
+        REQUIRE(rings.size() == 1);
+
+        std::remove(path.c_str());
+    }
+}
+
+
+TEST_CASE("Monotonic clock", "[core.clock]")
+{
+    const auto first = Clock::GetTimestamp();
+    const auto second = Clock::GetTimestamp();
+    REQUIRE(second >= first);
+
+    GIVEN("A cached tick")
+    {
+        const auto now = Clock::Tick();
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+        REQUIRE(Clock::GetNow() == now);
+
+        const auto elapsed = Clock::GetTimestamp() - now;
+        REQUIRE(elapsed >= Clock::Milliseconds(9));
+        REQUIRE(elapsed < Clock::Seconds(1));
+
+        REQUIRE(Clock::Tick() >= now + elapsed);
+        REQUIRE(Clock::GetNow() > now);
+    }
+}
+
+
+TEST_CASE("Fixed timestep scheduling", "[core.tickscheduler]")
+{
+    TickScheduler scheduler(128);
+    REQUIRE(scheduler.GetPeriod() == Clock::Seconds(1) / 128);
+
+    GIVEN("A loop keeping up with the tick rate")
+    {
+        uint32_t ticks = 0;
+        for (int i = 0; i < 16; ++i)
+        {
+            auto count = scheduler.Wait();
+            REQUIRE(count == 1);
+            REQUIRE(Clock::GetTimestamp() >= scheduler.GetDeadline() - scheduler.GetPeriod());
+
+            ticks += count;
+        }
+
+        REQUIRE(ticks == 16);
+        REQUIRE(scheduler.GetStats().Ticks == 16);
+        REQUIRE(scheduler.GetStats().SkippedTicks == 0);
+        // Generous bound, the spin keeps it in the microseconds on an idle machine
+        REQUIRE(scheduler.GetStats().GetAverageJitter() < Clock::Milliseconds(2));
+    }
+
+    GIVEN("A loop falling behind")
+    {
+        std::this_thread::sleep_for(std::chrono::nanoseconds(scheduler.GetPeriod() * 10));
+
+        REQUIRE(scheduler.Wait() == 4);
+        REQUIRE(scheduler.GetStats().CatchUpTicks == 3);
+        REQUIRE(scheduler.GetStats().SkippedTicks >= 6);
+        REQUIRE(scheduler.GetDeadline() > Clock::GetTimestamp());
+
+        scheduler.ResetStats();
+        REQUIRE(scheduler.GetStats().Ticks == 0);
+    }
+
+    GIVEN("An event loop interrupting the wait")
+    {
+        uint64_t requested = 0;
+        REQUIRE(scheduler.Wait([&requested](uint64_t aTimeout) { requested = aTimeout; return true; }) == 0);
+        REQUIRE(requested > 0);
+        REQUIRE(requested < scheduler.GetPeriod());
+
+        REQUIRE(scheduler.Wait([](uint64_t) { return false; }) == 1);
+    }
+}
+
+
+TEST_CASE("Galois field arithmetic", "[core.galoisfield]")
+{
+    for (uint32_t i = 1; i < 256; ++i)
+    {
+        REQUIRE(GaloisField::Multiply((uint8_t)i, GaloisField::Inverse((uint8_t)i)) == 1);
+        REQUIRE(GaloisField::Divide(GaloisField::Multiply((uint8_t)i, 7), 7) == i);
+    }
+
+    REQUIRE(GaloisField::Multiply(0, 42) == 0);
+    REQUIRE(GaloisField::Multiply(2, 0x80) == 0x1D);
+
+    GIVEN("Every kernel the CPU supports")
+    {
+        std::vector<uint8_t> source(1000);
+        for (size_t i = 0; i < source.size(); ++i)
+            source[i] = (uint8_t)(i * 31 + 7);
+
+        const auto best = GaloisField::GetBestKernel();
+
+        // Odd lengths exercise the scalar tails of the vector kernels
+        for (size_t length : { 0, 1, 15, 16, 33, 100, 1000 })
+        {
+            for (uint32_t factor : { 0, 1, 2, 0x53, 0xFF })
+            {
+                std::vector<uint8_t> expected(length, 0xA5);
+                GaloisField::MultiplyAdd(expected.data(), source.data(), (uint8_t)factor, length, GaloisField::kScalar);
+
+                std::vector<uint8_t> reference(length);
+                for (size_t i = 0; i < length; ++i)
+                    reference[i] = 0xA5 ^ GaloisField::Multiply((uint8_t)factor, source[i]);
+
+                REQUIRE(expected == reference);
+
+                for (int kernel = GaloisField::kSsse3; kernel <= best; ++kernel)
+                {
+                    std::vector<uint8_t> result(length, 0xA5);
+                    GaloisField::MultiplyAdd(result.data(), source.data(), (uint8_t)factor, length, (GaloisField::Kernel)kernel);
+
+                    REQUIRE(result == expected);
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("Intrusive containers", "[core.intrusive]")
+{
+    struct Timer
+    {
+        uint64_t Deadline{ 0 };
+        int Id{ 0 };
+        IntrusiveListNode QueueNode;
+        IntrusiveListNode ResendNode;
+        IntrusiveHeapNode HeapNode;
+        Timer* pNextFree{ nullptr };
+    };
+
+    std::vector<Timer> timers(8);
+    for (int i = 0; i < 8; ++i)
+        timers[i].Id = i;
+
+    GIVEN("Lists")
+    {
+        using Queue = IntrusiveList<Timer, &Timer::QueueNode>;
+        Queue first, second;
+        IntrusiveList<Timer, &Timer::ResendNode> resend;
+
+        REQUIRE(first.IsEmpty());
+        REQUIRE(first.GetFront() == nullptr);
+        REQUIRE(first.PopFront() == nullptr);
+
+        for (auto& timer : timers)
+            first.PushBack(timer);
+        resend.PushFront(timers[3]);
+        resend.PushFront(timers[5]);
+
+        REQUIRE(first.GetCount() == 8);
+        REQUIRE(first.GetFront()->Id == 0);
+        REQUIRE(first.GetBack()->Id == 7);
+        REQUIRE(resend.GetFront()->Id == 5);
+
+        // Moving between lists unlinks from the previous one
+        second.PushBack(timers[2]);
+        Queue::Remove(timers[4]);
+        REQUIRE(first.GetCount() == 6);
+        REQUIRE(second.GetFront()->Id == 2);
+        REQUIRE(!timers[4].QueueNode.IsLinked());
+        REQUIRE(resend.GetCount() == 2);
+
+        std::vector<int> ids;
+        for (auto& timer : first)
+            ids.push_back(timer.Id);
+        REQUIRE(ids == std::vector<int>{ 0, 1, 3, 5, 6, 7 });
+
+        REQUIRE(first.PopFront()->Id == 0);
+        REQUIRE(first.PopBack()->Id == 7);
+        REQUIRE(first.GetCount() == 4);
+
+        // A copy starts unlinked and the destructor unlinks
+        {
+            Timer copy = timers[1];
+            REQUIRE(!copy.QueueNode.IsLinked());
+            first.PushBack(copy);
+            REQUIRE(first.GetCount() == 5);
+        }
+        REQUIRE(first.GetCount() == 4);
+
+        first.Clear();
+        REQUIRE(first.IsEmpty());
+        REQUIRE(!timers[1].QueueNode.IsLinked());
+        REQUIRE(timers[3].ResendNode.IsLinked());
+    }
+    GIVEN("A free list")
+    {
+        IntrusiveFreeList<Timer, &Timer::pNextFree> pool;
+        REQUIRE(pool.Pop() == nullptr);
+
+        for (auto& timer : timers)
+            pool.Push(timer);
+
+        REQUIRE(pool.GetCount() == 8);
+        REQUIRE(pool.Pop()->Id == 7);
+        REQUIRE(pool.Pop()->Id == 6);
+        REQUIRE(pool.GetCount() == 6);
+
+        pool.Clear();
+        REQUIRE(pool.IsEmpty());
+    }
+    GIVEN("A heap")
+    {
+        auto earlier = [](const Timer& acLhs, const Timer& acRhs) { return acLhs.Deadline < acRhs.Deadline; };
+        IntrusiveHeap<Timer, &Timer::HeapNode, decltype(earlier)> heap(earlier);
+        heap.Reserve(timers.size());
+
+        const uint64_t deadlines[] = { 50, 20, 80, 10, 70, 30, 60, 40 };
+        for (int i = 0; i < 8; ++i)
+        {
+            timers[i].Deadline = deadlines[i];
+            heap.Push(timers[i]);
+        }
+
+        REQUIRE(heap.GetCount() == 8);
+        REQUIRE(heap.GetTop()->Deadline == 10);
+
+        // Re-keying and removing in the middle
+        timers[2].Deadline = 5;
+        heap.Update(timers[2]);
+        REQUIRE(heap.GetTop()->Id == 2);
+
+        heap.Remove(timers[1]);
+        REQUIRE(!timers[1].HeapNode.IsLinked());
+
+        timers[3].Deadline = 100;
+        heap.Push(timers[3]);
+        REQUIRE(heap.GetCount() == 7);
+
+        std::vector<uint64_t> order;
+        while (auto* pTimer = heap.Pop())
+            order.push_back(pTimer->Deadline);
+        REQUIRE(order == std::vector<uint64_t>{ 5, 30, 40, 50, 60, 70, 100 });
+
+        // Matches a sort on random keys
+        uint32_t seed = 7;
+        std::vector<Timer> many(1000);
+        for (auto& timer : many)
+        {
+            seed = seed * 1664525u + 1013904223u;
+            timer.Deadline = seed >> 8;
+            heap.Push(timer);
+        }
+        for (size_t i = 0; i < many.size(); i += 3)
+            heap.Remove(many[i]);
+
+        std::vector<uint64_t> expected;
+        for (size_t i = 0; i < many.size(); ++i)
+        {
+            if (i % 3 != 0)
+                expected.push_back(many[i].Deadline);
+        }
+        std::sort(expected.begin(), expected.end());
+
+        order.clear();
+        while (auto* pTimer = heap.Pop())
+            order.push_back(pTimer->Deadline);
+        REQUIRE(order == expected);
+    }
+}
+
+TEST_CASE("Latency histogram", "[core.histogram]")
+{
+    Histogram histogram;
+    REQUIRE(histogram.GetCount() == 0);
+    REQUIRE(histogram.GetPercentile(50) == 0);
+
+    for (uint64_t i = 1; i <= 1000; ++i)
+        histogram.Record(i * 1000);
+
+    REQUIRE(histogram.GetCount() == 1000);
+    REQUIRE(histogram.GetMin() == 1000);
+    REQUIRE(histogram.GetMax() == 1000000);
+    REQUIRE(histogram.GetMean() == 500500);
+
+    // Within the bucket precision
+    for (auto percentile : { 1.0, 10.0, 50.0, 90.0, 99.0, 99.9 })
+    {
+        const auto exact = percentile * 10 * 1000;
+        const auto value = (double)histogram.GetPercentile(percentile);
+        REQUIRE(value >= exact);
+        REQUIRE(value <= exact * (1.0 + 1.0 / Histogram::SubBuckets) + 1);
+    }
+    REQUIRE(histogram.GetPercentile(100) == 1000000);
+
+    // Small values are exact
+    histogram.Reset();
+    for (uint64_t i = 0; i < 16; ++i)
+        histogram.Record(i);
+    REQUIRE(histogram.GetPercentile(50) == 7);
+    REQUIRE(histogram.GetMin() == 0);
+
+    histogram.Record(UINT64_MAX);
+    REQUIRE(histogram.GetPercentile(100) == UINT64_MAX);
+}
+
+TEST_CASE("Pool allocator", "[core.allocators]")
+{
+    GIVEN("A pool of four blocks")
+    {
+        TrackAllocator<StandardAllocator> fallback;
+        PoolAllocator pool(100, 4, &fallback);
+        REQUIRE(pool.IsValid());
+        REQUIRE(pool.GetBlockSize() >= 100);
+        REQUIRE(pool.GetFreeCount() == 4);
+
+        const auto slabMemory = fallback.GetUsedMemory();
+
+        void* pBlocks[4];
+        for (auto& pBlock : pBlocks)
+            REQUIRE((pBlock = pool.Allocate(100)) != nullptr);
+
+        REQUIRE(pool.GetFreeCount() == 0);
+        REQUIRE(pool.GetFallbackCount() == 0);
+        REQUIRE(pool.Size(pBlocks[0]) == pool.GetBlockSize());
+        REQUIRE(pool.GetUsedMemory() == 4 * pool.GetBlockSize());
+        REQUIRE((uint8_t*)pBlocks[1] - (uint8_t*)pBlocks[0] == (ptrdiff_t)pool.GetBlockSize());
+
+        // Exhausted and oversized requests go to the fallback allocator
+        auto* pExtra = pool.Allocate(10);
+        auto* pLarge = pool.Allocate(1000);
+        REQUIRE(pExtra != nullptr);
+        REQUIRE(pLarge != nullptr);
+        REQUIRE(pool.GetFallbackCount() == 2);
+        REQUIRE(fallback.GetUsedMemory() > slabMemory);
+
+        pool.Free(pExtra);
+        pool.Free(pLarge);
+        REQUIRE(fallback.GetUsedMemory() == slabMemory);
+
+        for (auto* pBlock : pBlocks)
+            pool.Free(pBlock);
+
+        REQUIRE(pool.GetFreeCount() == 4);
+        REQUIRE(pool.GetUsedMemory() == 0);
+    }
+    GIVEN("A standard container using the pool")
+    {
+        PoolAllocator pool(64, 16);
+
+        std::vector<uint32_t, StlAllocator<uint32_t>> values{ StlAllocator<uint32_t>(&pool) };
+        values.reserve(16);
+        for (uint32_t i = 0; i < 16; ++i)
+            values.push_back(i);
+
+        REQUIRE(pool.GetFreeCount() == 15);
+        REQUIRE(pool.GetFallbackCount() == 0);
+
+        values = decltype(values){ StlAllocator<uint32_t>(&pool) };
+        REQUIRE(pool.GetFreeCount() == 16);
+    }
+}
+
+TEST_CASE("Allocation trace", "[core.allocators]")
+{
+    const auto path = "dow_trace_" + std::to_string(Clock::GetTimestamp()) + ".bin";
+
+    TraceAllocator trace;
+    {
+        ScopedAllocator _(&trace);
+
+        Buffer first(100);
+        {
+            Buffer second(2000);
+            REQUIRE(trace.Size(second.GetWriteData()) >= 2000);
+        }
+
+        std::thread([&trace]()
+        {
+            trace.Free(trace.Allocate(50));
+        }).join();
+
+        Buffer third(300);
+    }
+
+    // Pointers the trace never saw are forwarded without being recorded
+    auto* pForeign = Allocator::GetDefault()->Allocate(10);
+    trace.Free(pForeign);
+
+    const auto events = trace.GetEvents();
+    REQUIRE(events.size() == 9);
+    REQUIRE(events[0].Op == TraceAllocator::kAllocate);
+    REQUIRE(events[0].Size == 100);
+    REQUIRE(events[0].Id == 1);
+    REQUIRE(events[2].Op == TraceAllocator::kSize);
+    REQUIRE(events[2].Id == 2);
+    REQUIRE(events[3].Op == TraceAllocator::kFree);
+    REQUIRE(events[3].Id == 2);
+    REQUIRE(events[4].Thread == 1);
+    REQUIRE(events[5].Thread == 1);
+    REQUIRE(events[8].Id == 1);
+    for (size_t i = 1; i < events.size(); ++i)
+        REQUIRE(events[i].Timestamp >= events[i - 1].Timestamp);
+
+    REQUIRE(trace.Save(path));
+
+    std::vector<TraceAllocator::Event> loaded;
+    REQUIRE(TraceAllocator::Load(path, loaded));
+    std::remove(path.c_str());
+
+    REQUIRE(loaded.size() == events.size());
+    for (size_t i = 0; i < events.size(); ++i)
+    {
+        REQUIRE(loaded[i].Op == events[i].Op);
+        REQUIRE(loaded[i].Timestamp == events[i].Timestamp);
+        REQUIRE(loaded[i].Size == events[i].Size);
+        REQUIRE(loaded[i].Id == events[i].Id);
+        REQUIRE(loaded[i].Thread == events[i].Thread);
+    }
+
+    GIVEN("A replay against the standard allocator")
+    {
+        TrackAllocator<StandardAllocator> allocator;
+        const auto result = TraceAllocator::Replay(loaded, allocator);
+
+        REQUIRE(result.Allocations == 4);
+        REQUIRE(result.Failures == 0);
+        REQUIRE(result.PeakRequested == 2100);
+        REQUIRE(result.PeakReserved >= result.PeakRequested);
+    }
+    GIVEN("A replay against a pool too small for the large buffer")
+    {
+        PoolAllocator pool(512, 2);
+        const auto result = TraceAllocator::Replay(loaded, pool);
+
+        REQUIRE(result.Failures == 0);
+        REQUIRE(pool.GetFallbackCount() == 1);
+        REQUIRE(pool.GetFreeCount() == 2);
+        REQUIRE(result.PeakReserved >= 512 + 2000);
+    }
+    GIVEN("A missing trace")
+    {
+        std::vector<TraceAllocator::Event> empty;
+        REQUIRE(TraceAllocator::Load(path, empty) == false);
+    }
+}
+
+TEST_CASE("Profiling zones", "[core.profiler]")
+{
+    auto work = [](uint32_t aItems)
+    {
+        PROFILE_ZONE(zone, "test.work");
+
+        volatile uint64_t sum = 0;
+        for (uint32_t i = 0; i < aItems * 1000; ++i)
+            sum = sum + i;
+
+        zone.AddItems(aItems);
+    };
+
+    auto find = [](const char* acpName)
+    {
+        for (auto& zone : Profiler::GetZones())
+        {
+            if (std::strcmp(zone.Name, acpName) == 0)
+                return zone;
+        }
+        return Profiler::Zone{};
+    };
+
+    Profiler::Reset();
+
+    // Disabled zones record nothing
+    work(1);
+    REQUIRE(find("test.work").Calls == 0);
+
+    Profiler::Enable(true);
+
+    const bool counting = Profiler::EnableCounters();
+    REQUIRE(Profiler::HasCounters() == counting);
+
+    {
+        PROFILE_ZONE(outer, "test.outer");
+        work(2);
+        work(3);
+    }
+
+    std::thread([&]()
+    {
+        work(5);
+    }).join();
+
+    const auto zone = find("test.work");
+    REQUIRE(zone.Calls == 3);
+    REQUIRE(zone.Items == 10);
+    REQUIRE(zone.Time > 0);
+
+    const auto outer = find("test.outer");
+    REQUIRE(outer.Calls == 1);
+    REQUIRE(outer.Items == 0);
+    REQUIRE(outer.Time > 0);
+
+    // Hardware counters are often missing in virtual machines or refused by perf_event_paranoid
+    if (counting)
+    {
+        REQUIRE(zone.Counters[Profiler::kCycles] > 0);
+        REQUIRE(zone.Counters[Profiler::kInstructions] >= 5000);
+        REQUIRE(outer.Counters[Profiler::kInstructions] > 0);
+    }
+    else
+        REQUIRE(outer.Counters[Profiler::kInstructions] == 0);
+
+    std::ostringstream output;
+    Profiler::Print(output);
+    REQUIRE(output.str().find("test.work") != std::string::npos);
+
+    Profiler::DisableCounters();
+    REQUIRE(Profiler::HasCounters() == false);
+    Profiler::Enable(false);
+
+    Profiler::Reset();
+    REQUIRE(find("test.work").Calls == 0);
 }
\ No newline at end of file
@@ -1,3 +1,3 @@
-#define CATCH_CONFIG_MAIN
-#include "catch.hpp"
-
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
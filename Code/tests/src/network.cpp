@@ -1,281 +1,2508 @@
-#include "catch.hpp"
-
-#include "Socket.h"
-#include "Server.h"
-#include "Selector.h"
-
-#include <cstring>
-#include <thread>
-
-
-TEST_CASE("Networking", "[network]")
-{
-    InitializeNetwork();
-
-    GIVEN("A basic socket")
-    {
-        Socket sock;
-        REQUIRE(sock.GetPort() == 0);
-        REQUIRE(sock.Bind() == true);
-        REQUIRE(sock.GetPort() != 0);
-    }
-    GIVEN("Two sockets v4")
-    {
-        static const std::string testString = "abcdef";
-
-        Buffer buffer(100);
-
-        Socket client(Endpoint::kIPv4), server(Endpoint::kIPv4);
-        REQUIRE(client.Bind());
-        REQUIRE(server.Bind());
-
-        Selector clientSelector(client);
-        Selector serverSelector(server);
-
-        REQUIRE(clientSelector.IsReady() == false);
-        REQUIRE(serverSelector.IsReady() == false);
-
-        Endpoint clientEndpoint{ "127.0.0.1" };
-        Endpoint serverEndpoint{ "127.0.0.1" };
-        clientEndpoint.SetPort(client.GetPort());
-        serverEndpoint.SetPort(server.GetPort());
-
-        Buffer::Writer writer(&buffer);
-        writer.WriteBytes((const uint8_t*)testString.data(), testString.size());
-
-        Socket::Packet packet{ serverEndpoint, buffer };
-
-        REQUIRE(serverSelector.IsReady() == false);
-
-        REQUIRE(client.Send(packet));
-
-        // Now the server should have available data
-        REQUIRE(serverSelector.IsReady());
-
-        auto result = server.Receive();
-        REQUIRE(result.HasError() == false);
-        auto data = result.GetResult();
-        REQUIRE(std::memcmp(data.Payload.GetData(), buffer.GetData(), buffer.GetSize()) == 0);
-        REQUIRE(data.Remote.IsIPv4());
-
-        // Reply exactly what we got to the client
-        REQUIRE(server.Send(data));
-        result = client.Receive();
-        REQUIRE(result.HasError() == false);
-        data = result.GetResult();
-        REQUIRE(std::memcmp(data.Payload.GetData(), buffer.GetData(), buffer.GetSize()) == 0);
-        REQUIRE(data.Remote.IsIPv4());
-    }
-    GIVEN("Two sockets v6")
-    {
-        static const std::string testString = "abcdef";
-
-        Buffer buffer(100);
-
-        Socket client, server;
-        REQUIRE(client.Bind());
-        REQUIRE(server.Bind());
-
-        Selector clientSelector(client);
-        Selector serverSelector(server);
-
-        REQUIRE(clientSelector.IsReady() == false);
-        REQUIRE(serverSelector.IsReady() == false);
-
-        Endpoint clientEndpoint{ "[::1]" };
-        Endpoint serverEndpoint{ "[::1]" };
-        clientEndpoint.SetPort(client.GetPort());
-        serverEndpoint.SetPort(server.GetPort());
-
-        Buffer::Writer writer(&buffer);
-        writer.WriteBytes((const uint8_t*)testString.data(), testString.size());
-
-        Socket::Packet packet{ serverEndpoint, buffer };
-
-        REQUIRE(serverSelector.IsReady() == false);
-
-        REQUIRE(client.Send(packet));
-
-        // Now the server should have available data
-        REQUIRE(serverSelector.IsReady());
-
-        auto result = server.Receive();
-        REQUIRE(result.HasError() == false);
-        auto data = result.GetResult();
-        REQUIRE(std::memcmp(data.Payload.GetData(), buffer.GetData(), buffer.GetSize()) == 0);
-        REQUIRE(data.Remote.IsIPv6());
-
-        // Reply exactly what we got to the client
-        REQUIRE(server.Send(data));
-        result = client.Receive();
-        REQUIRE(result.HasError() == false);
-        data = result.GetResult();
-        REQUIRE(std::memcmp(data.Payload.GetData(), buffer.GetData(), buffer.GetSize()) == 0);
-        REQUIRE(data.Remote.IsIPv6());
-    }
-
-    GIVEN("A client server model")
-    {
-        Buffer buffer(100);
-
-        Server server;
-        REQUIRE(server.Start(0));
-
-        REQUIRE(server.GetPort() != 0);
-
-        Endpoint serverEndpointv6{ "[::1]" };
-        Endpoint serverEndpointv4{ "127.0.0.1" };
-
-        serverEndpointv6.SetPort(server.GetPort());
-        serverEndpointv4.SetPort(server.GetPort());
-
-        Socket clientv6(Endpoint::kIPv6);
-        Socket clientv4(Endpoint::kIPv4);
-
-        clientv6.Bind();
-        clientv4.Bind();
-
-        Socket::Packet packetv6{ serverEndpointv6, buffer };
-        Socket::Packet packetv4{ serverEndpointv4, buffer };
-
-        REQUIRE(clientv6.Send(packetv6));
-
-        REQUIRE(server.Update(1) == 1);
-
-        REQUIRE(clientv4.Send(packetv4));
-
-        REQUIRE(server.Update(1) == 1);
-
-        REQUIRE(clientv6.Send(packetv6));
-        REQUIRE(clientv4.Send(packetv4));
-
-        REQUIRE(server.Update(1) == 2);
-    }
-}
-
-TEST_CASE("Connection", "[network.connection]")
-{
-    GIVEN("A connection with a dummy interface")
-    {
-        static uint32_t s_count{0};
-        static Endpoint remoteEndpoint{ "127.0.0.1" };
-        static Buffer buffer;
-
-        remoteEndpoint.SetPort(12345);
-
-        struct DummyCommunication : Connection::ICommunication
-        {
-            bool Send(const Endpoint& acRemote, Buffer aBuffer) override
-            {
-                REQUIRE(acRemote == remoteEndpoint);
-                buffer = aBuffer;
-                ++s_count;
-                return true;
-            }
-        };
-
-        DummyCommunication comm;
-
-        Connection connection(comm, remoteEndpoint);
-        Connection connection2(comm, remoteEndpoint);
-        REQUIRE(connection.IsNegotiating());
-
-        connection.Update(1);
-
-        REQUIRE(s_count == 1);
-        REQUIRE(buffer.GetData()[0] == 'M');
-        REQUIRE(buffer.GetData()[1] == 'G');
-
-        REQUIRE(connection2.ProcessNegociation(&buffer));
-    }
-}
-
-TEST_CASE("Server", "[network.server]")
-{
-    GIVEN("A client server model")
-    {
-        Buffer buffer(100);
-
-        Server server;
-        REQUIRE(server.Start(0));
-        REQUIRE(server.GetPort() != 0);
-
-        Endpoint serverEndpoint{ "127.0.0.1" };
-
-        serverEndpoint.SetPort(server.GetPort());
-
-        Socket client(Endpoint::kIPv4);
-        client.Bind();
-
-        Socket::Packet packet{ serverEndpoint, buffer };
-    }
-}
-
-TEST_CASE("Endpoint", "[network.endpoint]")
-{
-    GIVEN("An empty endpoint")
-    {
-        Endpoint endpoint;
-        REQUIRE(endpoint.IsValid() == false);
-    }
-    GIVEN("An IPv4")
-    {
-        Endpoint endpoint("127.0.0.1");
-        REQUIRE(endpoint.IsIPv4() == true);
-        REQUIRE(endpoint.GetPort() == 0);
-        REQUIRE(endpoint.GetIPv4()[0] == 127);
-        REQUIRE(endpoint.GetIPv4()[1] == 0);
-        REQUIRE(endpoint.GetIPv4()[2] == 0);
-        REQUIRE(endpoint.GetIPv4()[3] == 1);
-    }
-    GIVEN("An IPv4 with a port")
-    {
-        Endpoint endpoint("127.0.0.1:12345");
-        REQUIRE(endpoint.IsIPv4() == true);
-        REQUIRE(endpoint.GetPort() == 12345);
-        REQUIRE(endpoint.GetIPv4()[0] == 127);
-        REQUIRE(endpoint.GetIPv4()[1] == 0);
-        REQUIRE(endpoint.GetIPv4()[2] == 0);
-        REQUIRE(endpoint.GetIPv4()[3] == 1);
-    }
-    GIVEN("A bad IPv4")
-    {
-        Endpoint endpoint("127.0.1");
-        REQUIRE(endpoint.IsValid() == false);
-        REQUIRE(endpoint.GetPort() == 0);
-    }
-    GIVEN("A bad IP")
-    {
-        Endpoint endpoint("lol");
-        REQUIRE(endpoint.IsValid() == false);
-        REQUIRE(endpoint.GetPort() == 0);
-    }
-    GIVEN("An IPv6")
-    {
-        Endpoint endpoint("[2001:0db8:85a3:0000:0000:8a2e:0370:7334]");
-        REQUIRE(endpoint.IsIPv6() == true);
-        REQUIRE(endpoint.GetPort() == 0);
-        REQUIRE(endpoint.GetIPv6()[0] == 0x2001);
-        REQUIRE(endpoint.GetIPv6()[1] == 0x0db8);
-        REQUIRE(endpoint.GetIPv6()[2] == 0x85a3);
-        REQUIRE(endpoint.GetIPv6()[3] == 0x0000);
-        REQUIRE(endpoint.GetIPv6()[4] == 0x0000);
-        REQUIRE(endpoint.GetIPv6()[5] == 0x8a2e);
-        REQUIRE(endpoint.GetIPv6()[6] == 0x0370);
-        REQUIRE(endpoint.GetIPv6()[7] == 0x7334);
-    }
-    GIVEN("An IPv6 with a port")
-    {
-        Endpoint endpoint("[2001:0db8:85a3:0000:0000:8a2e:0370:7334]:12345");
-        REQUIRE(endpoint.IsIPv6() == true);
-        REQUIRE(endpoint.GetPort() == 12345);
-        REQUIRE(endpoint.GetIPv6()[0] == 0x2001);
-        REQUIRE(endpoint.GetIPv6()[1] == 0x0db8);
-        REQUIRE(endpoint.GetIPv6()[2] == 0x85a3);
-        REQUIRE(endpoint.GetIPv6()[3] == 0x0000);
-        REQUIRE(endpoint.GetIPv6()[4] == 0x0000);
-        REQUIRE(endpoint.GetIPv6()[5] == 0x8a2e);
-        REQUIRE(endpoint.GetIPv6()[6] == 0x0370);
-        REQUIRE(endpoint.GetIPv6()[7] == 0x7334);
-    }
+#include "catch.hpp"
+
+#include "Socket.h"
+#include "Server.h"
+#include "Client.h"
+#include "Async.h"
+#include "Selector.h"
+#include "SharedMemoryCommunication.h"
+#include "LoopbackCommunication.h"
+#include "ClockSync.h"
+#include "BulkTransfer.h"
+#include "InterestGrid.h"
+#include "Replication.h"
+#include "Rpc.h"
+#include "StringTable.h"
+#include "SnapshotHistory.h"
+#include "StandardAllocator.h"
+#include "TrackAllocator.h"
+
+#include <cstring>
+#include <thread>
+#include <future>
+#include <chrono>
+#include <algorithm>
+#include <memory>
+#include <set>
+#include <limits>
+
+#ifdef __linux__
+#include <sys/stat.h>
+#include <sys/resource.h>
+#include <csignal>
+#include <unistd.h>
+#endif
+
+
+// Client side of a UDP connection
+struct UdpCommunication : Connection::ICommunication
+{
+    UdpCommunication(Endpoint::Type aType = Endpoint::kIPv4) : Listener(aType) { Listener.Bind(); }
+
+    bool Send(const Endpoint& acRemote, Buffer aBuffer) override
+    {
+        return Listener.Send(Socket::Packet{ acRemote, std::move(aBuffer) });
+    }
+
+    void Drain(Connection& aConnection)
+    {
+        Listener.ReceiveAll([&aConnection](const uint8_t* apData, size_t aLength, const Endpoint&) { aConnection.ProcessPacket(apData, aLength); });
+    }
+
+    Socket Listener;
+};
+
+TEST_CASE("Networking", "[network]")
+{
+    InitializeNetwork();
+
+    GIVEN("A basic socket")
+    {
+        Socket sock;
+        REQUIRE(sock.GetPort() == 0);
+        REQUIRE(sock.Bind() == true);
+        REQUIRE(sock.GetPort() != 0);
+    }
+    GIVEN("Two sockets v4")
+    {
+        static const std::string testString = "abcdef";
+
+        Buffer buffer(100);
+
+        Socket client(Endpoint::kIPv4), server(Endpoint::kIPv4);
+        REQUIRE(client.Bind());
+        REQUIRE(server.Bind());
+
+        Selector clientSelector(client);
+        Selector serverSelector(server);
+
+        REQUIRE(clientSelector.IsReady() == false);
+        REQUIRE(serverSelector.IsReady() == false);
+
+        Endpoint clientEndpoint{ "127.0.0.1" };
+        Endpoint serverEndpoint{ "127.0.0.1" };
+        clientEndpoint.SetPort(client.GetPort());
+        serverEndpoint.SetPort(server.GetPort());
+
+        Buffer::Writer writer(&buffer);
+        writer.WriteBytes((const uint8_t*)testString.data(), testString.size());
+
+        Socket::Packet packet{ serverEndpoint, buffer };
+
+        REQUIRE(serverSelector.IsReady() == false);
+
+        REQUIRE(client.Send(packet));
+
+        // Now the server should have available data
+        REQUIRE(serverSelector.IsReady());
+
+        auto result = server.Receive();
+        REQUIRE(result.HasError() == false);
+        auto data = result.GetResult();
+        REQUIRE(std::memcmp(data.Payload.GetData(), buffer.GetData(), buffer.GetSize()) == 0);
+        REQUIRE(data.Remote.IsIPv4());
+
+        // Reply exactly what we got to the client
+        REQUIRE(server.Send(data));
+        result = client.Receive();
+        REQUIRE(result.HasError() == false);
+        data = result.GetResult();
+        REQUIRE(std::memcmp(data.Payload.GetData(), buffer.GetData(), buffer.GetSize()) == 0);
+        REQUIRE(data.Remote.IsIPv4());
+    }
+    GIVEN("A batch with a datagram the kernel refuses")
+    {
+        Socket client(Endpoint::kIPv4), server(Endpoint::kIPv4);
+        REQUIRE(client.Bind());
+        REQUIRE(server.Bind());
+
+        Endpoint serverEndpoint{ "127.0.0.1" };
+        serverEndpoint.SetPort(server.GetPort());
+
+        // Broadcasting without SO_BROADCAST is refused, the datagrams around it must still go out
+        const Endpoint destinations[] = { serverEndpoint, Endpoint{ "255.255.255.255:9" }, serverEndpoint, serverEndpoint };
+        for (uint8_t i = 0; i < 4; ++i)
+        {
+            auto* pSlot = client.Reserve();
+            REQUIRE(pSlot != nullptr);
+            pSlot[0] = i;
+            client.Commit(destinations[i], 1);
+        }
+
+        REQUIRE(client.Flush() == 3);
+        REQUIRE(client.GetDroppedCount() == 1);
+        REQUIRE(client.GetPendingCount() == 0);
+
+        std::vector<uint8_t> received;
+        REQUIRE(Selector(server).Wait(1000000));
+        server.ReceiveAll([&received](const uint8_t* apData, size_t, const Endpoint&) { received.push_back(apData[0]); });
+        REQUIRE(received == std::vector<uint8_t>{ 0, 2, 3 });
+    }
+    GIVEN("Two sockets v6")
+    {
+        static const std::string testString = "abcdef";
+
+        Buffer buffer(100);
+
+        Socket client, server;
+        REQUIRE(client.Bind());
+        REQUIRE(server.Bind());
+
+        Selector clientSelector(client);
+        Selector serverSelector(server);
+
+        REQUIRE(clientSelector.IsReady() == false);
+        REQUIRE(serverSelector.IsReady() == false);
+
+        Endpoint clientEndpoint{ "[::1]" };
+        Endpoint serverEndpoint{ "[::1]" };
+        clientEndpoint.SetPort(client.GetPort());
+        serverEndpoint.SetPort(server.GetPort());
+
+        Buffer::Writer writer(&buffer);
+        writer.WriteBytes((const uint8_t*)testString.data(), testString.size());
+
+        Socket::Packet packet{ serverEndpoint, buffer };
+
+        REQUIRE(serverSelector.IsReady() == false);
+
+        REQUIRE(client.Send(packet));
+
+        // Now the server should have available data
+        REQUIRE(serverSelector.IsReady());
+
+        auto result = server.Receive();
+        REQUIRE(result.HasError() == false);
+        auto data = result.GetResult();
+        REQUIRE(std::memcmp(data.Payload.GetData(), buffer.GetData(), buffer.GetSize()) == 0);
+        REQUIRE(data.Remote.IsIPv6());
+
+        // Reply exactly what we got to the client
+        REQUIRE(server.Send(data));
+        result = client.Receive();
+        REQUIRE(result.HasError() == false);
+        data = result.GetResult();
+        REQUIRE(std::memcmp(data.Payload.GetData(), buffer.GetData(), buffer.GetSize()) == 0);
+        REQUIRE(data.Remote.IsIPv6());
+    }
+
+    GIVEN("A socket draining its queue in place")
+    {
+        Buffer buffer(100);
+
+        Socket client(Endpoint::kIPv4), server(Endpoint::kIPv4);
+        REQUIRE(client.Bind());
+        REQUIRE(server.Bind());
+
+        Endpoint serverEndpoint{ "127.0.0.1" };
+        serverEndpoint.SetPort(server.GetPort());
+
+        REQUIRE(server.ReceiveAll([](const uint8_t*, size_t, const Endpoint&) {}) == 0);
+
+        // More than a single receive batch
+        for (uint8_t i = 0; i < 40; ++i)
+        {
+            buffer[0] = i;
+            REQUIRE(client.Send(Socket::Packet{ serverEndpoint, buffer }));
+        }
+
+        uint8_t expected = 0;
+        auto count = server.ReceiveAll([&](const uint8_t* apData, size_t aLength, const Endpoint& acRemote)
+        {
+            REQUIRE(aLength == 100);
+            REQUIRE(apData[0] == expected++);
+            REQUIRE(acRemote.IsIPv4());
+            REQUIRE(acRemote.GetPort() == client.GetPort());
+        });
+
+        REQUIRE(count == 40);
+        REQUIRE(server.ReceiveAll([](const uint8_t*, size_t, const Endpoint&) {}) == 0);
+    }
+
+    GIVEN("A client server model")
+    {
+        Buffer buffer(100);
+
+        Server server;
+        REQUIRE(server.Start(0));
+
+        REQUIRE(server.GetPort() != 0);
+
+        Endpoint serverEndpointv6{ "[::1]" };
+        Endpoint serverEndpointv4{ "127.0.0.1" };
+
+        serverEndpointv6.SetPort(server.GetPort());
+        serverEndpointv4.SetPort(server.GetPort());
+
+        Socket clientv6(Endpoint::kIPv6);
+        Socket clientv4(Endpoint::kIPv4);
+
+        clientv6.Bind();
+        clientv4.Bind();
+
+        Socket::Packet packetv6{ serverEndpointv6, buffer };
+        Socket::Packet packetv4{ serverEndpointv4, buffer };
+
+        REQUIRE(server.Wait(Clock::Milliseconds(1)) == false);
+
+        REQUIRE(clientv6.Send(packetv6));
+
+        REQUIRE(server.Wait(Clock::Seconds(1)));
+        REQUIRE(server.Update() == 1);
+
+        REQUIRE(clientv4.Send(packetv4));
+
+        REQUIRE(server.Wait(Clock::Seconds(1)));
+        REQUIRE(server.Update() == 1);
+
+        REQUIRE(clientv6.Send(packetv6));
+        REQUIRE(clientv4.Send(packetv4));
+
+        REQUIRE(server.Update() == 2);
+    }
+}
+
+TEST_CASE("Connection", "[network.connection]")
+{
+    GIVEN("A connection with a dummy interface")
+    {
+        static uint32_t s_count{0};
+        static Endpoint remoteEndpoint{ "127.0.0.1" };
+        static Buffer buffer;
+
+        remoteEndpoint.SetPort(12345);
+
+        struct DummyCommunication : Connection::ICommunication
+        {
+            bool Send(const Endpoint& acRemote, Buffer aBuffer) override
+            {
+                REQUIRE(acRemote == remoteEndpoint);
+                buffer = aBuffer;
+                ++s_count;
+                return true;
+            }
+        };
+
+        DummyCommunication comm;
+
+        const auto now = Clock::Tick();
+
+        Connection connection(comm, remoteEndpoint);
+        Connection connection2(comm, remoteEndpoint);
+        REQUIRE(connection.IsNegotiating());
+
+        connection.Update(now);
+
+        REQUIRE(s_count == 1);
+        REQUIRE(buffer.GetData()[0] == 'M');
+        REQUIRE(buffer.GetData()[1] == 'G');
+
+        REQUIRE(connection2.ProcessNegociation(&buffer));
+
+        connection.Update(now + Connection::Timeout - 1);
+        REQUIRE(connection.IsNegotiating());
+
+        connection.Update(now + Connection::Timeout);
+        REQUIRE(connection.GetState() == Connection::kNone);
+    }
+}
+
+TEST_CASE("Clock synchronization", "[network.clocksync]")
+{
+    ClockSync sync;
+    REQUIRE(sync.HasEstimate() == false);
+
+    GIVEN("Samples with asymmetric queuing delays")
+    {
+        const uint64_t start = Clock::Seconds(10);
+        const int64_t offset = Clock::Milliseconds(250);
+
+        for (uint64_t i = 0; i < 20; ++i)
+        {
+            // Every delayed sample is skewed by half of its extra delay
+            const uint64_t extra = (i % 5) * Clock::Milliseconds(4);
+            const uint64_t roundTrip = Clock::Milliseconds(20) + extra;
+            sync.AddSample(start + i * Clock::Milliseconds(16), offset + int64_t(extra / 2), roundTrip);
+        }
+
+        REQUIRE(sync.HasEstimate());
+        REQUIRE(sync.GetRoundTrip() == Clock::Milliseconds(20));
+        REQUIRE(sync.GetError() == Clock::Milliseconds(10));
+        REQUIRE(sync.GetOffset(start) == offset);
+    }
+
+    GIVEN("A remote clock running fast")
+    {
+        // 100 ppm
+        const double drift = 0.0001;
+
+        for (uint64_t i = 0; i <= 50; ++i)
+        {
+            const uint64_t time = i * Clock::Milliseconds(100);
+            sync.AddSample(time, int64_t(drift * double(time)), Clock::Milliseconds(1));
+        }
+
+        REQUIRE(std::abs(sync.GetDrift() - drift) < drift * 0.01);
+
+        const uint64_t later = Clock::Seconds(10);
+        REQUIRE(std::abs(sync.GetOffset(later) - int64_t(drift * double(later))) < int64_t(Clock::Microseconds(10)));
+    }
+}
+
+TEST_CASE("Forward error correction", "[network.fec]")
+{
+    struct Packet
+    {
+        std::vector<uint8_t> Data;
+    };
+
+    // With fewer than DataCount packets the group is closed early by a partial flush
+    auto run = [](const ForwardErrorCorrection::Config& acConfig, std::initializer_list<size_t> aLost, size_t aCount = 0)
+    {
+        ForwardErrorCorrection sender(acConfig, Connection::MaxPayloadSize);
+        ForwardErrorCorrection receiver(acConfig, Connection::MaxPayloadSize);
+
+        const auto count = aCount ? aCount : acConfig.DataCount;
+
+        std::vector<std::string> payloads;
+        std::vector<Packet> wire;
+        for (size_t i = 0; i < count; ++i)
+        {
+            // Different sizes so the shorter shards need padding
+            payloads.push_back(std::string(10 + i * 7, char('a' + i)));
+
+            uint8_t framed[Connection::MaxPayloadSize];
+            const auto size = sender.Encode((const uint8_t*)payloads.back().data(), payloads.back().size(), framed);
+            REQUIRE(size == payloads.back().size() + ForwardErrorCorrection::HeaderSize);
+
+            wire.push_back(Packet{ std::vector<uint8_t>(framed, framed + size) });
+            sender.Flush([&wire](const uint8_t* apData, size_t aLength) { wire.push_back(Packet{ std::vector<uint8_t>(apData, apData + aLength) }); });
+        }
+
+        sender.Flush([&wire](const uint8_t* apData, size_t aLength) { wire.push_back(Packet{ std::vector<uint8_t>(apData, apData + aLength) }); }, true);
+
+        REQUIRE(wire.size() == count + acConfig.ParityCount);
+
+        std::vector<std::string> received;
+        for (size_t i = 0; i < wire.size(); ++i)
+        {
+            if (std::find(aLost.begin(), aLost.end(), i) != aLost.end())
+                continue;
+
+            const auto& packet = wire[i].Data;
+            auto recovered = [&received](const uint8_t* apData, size_t aLength) { received.emplace_back((const char*)apData, aLength); };
+
+            if (receiver.Decode(packet.data(), packet.size(), recovered))
+                received.emplace_back((const char*)packet.data() + ForwardErrorCorrection::HeaderSize, packet.size() - ForwardErrorCorrection::HeaderSize);
+
+            // Duplicates are dropped
+            REQUIRE(receiver.Decode(packet.data(), packet.size(), recovered) == false);
+        }
+
+        std::sort(received.begin(), received.end());
+        REQUIRE(received == payloads);
+    };
+
+    GIVEN("Xor parity")
+    {
+        ForwardErrorCorrection::Config config{ ForwardErrorCorrection::kXor, 4, 1 };
+        REQUIRE(ForwardErrorCorrection::IsValid(config));
+        REQUIRE(ForwardErrorCorrection::IsValid({ ForwardErrorCorrection::kXor, 4, 2 }) == false);
+
+        run(config, {});
+        run(config, { 0 });
+        run(config, { 3 });
+        run(config, { 4 });
+    }
+
+    GIVEN("Reed-Solomon parity")
+    {
+        ForwardErrorCorrection::Config config{ ForwardErrorCorrection::kReedSolomon, 8, 3 };
+        REQUIRE(ForwardErrorCorrection::IsValid(config));
+
+        run(config, { 1 });
+        run(config, { 0, 7 });
+        run(config, { 2, 3, 4 });
+        run(config, { 5, 8, 10 });
+    }
+
+    GIVEN("Groups closed before they are full")
+    {
+        run({ ForwardErrorCorrection::kXor, 4, 1 }, { 0 }, 2);
+        run({ ForwardErrorCorrection::kXor, 4, 1 }, { 1 }, 1);
+        run({ ForwardErrorCorrection::kReedSolomon, 8, 3 }, { 1, 3 }, 5);
+        run({ ForwardErrorCorrection::kReedSolomon, 8, 3 }, { 0, 2, 6 }, 3);
+
+        // Nothing to protect, nothing is sent
+        ForwardErrorCorrection sender({ ForwardErrorCorrection::kXor, 4, 1 }, Connection::MaxPayloadSize);
+        size_t parityCount = 0;
+        sender.Flush([&parityCount](const uint8_t*, size_t) { ++parityCount; }, true);
+        REQUIRE(parityCount == 0);
+
+        // Only a group that stayed idle for a whole call is closed
+        uint8_t framed[Connection::MaxPayloadSize];
+        const uint8_t input[3] = { 1, 2, 3 };
+        sender.Encode(input, sizeof(input), framed);
+        sender.FlushIdle([&parityCount](const uint8_t*, size_t) { ++parityCount; });
+        REQUIRE(parityCount == 0);
+        sender.FlushIdle([&parityCount](const uint8_t*, size_t) { ++parityCount; });
+        REQUIRE(parityCount == 1);
+        sender.FlushIdle([&parityCount](const uint8_t*, size_t) { ++parityCount; });
+        REQUIRE(parityCount == 1);
+    }
+
+    GIVEN("Data that arrives after its group left the window")
+    {
+        ForwardErrorCorrection::Config config{ ForwardErrorCorrection::kXor, 4, 1 };
+        ForwardErrorCorrection sender(config, Connection::MaxPayloadSize);
+        ForwardErrorCorrection receiver(config, Connection::MaxPayloadSize);
+
+        std::vector<Packet> wire;
+        for (uint8_t i = 0; i < 4 * (ForwardErrorCorrection::MaxGroupsInFlight + 1); ++i)
+        {
+            uint8_t framed[Connection::MaxPayloadSize];
+            const uint8_t input[3] = { i, i, i };
+            const auto size = sender.Encode(input, sizeof(input), framed);
+            wire.push_back(Packet{ std::vector<uint8_t>(framed, framed + size) });
+            sender.Flush([](const uint8_t*, size_t) {});
+        }
+
+        auto ignore = [](const uint8_t*, size_t) {};
+        for (size_t i = 4; i < wire.size(); ++i)
+            REQUIRE(receiver.Decode(wire[i].Data.data(), wire[i].Data.size(), ignore));
+
+        // The first group is gone but its packets are intact
+        for (size_t i = 0; i < 4; ++i)
+            REQUIRE(receiver.Decode(wire[i].Data.data(), wire[i].Data.size(), ignore));
+    }
+
+    GIVEN("Two connections losing packets on a protected channel")
+    {
+        LoopbackCommunication firstEnd(Endpoint{ "127.0.0.3:1" }, true);
+        LoopbackCommunication secondEnd(Endpoint{ "127.0.0.3:2" }, true);
+        firstEnd.Link(secondEnd);
+
+        Connection first(firstEnd, secondEnd.GetLocalEndpoint());
+        Connection second(secondEnd, firstEnd.GetLocalEndpoint());
+
+        first.Update(Clock::Tick());
+        REQUIRE(second.ProcessPacket(std::move(secondEnd.Receive().GetResult().Payload)));
+        REQUIRE(first.ProcessPacket(std::move(firstEnd.Receive().GetResult().Payload)));
+        REQUIRE(first.IsConnected());
+        REQUIRE(second.IsConnected());
+
+        ForwardErrorCorrection::Config config{ ForwardErrorCorrection::kReedSolomon, 4, 2 };
+        REQUIRE(first.EnableForwardErrorCorrection(2, config));
+        REQUIRE(second.EnableForwardErrorCorrection(2, config));
+        REQUIRE(first.Send(2, nullptr, Connection::MaxPayloadSize) == false);
+
+        for (uint8_t i = 0; i < 4; ++i)
+        {
+            const uint8_t input[3] = { i, i, i };
+            REQUIRE(first.Send(2, input, sizeof(input)));
+        }
+
+        REQUIRE(secondEnd.GetQueuedCount() == 6);
+
+        for (size_t i = 0; i < 6; ++i)
+        {
+            auto packet = secondEnd.Receive();
+            if (i != 1 && i != 2)
+                REQUIRE(second.ProcessPacket(std::move(packet.GetResult().Payload)));
+        }
+
+        uint32_t seen = 0;
+        Connection::Message message;
+        while (second.Receive(message))
+        {
+            REQUIRE(message.Channel == 2);
+            REQUIRE(message.GetSize() == 3);
+            seen |= 1 << message.GetData()[0];
+        }
+
+        REQUIRE(seen == 0xF);
+
+        // A group the last packets left open is closed once the channel stays quiet for a tick
+        for (uint8_t i = 0; i < 2; ++i)
+        {
+            const uint8_t input[3] = { i, i, i };
+            REQUIRE(first.Send(2, input, sizeof(input)));
+        }
+
+        REQUIRE(secondEnd.GetQueuedCount() == 2);
+        first.Update(Clock::Tick());
+        REQUIRE(secondEnd.GetQueuedCount() == 2);
+        first.Update(Clock::Tick());
+        REQUIRE(secondEnd.GetQueuedCount() == 4);
+
+        for (size_t i = 0; i < 4; ++i)
+        {
+            auto packet = secondEnd.Receive();
+            if (i != 0)
+                REQUIRE(second.ProcessPacket(std::move(packet.GetResult().Payload)));
+        }
+
+        seen = 0;
+        while (second.Receive(message))
+            seen |= 1 << message.GetData()[0];
+
+        REQUIRE(seen == 0x3);
+    }
+}
+
+TEST_CASE("Bulk transfer", "[network.bulk]")
+{
+    LoopbackCommunication senderEnd(Endpoint{ "127.0.0.4:1" });
+    LoopbackCommunication receiverEnd(Endpoint{ "127.0.0.4:2" });
+    senderEnd.Link(receiverEnd);
+
+    Connection sender(senderEnd, receiverEnd.GetLocalEndpoint());
+    Connection receiver(receiverEnd, senderEnd.GetLocalEndpoint());
+
+    sender.Update(Clock::Tick());
+    REQUIRE(receiver.ProcessPacket(std::move(receiverEnd.Receive().GetResult().Payload)));
+    REQUIRE(sender.ProcessPacket(std::move(senderEnd.Receive().GetResult().Payload)));
+    REQUIRE(sender.IsConnected());
+
+    const std::string source = "dow_bulk_source.bin";
+    const std::string destination = "dow_bulk_destination.bin";
+
+    std::vector<uint8_t> data(3 * 1024 * 1024 + 17);
+    for (size_t i = 0; i < data.size(); ++i)
+        data[i] = (uint8_t)(i * 2654435761u >> 13);
+
+    {
+        MappedFile file;
+        REQUIRE(file.Create(source, data.size()));
+        std::copy(data.begin(), data.end(), file.GetWriteData());
+    }
+
+#ifdef __linux__
+    {
+        // A file limit stands in for a full disk, the failure shows up here rather than as a fault when writing
+        rlimit previous;
+        getrlimit(RLIMIT_FSIZE, &previous);
+        rlimit limit = previous;
+        limit.rlim_cur = 1024 * 1024;
+        setrlimit(RLIMIT_FSIZE, &limit);
+        auto handler = signal(SIGXFSZ, SIG_IGN);
+
+        MappedFile file;
+        REQUIRE(file.Create(destination, 4 * 1024 * 1024) == false);
+        REQUIRE(file.IsValid() == false);
+        REQUIRE(access(destination.c_str(), F_OK) != 0);
+
+        signal(SIGXFSZ, handler);
+        setrlimit(RLIMIT_FSIZE, &previous);
+    }
+#endif
+
+    BulkSender upload(5, 42);
+    BulkReceiver download(5, destination, data.size());
+    REQUIRE(upload.Open(source));
+    REQUIRE(upload.GetFragmentCount() == (data.size() + BulkTransfer::FragmentSize - 1) / BulkTransfer::FragmentSize);
+
+    // One packet in 40 is lost, acks included
+    size_t packetCount = 0;
+    auto deliver = [&packetCount](LoopbackCommunication& aEnd, Connection& aConnection)
+    {
+        while (aEnd.IsReady())
+        {
+            auto packet = aEnd.Receive();
+            if (++packetCount % 40 != 0)
+                aConnection.ProcessPacket(std::move(packet.GetResult().Payload));
+        }
+    };
+
+    size_t realTimeSent = 0, realTimeReceived = 0;
+    for (int i = 0; i < 10000 && !(upload.IsComplete() && download.IsComplete()); ++i)
+    {
+        REQUIRE(sender.Send(0, (const uint8_t*)&i, sizeof(i)));
+        ++realTimeSent;
+
+        upload.Update(sender, 256);
+
+        deliver(receiverEnd, receiver);
+
+        Connection::Message message;
+        while (receiver.Receive(message))
+        {
+            if (message.Channel == 0)
+                ++realTimeReceived;
+            else
+                REQUIRE(download.Process(receiver, message));
+        }
+
+        download.Flush(receiver);
+
+        deliver(senderEnd, sender);
+        while (sender.Receive(message))
+            REQUIRE(upload.Process(message));
+
+        // Let the timeouts expire once in a while so lost tails are resent
+        if (i % 50 == 49)
+            std::this_thread::sleep_for(std::chrono::milliseconds(110));
+    }
+
+    REQUIRE(upload.IsComplete());
+    REQUIRE(download.IsComplete());
+    REQUIRE(upload.GetRetransmitCount() > 0);
+    REQUIRE(download.GetSize() == data.size());
+    REQUIRE(std::memcmp(download.GetData(), data.data(), data.size()) == 0);
+
+    // The transfer never held back the other channels, only the simulated losses did
+    REQUIRE(realTimeReceived >= realTimeSent - realTimeSent / 20);
+
+    // A peer announcing more than the receiver accepts never gets a file created
+    BulkReceiver bounded(5, "dow_bulk_bounded.bin", data.size() - 1);
+    Buffer fragment(BulkTransfer::HeaderSize + 1);
+    auto* pFragment = fragment.GetWriteData();
+    pFragment[0] = BulkTransfer::kFragment;
+    for (size_t i = 1; i < BulkTransfer::HeaderSize; ++i)
+        pFragment[i] = 0;
+    for (size_t i = 0; i < 6; ++i)
+        pFragment[7 + i] = (uint8_t)(data.size() >> (i * 8));
+
+    Connection::Message announce{ 5, std::move(fragment), 0, BulkTransfer::HeaderSize + 1 };
+    REQUIRE_FALSE(bounded.Process(receiver, announce));
+    REQUIRE(bounded.GetSize() == 0);
+
+    std::remove(source.c_str());
+    std::remove(destination.c_str());
+}
+
+TEST_CASE("Bulk transfer through the send slab", "[network.bulk]")
+{
+    UdpCommunication senderEnd, receiverEnd;
+    Endpoint senderEndpoint{ "127.0.0.1" }, receiverEndpoint{ "127.0.0.1" };
+    senderEndpoint.SetPort(senderEnd.Listener.GetPort());
+    receiverEndpoint.SetPort(receiverEnd.Listener.GetPort());
+
+    Connection sender(senderEnd, receiverEndpoint);
+    Connection receiver(receiverEnd, senderEndpoint);
+
+    for (int i = 0; i < 100 && !(sender.IsConnected() && receiver.IsConnected()); ++i)
+    {
+        sender.Update(Clock::Tick());
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        receiverEnd.Drain(receiver);
+        senderEnd.Drain(sender);
+    }
+
+    REQUIRE(sender.IsConnected());
+
+    std::vector<uint8_t> data(256 * 1024 + 5);
+    for (size_t i = 0; i < data.size(); ++i)
+        data[i] = (uint8_t)(i * 2654435761u >> 13);
+
+    BulkSender upload(5, 7);
+    BulkReceiver download(5, "dow_bulk_slab.bin", data.size());
+    upload.Attach(data.data(), data.size());
+
+    const auto sentBefore = sender.GetStatistics().SentPackets;
+    const auto start = Clock::GetTimestamp();
+    while (!download.IsComplete() && Clock::GetTimestamp() - start < Clock::Seconds(10))
+    {
+        upload.Update(sender, senderEnd.Listener, 32);
+        senderEnd.Listener.Flush();
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        receiverEnd.Drain(receiver);
+
+        Connection::Message message;
+        while (receiver.Receive(message))
+            download.Process(receiver, message);
+
+        download.Flush(receiver);
+
+        senderEnd.Drain(sender);
+        while (sender.Receive(message))
+            upload.Process(message);
+    }
+
+    REQUIRE(download.IsComplete());
+    REQUIRE(std::memcmp(download.GetData(), data.data(), data.size()) == 0);
+    REQUIRE(sender.GetStatistics().SentPackets - sentBefore >= upload.GetFragmentCount());
+
+    std::remove("dow_bulk_slab.bin");
+}
+
+TEST_CASE("Bulk transfer over loopback UDP", "[network.bulk][.benchmark]")
+{
+    UdpCommunication senderEnd, receiverEnd;
+    Endpoint senderEndpoint{ "127.0.0.1" }, receiverEndpoint{ "127.0.0.1" };
+    senderEndpoint.SetPort(senderEnd.Listener.GetPort());
+    receiverEndpoint.SetPort(receiverEnd.Listener.GetPort());
+
+    Connection sender(senderEnd, receiverEndpoint);
+    Connection receiver(receiverEnd, senderEndpoint);
+
+    for (int i = 0; i < 100 && !(sender.IsConnected() && receiver.IsConnected()); ++i)
+    {
+        sender.Update(Clock::Tick());
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        receiverEnd.Drain(receiver);
+        senderEnd.Drain(sender);
+    }
+
+    REQUIRE(sender.IsConnected());
+
+    std::vector<uint8_t> data(50 * 1024 * 1024);
+    for (size_t i = 0; i < data.size(); ++i)
+        data[i] = (uint8_t)i;
+
+    BulkSender upload(5, 1);
+    BulkReceiver download(5, "dow_bulk_benchmark.bin", data.size());
+    upload.Attach(data.data(), data.size());
+
+    const auto start = Clock::GetTimestamp();
+    while (!upload.IsComplete() && Clock::GetTimestamp() - start < Clock::Seconds(60))
+    {
+        upload.Update(sender, senderEnd.Listener, 64);
+        senderEnd.Listener.Flush();
+
+        receiverEnd.Drain(receiver);
+
+        Connection::Message message;
+        while (receiver.Receive(message))
+            download.Process(receiver, message);
+
+        download.Flush(receiver);
+
+        senderEnd.Drain(sender);
+        while (sender.Receive(message))
+            upload.Process(message);
+    }
+
+    const auto elapsed = Clock::GetTimestamp() - start;
+    REQUIRE(download.IsComplete());
+    REQUIRE(std::memcmp(download.GetData(), data.data(), data.size()) == 0);
+
+    WARN("Bulk transfer: " << (data.size() * 8.0) / (elapsed / 1000.0) << " Mbit/s, " << upload.GetRetransmitCount() << " retransmits");
+
+    std::remove("dow_bulk_benchmark.bin");
+}
+
+TEST_CASE("Shared memory communication", "[network.sharedmemory]")
+{
+    Endpoint remoteEndpoint{ "127.0.0.1:12345" };
+    const std::string name = "dow_shm_test_" + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()));
+
+    SharedMemoryCommunication host(remoteEndpoint), peer(remoteEndpoint);
+    REQUIRE(peer.Open(name) == false);
+    REQUIRE(host.Create(name, 1 << 16));
+    REQUIRE(peer.Open(name));
+
+    GIVEN("Raw packets")
+    {
+        Buffer buffer(100);
+        buffer[0] = 42;
+
+        REQUIRE(host.Receive().HasError());
+        REQUIRE(host.Send(remoteEndpoint, buffer));
+        REQUIRE(peer.Wait(0));
+
+        auto result = peer.Receive();
+        REQUIRE(result.HasError() == false);
+        REQUIRE(result.GetResult().Payload.GetSize() == 100);
+        REQUIRE(result.GetResult().Payload[0] == 42);
+        REQUIRE(result.GetResult().Remote == remoteEndpoint);
+
+        // Wake up a sleeping peer
+        auto received = std::async(std::launch::async, [&host]() { return host.Wait(1000 * 1000); });
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        REQUIRE(peer.Send(remoteEndpoint, buffer));
+        REQUIRE(received.get());
+    }
+
+    GIVEN("A name created again while a peer still maps it")
+    {
+        Buffer buffer(10);
+        REQUIRE(host.Send(remoteEndpoint, buffer));
+
+        // The old segment is left untouched for the peer, the new owner starts from a fresh one
+        SharedMemoryCommunication replacement(remoteEndpoint), late(remoteEndpoint);
+        REQUIRE(replacement.Create(name, 1 << 16));
+        REQUIRE(peer.Receive().HasError() == false);
+        REQUIRE(late.Open(name));
+        REQUIRE(late.Receive().HasError());
+    }
+
+    GIVEN("A negotiation between two connections")
+    {
+        Connection client(host, remoteEndpoint);
+        Connection server(peer, remoteEndpoint);
+
+        client.Update(Clock::Tick());
+
+        auto result = peer.Receive();
+        REQUIRE(result.HasError() == false);
+        REQUIRE(server.ProcessNegociation(&result.GetResult().Payload));
+    }
+}
+
+TEST_CASE("Loopback communication", "[network.loopback]")
+{
+    Server server;
+    REQUIRE(server.Start(0));
+
+    auto trusted = GENERATE(false, true);
+
+    LoopbackCommunication clientEnd(Endpoint{ "127.0.0.2:1" }, trusted);
+    LoopbackCommunication serverEnd(Endpoint{ "127.0.0.2:2" }, trusted);
+    clientEnd.Link(serverEnd);
+    server.Attach(serverEnd);
+
+    GIVEN("Raw buffers")
+    {
+        Buffer buffer(100);
+        auto* pData = buffer.GetData();
+
+        REQUIRE(clientEnd.Send(serverEnd.GetLocalEndpoint(), std::move(buffer)));
+
+        auto result = serverEnd.Receive();
+        REQUIRE(result.HasError() == false);
+        REQUIRE(result.GetResult().Remote == clientEnd.GetLocalEndpoint());
+        // Ownership moved, nothing was copied
+        REQUIRE(result.GetResult().Payload.GetData() == pData);
+        REQUIRE(serverEnd.Receive().HasError());
+    }
+
+    GIVEN("A client connection talking to the server")
+    {
+        Connection client(clientEnd, serverEnd.GetLocalEndpoint());
+        client.Update(Clock::Tick());
+
+        REQUIRE(server.Update() == 1);
+        REQUIRE(server.GetConnectionCount() == 1);
+
+        auto* pRemote = server.GetConnection(clientEnd.GetLocalEndpoint());
+        REQUIRE(pRemote != nullptr);
+        REQUIRE(pRemote->IsConnected());
+
+        auto reply = clientEnd.Receive();
+        REQUIRE(reply.HasError() == false);
+        REQUIRE(client.ProcessPacket(std::move(reply.GetResult().Payload)));
+        REQUIRE(client.IsConnected());
+
+        const std::string data = "abcdefghijklmnopqrstuvwxyz";
+        REQUIRE(client.Send(3, (const uint8_t*)data.data(), data.size()));
+        REQUIRE(server.Update() == 1);
+
+        Connection::Message message;
+        REQUIRE(pRemote->Receive(message));
+        REQUIRE(message.Channel == 3);
+        REQUIRE(message.GetSize() == data.size());
+        REQUIRE(std::memcmp(message.GetData(), data.data(), data.size()) == 0);
+        REQUIRE(pRemote->Receive(message) == false);
+
+        REQUIRE(pRemote->Send(1, (const uint8_t*)data.data(), 5));
+        reply = clientEnd.Receive();
+        REQUIRE(client.ProcessPacket(std::move(reply.GetResult().Payload)));
+        REQUIRE(client.Receive(message));
+        REQUIRE(message.Channel == 1);
+        REQUIRE(std::memcmp(message.GetData(), data.data(), 5) == 0);
+
+        // The reply echoed the client's send time, both ends share the same clock
+        REQUIRE(client.GetClockSync().HasEstimate());
+        REQUIRE(pRemote->GetClockSync().HasEstimate() == false);
+        REQUIRE(std::abs(client.GetClockOffset()) <= int64_t(client.GetClockError() + Clock::Microseconds(2)));
+    }
+
+    GIVEN("An in-process peer that goes away")
+    {
+        auto pPeerEnd = std::make_unique<LoopbackCommunication>(Endpoint{ "127.0.0.2:3" }, trusted);
+        auto pLocalEnd = std::make_unique<LoopbackCommunication>(Endpoint{ "127.0.0.2:4" }, trusted);
+        pPeerEnd->Link(*pLocalEnd);
+        server.Attach(*pLocalEnd);
+
+        Connection peer(*pPeerEnd, pLocalEnd->GetLocalEndpoint());
+        peer.Update(Clock::Tick());
+        REQUIRE(server.Update() == 1);
+
+        auto* pRemote = server.GetConnection(pPeerEnd->GetLocalEndpoint());
+        REQUIRE(pRemote != nullptr);
+        REQUIRE(pRemote->IsConnected());
+
+        // The connection no longer reaches the destroyed communication
+        server.Detach(*pLocalEnd);
+        pLocalEnd.reset();
+        REQUIRE(pRemote->GetState() == Connection::kNone);
+
+        const uint8_t data[5] = {};
+        REQUIRE(server.Broadcast(1, data, sizeof(data)) == 0);
+        REQUIRE(pRemote->Send(1, data, sizeof(data)) == false);
+        server.Update();
+    }
+
+    server.Detach(serverEnd);
+}
+
+TEST_CASE("Shared memory against loopback UDP", "[network.sharedmemory][.benchmark]")
+{
+    InitializeNetwork();
+
+    constexpr auto kRoundTrips = 100000;
+    Buffer buffer(64);
+
+    Endpoint remoteEndpoint{ "127.0.0.1:12345" };
+    SharedMemoryCommunication host(remoteEndpoint), peer(remoteEndpoint);
+    REQUIRE(host.Create("dow_shm_benchmark"));
+    REQUIRE(peer.Open("dow_shm_benchmark"));
+
+    auto echo = std::async(std::launch::async, [&]()
+    {
+        for (auto i = 0; i < kRoundTrips; ++i)
+        {
+            while (!peer.Wait(1000 * 1000)) {}
+            auto result = peer.Receive();
+            peer.Send(remoteEndpoint, std::move(result.GetResult().Payload));
+        }
+    });
+
+    auto start = std::chrono::steady_clock::now();
+    for (auto i = 0; i < kRoundTrips; ++i)
+    {
+        host.Send(remoteEndpoint, buffer);
+        while (!host.Wait(1000 * 1000)) {}
+        host.Receive();
+    }
+    auto sharedMemoryTime = std::chrono::steady_clock::now() - start;
+    echo.get();
+
+    Socket client(Endpoint::kIPv4), server(Endpoint::kIPv4);
+    REQUIRE(client.Bind());
+    REQUIRE(server.Bind());
+
+    Endpoint serverEndpoint{ "127.0.0.1" };
+    serverEndpoint.SetPort(server.GetPort());
+
+    auto udpEcho = std::async(std::launch::async, [&]()
+    {
+        for (auto i = 0; i < kRoundTrips; ++i)
+        {
+            auto result = server.Receive();
+            server.Send(result.GetResult());
+        }
+    });
+
+    Socket::Packet packet{ serverEndpoint, buffer };
+
+    start = std::chrono::steady_clock::now();
+    for (auto i = 0; i < kRoundTrips; ++i)
+    {
+        client.Send(packet);
+        client.Receive();
+    }
+    auto udpTime = std::chrono::steady_clock::now() - start;
+    udpEcho.get();
+
+    using namespace std::chrono;
+    WARN("Round trip shared memory: " << duration_cast<nanoseconds>(sharedMemoryTime).count() / kRoundTrips << "ns");
+    WARN("Round trip loopback UDP: " << duration_cast<nanoseconds>(udpTime).count() / kRoundTrips << "ns");
+}
+
+TEST_CASE("Server", "[network.server]")
+{
+    GIVEN("A client server model")
+    {
+        Buffer buffer(100);
+
+        Server server;
+        REQUIRE(server.Start(0));
+        REQUIRE(server.GetPort() != 0);
+
+        Endpoint serverEndpoint{ "127.0.0.1" };
+
+        serverEndpoint.SetPort(server.GetPort());
+
+        Socket client(Endpoint::kIPv4);
+        client.Bind();
+
+        Socket::Packet packet{ serverEndpoint, buffer };
+    }
+
+    GIVEN("A server with a packet budget")
+    {
+        Buffer buffer(100);
+
+        Server server;
+        REQUIRE(server.Start(0));
+
+        Server::Budget budget;
+        budget.MaxPackets = 3;
+        server.SetBudget(budget);
+
+        Endpoint serverEndpoint{ "127.0.0.1" };
+        serverEndpoint.SetPort(server.GetPort());
+
+        Socket established(Endpoint::kIPv4), newcomer(Endpoint::kIPv4);
+        established.Bind();
+        newcomer.Bind();
+
+        Socket::Packet packet{ serverEndpoint, buffer };
+        for (auto i = 0; i < 10; ++i)
+            REQUIRE(established.Send(packet));
+
+        REQUIRE(server.Update() == 3);
+        REQUIRE(server.GetWorkReport().Backlogged);
+        REQUIRE(server.GetWorkReport().QueuedBytes > 0);
+
+        REQUIRE(newcomer.Send(packet));
+
+        REQUIRE(server.Update() == 3);
+        REQUIRE(server.Update() == 3);
+        REQUIRE(server.GetWorkReport().Backlogged);
+
+        // The last packet of the established peer goes through, the newcomer is shed
+        REQUIRE(server.Update() == 1);
+        REQUIRE(server.GetWorkReport().ShedPackets == 1);
+        REQUIRE(server.GetWorkReport().Backlogged == false);
+        REQUIRE(server.GetConnectionCount() == 1);
+
+        // Once the backlog is cleared new peers are accepted again
+        REQUIRE(newcomer.Send(packet));
+        REQUIRE(server.Update() == 1);
+        REQUIRE(server.GetConnectionCount() == 2);
+    }
+
+    GIVEN("A server handing off to its successor")
+    {
+        Buffer buffer(100);
+
+        Server server;
+        REQUIRE(server.Start(0));
+
+        const std::string path = "/tmp/dow_handoff_" + std::to_string(server.GetPort());
+        REQUIRE(server.EnableHandoff(path));
+
+#ifdef __linux__
+        // Only the owner can connect and receive the sockets and keys
+        struct stat info;
+        REQUIRE(stat(path.c_str(), &info) == 0);
+        REQUIRE((info.st_mode & 0777) == 0600);
+#endif
+
+        Endpoint serverEndpoint{ "127.0.0.1" };
+        serverEndpoint.SetPort(server.GetPort());
+
+        Socket client(Endpoint::kIPv4);
+        client.Bind();
+
+        Socket::Packet packet{ serverEndpoint, buffer };
+
+        REQUIRE(client.Send(packet));
+        REQUIRE(server.Update() == 1);
+        REQUIRE(server.GetConnectionCount() == 1);
+
+        Server successor;
+        auto resumed = std::async(std::launch::async, [&successor, &path]() { return successor.Resume(path); });
+
+        for (auto i = 0; i < 1000 && !server.IsHandedOff(); ++i)
+        {
+            server.Update();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        REQUIRE(server.IsHandedOff());
+        REQUIRE(resumed.get());
+
+        REQUIRE(successor.GetPort() == server.GetPort());
+        REQUIRE(successor.GetConnectionCount() == 1);
+
+        // The old process no longer reads, traffic lands in the successor
+        REQUIRE(client.Send(packet));
+        REQUIRE(server.Update() == 0);
+        REQUIRE(successor.Update() == 1);
+        REQUIRE(successor.GetConnectionCount() == 1);
+    }
+
+    GIVEN("A handover that includes a timed out peer")
+    {
+        LoopbackCommunication communication(Endpoint{ "127.0.0.3:1" });
+
+        ConnectionManager predecessor(4);
+        predecessor.Add(Connection(communication, Endpoint{ "127.0.0.3:2" }));
+        predecessor.Add(Connection(communication, Endpoint{ "127.0.0.3:3" }));
+
+        auto* pTimedOut = predecessor.Find(Endpoint{ "127.0.0.3:3" });
+        pTimedOut->Update(Clock::GetNow() + Connection::Timeout);
+        REQUIRE(pTimedOut->GetState() == Connection::kNone);
+
+        Buffer state(4 + 2 * Connection::MaxSerializedSize);
+        Buffer::Writer writer(&state);
+        REQUIRE(predecessor.Save(writer));
+
+        ConnectionManager successor(4);
+        Buffer::Reader reader(&state);
+        REQUIRE(successor.Load(reader, communication));
+        REQUIRE(successor.GetCount() == 1);
+        REQUIRE(successor.Find(Endpoint{ "127.0.0.3:2" }) != nullptr);
+        REQUIRE(successor.Find(Endpoint{ "127.0.0.3:3" }) == nullptr);
+    }
+
+    GIVEN("A successor planned for fewer peers than it inherits")
+    {
+        constexpr size_t PeerCount = 70;
+
+        Server::CapacityPlan plan;
+        plan.MaxConnections = 80;
+
+        Server server;
+        REQUIRE(server.Start(0, plan));
+
+        const std::string path = "/tmp/dow_handoff_" + std::to_string(server.GetPort());
+        REQUIRE(server.EnableHandoff(path));
+
+        Endpoint serverEndpoint{ "127.0.0.1" };
+        serverEndpoint.SetPort(server.GetPort());
+
+        Buffer buffer(100);
+        Socket::Packet packet{ serverEndpoint, buffer };
+
+        // Sockets allow port reuse so two of them can land on the same port, which would be a single peer
+        std::vector<std::unique_ptr<Socket>> clients;
+        std::set<uint16_t> ports;
+        while (clients.size() < PeerCount)
+        {
+            auto pClient = std::make_unique<Socket>(Endpoint::kIPv4);
+            REQUIRE(pClient->Bind());
+            if (ports.insert(pClient->GetPort()).second)
+                clients.push_back(std::move(pClient));
+        }
+
+        // Resent until every peer is known, datagrams from known peers only refresh their connection
+        for (int i = 0; i < 100 && server.GetConnectionCount() < PeerCount; ++i)
+        {
+            for (auto& pClient : clients)
+                pClient->Send(packet);
+
+            server.Wait(Clock::Milliseconds(10));
+            server.Update();
+        }
+        REQUIRE(server.GetConnectionCount() == PeerCount);
+
+        Server::CapacityPlan successorPlan;
+        successorPlan.MaxConnections = 2;
+
+        Server successor;
+        auto resumed = std::async(std::launch::async, [&successor, &path, &successorPlan]() { return successor.Resume(path, successorPlan); });
+
+        for (auto i = 0; i < 1000 && !server.IsHandedOff(); ++i)
+        {
+            server.Update();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        REQUIRE(server.IsHandedOff());
+        REQUIRE(resumed.get());
+        REQUIRE(successor.GetConnectionCount() == PeerCount);
+
+        // Every inherited connection takes its receive queue from the pool
+        REQUIRE(successor.GetPacketPool() != nullptr);
+        REQUIRE(successor.GetPacketPool()->GetFreeCount() + PeerCount <= successor.GetPacketPool()->GetBlockCount());
+    }
+}
+
+TEST_CASE("Broadcast", "[network.broadcast]")
+{
+    Server server;
+    REQUIRE(server.Start(0));
+
+    struct Peer
+    {
+        Peer(Endpoint::Type aType, const Endpoint& acServer)
+            : Communication(aType)
+            , Client(Communication, acServer)
+        {}
+
+        UdpCommunication Communication;
+        Connection Client;
+    };
+
+    Endpoint serverv4{ "127.0.0.1" }, serverv6{ "[::1]" };
+    serverv4.SetPort(server.GetPort());
+    serverv6.SetPort(server.GetPort());
+
+    // Sockets allow address reuse, a peer landing on a port another one already holds would share its connection
+    std::vector<std::unique_ptr<Peer>> peers;
+    std::set<std::pair<Endpoint::Type, uint16_t>> ports;
+    while (peers.size() < 20)
+    {
+        const auto type = peers.size() % 4 == 3 ? Endpoint::kIPv6 : Endpoint::kIPv4;
+        auto pPeer = std::make_unique<Peer>(type, type == Endpoint::kIPv6 ? serverv6 : serverv4);
+        if (ports.emplace(type, pPeer->Communication.Listener.GetPort()).second)
+            peers.push_back(std::move(pPeer));
+    }
+
+    LoopbackCommunication loopbackEnd(Endpoint{ "127.0.0.5:1" });
+    LoopbackCommunication serverEnd(Endpoint{ "127.0.0.5:2" });
+    loopbackEnd.Link(serverEnd);
+    server.Attach(serverEnd);
+    Connection loopbackClient(loopbackEnd, serverEnd.GetLocalEndpoint());
+
+    auto drain = [&]()
+    {
+        for (auto& pPeer : peers)
+            pPeer->Communication.Drain(pPeer->Client);
+
+        while (loopbackEnd.IsReady())
+            loopbackClient.ProcessPacket(std::move(loopbackEnd.Receive().GetResult().Payload));
+    };
+
+    for (auto& pPeer : peers)
+        pPeer->Client.Update(Clock::Tick());
+    loopbackClient.Update(Clock::Tick());
+
+    for (int i = 0; i < 100 && server.GetConnectionCount() < peers.size() + 1; ++i)
+    {
+        server.Wait(Clock::Milliseconds(10));
+        server.Update();
+    }
+
+    REQUIRE(server.GetConnectionCount() == peers.size() + 1);
+
+    bool connected = false;
+    for (int i = 0; i < 100 && !connected; ++i)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        drain();
+
+        connected = loopbackClient.IsConnected();
+        for (auto& pPeer : peers)
+            connected &= pPeer->Client.IsConnected();
+    }
+
+    REQUIRE(connected);
+
+    const std::string event = "The dragon has been slain";
+
+    REQUIRE(server.Broadcast(2, (const uint8_t*)event.data(), event.size()) == peers.size() + 1);
+    REQUIRE(server.Broadcast(2, (const uint8_t*)event.data(), 3, [](const Connection& acConnection) { return acConnection.GetRemoteEndpoint().IsIPv6(); }) == 5);
+
+    size_t full = 0, partial = 0;
+    for (int i = 0; i < 100 && full + partial < peers.size() + 1 + 5; ++i)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        drain();
+
+        auto collect = [&](Connection& aConnection)
+        {
+            Connection::Message message;
+            while (aConnection.Receive(message))
+            {
+                REQUIRE(message.Channel == 2);
+                REQUIRE(std::memcmp(message.GetData(), event.data(), message.GetSize()) == 0);
+
+                if (message.GetSize() == event.size())
+                    ++full;
+                else if (message.GetSize() == 3)
+                    ++partial;
+            }
+        };
+
+        for (auto& pPeer : peers)
+            collect(pPeer->Client);
+
+        collect(loopbackClient);
+    }
+
+    REQUIRE(full == peers.size() + 1);
+    REQUIRE(partial == 5);
+
+    server.Detach(serverEnd);
+}
+
+TEST_CASE("Interest grid", "[network.interest]")
+{
+    InterestGrid grid(0.f, 0.f, 1000.f, 1000.f, 50.f);
+
+    // One entity every 10 units on the diagonal, plus some outside of the grid
+    for (uint32_t i = 0; i < 100; ++i)
+        grid.Add(i, i * 10.f, i * 10.f);
+    grid.Add(1000, -500.f, -500.f);
+    grid.Add(1001, 5000.f, 5000.f);
+    grid.Build();
+
+    REQUIRE(grid.GetEntityCount() == 102);
+    REQUIRE(grid.GetCellCount() == 400);
+
+    GIVEN("A query")
+    {
+        std::vector<uint32_t> ids;
+        grid.Query(100.f, 100.f, 15.f, [&ids](uint32_t aId) { ids.push_back(aId); });
+        std::sort(ids.begin(), ids.end());
+        REQUIRE(ids == std::vector<uint32_t>{9, 10, 11});
+
+        ids.clear();
+        grid.Query(-500.f, -500.f, 1.f, [&ids](uint32_t aId) { ids.push_back(aId); });
+        REQUIRE(ids == std::vector<uint32_t>{1000});
+    }
+    GIVEN("A moving view")
+    {
+        InterestGrid::View view;
+        view.X = 100.f;
+        view.Y = 100.f;
+        view.Radius = 15.f;
+
+        grid.Update(view);
+        REQUIRE(view.Visible == std::vector<uint32_t>{9, 10, 11});
+        REQUIRE(view.Entered == std::vector<uint32_t>{9, 10, 11});
+        REQUIRE(view.Left.empty());
+
+        grid.Update(view);
+        REQUIRE(view.Entered.empty());
+        REQUIRE(view.Left.empty());
+
+        view.X = view.Y = 120.f;
+        grid.Update(view);
+        REQUIRE(view.Visible == std::vector<uint32_t>{11, 12, 13});
+        REQUIRE(view.Entered == std::vector<uint32_t>{12, 13});
+        REQUIRE(view.Left == std::vector<uint32_t>{9, 10});
+
+        // Entities move between ticks
+        grid.Clear();
+        for (uint32_t i = 0; i < 100; ++i)
+            grid.Add(i, i * 10.f + 5.f, i * 10.f + 5.f);
+        grid.Build();
+
+        grid.Update(view);
+        REQUIRE(view.Visible == std::vector<uint32_t>{11, 12});
+        REQUIRE(view.Entered.empty());
+        REQUIRE(view.Left == std::vector<uint32_t>{13});
+    }
+    GIVEN("A parallel build and update")
+    {
+        InterestGrid serial(-1000.f, -1000.f, 2000.f, 2000.f, 64.f);
+        InterestGrid parallel(-1000.f, -1000.f, 2000.f, 2000.f, 64.f);
+
+        uint32_t seed = 1;
+        for (uint32_t i = 0; i < 20000; ++i)
+        {
+            seed = seed * 1664525u + 1013904223u;
+            const auto x = (float)(seed >> 16) / 65536.f * 2200.f - 1100.f;
+            seed = seed * 1664525u + 1013904223u;
+            const auto y = (float)(seed >> 16) / 65536.f * 2200.f - 1100.f;
+
+            serial.Add(i, x, y);
+            parallel.Add(i, x, y);
+        }
+        serial.Build();
+        parallel.Build(4);
+
+        std::vector<InterestGrid::View> serialViews(64);
+        std::vector<InterestGrid::View> parallelViews(64);
+        for (size_t i = 0; i < serialViews.size(); ++i)
+        {
+            serialViews[i].X = parallelViews[i].X = (float)(i % 8) * 250.f - 1000.f;
+            serialViews[i].Y = parallelViews[i].Y = (float)(i / 8) * 250.f - 1000.f;
+            serialViews[i].Radius = parallelViews[i].Radius = 150.f;
+        }
+
+        for (auto& view : serialViews)
+            serial.Update(view);
+        parallel.Update(parallelViews.data(), parallelViews.size(), 4);
+
+        for (size_t i = 0; i < serialViews.size(); ++i)
+        {
+            REQUIRE(!serialViews[i].Visible.empty());
+            REQUIRE(serialViews[i].Visible == parallelViews[i].Visible);
+            REQUIRE(serialViews[i].Entered == parallelViews[i].Entered);
+        }
+
+        // The workers of the first call are reused
+        parallel.Build(4);
+        parallel.Update(parallelViews.data(), parallelViews.size(), 4);
+        for (size_t i = 0; i < serialViews.size(); ++i)
+        {
+            REQUIRE(serialViews[i].Visible == parallelViews[i].Visible);
+            REQUIRE(parallelViews[i].Entered.empty());
+        }
+    }
+    GIVEN("Positions far outside the grid")
+    {
+        InterestGrid far(0.f, 0.f, 1000.f, 1000.f, 50.f);
+        far.Add(0, 1e20f, -1e20f);
+        far.Add(1, std::numeric_limits<float>::quiet_NaN(), 10.f);
+        far.Add(2, std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity());
+        far.Add(3, 990.f, 990.f);
+        far.Build();
+
+        REQUIRE(far.GetEntityCount() == 4);
+
+        std::vector<uint32_t> ids;
+        far.Query(1e20f, 1e20f, 1.f, [&ids](uint32_t aId) { ids.push_back(aId); });
+        REQUIRE(ids.empty());
+
+        far.Query(995.f, 995.f, 10.f, [&ids](uint32_t aId) { ids.push_back(aId); });
+        REQUIRE(ids == std::vector<uint32_t>{3});
+    }
+}
+
+TEST_CASE("Replication", "[network.replication]")
+{
+    Replication server;
+    Replication client;
+
+    // Position x, y, a flag and a 64 bit id
+    for (auto* pReplication : { &server, &client })
+    {
+        REQUIRE(pReplication->RegisterType({ 20, 20, 1, 64 }) == 0);
+        REQUIRE(pReplication->RegisterType({ 8 }) == 1);
+    }
+    REQUIRE(server.RegisterType({ 0 }) == Replication::InvalidType);
+
+    Replication::Peer peer(server);
+
+    uint8_t data[Connection::MaxPayloadSize];
+
+    const auto transfer = [&](bool aDeliver = true)
+    {
+        Buffer::Writer writer(data, sizeof(data));
+        if (!server.Write(peer, writer))
+            return false;
+
+        if (aDeliver)
+        {
+            Buffer::Reader reader(data, (writer.GetBitPosition() + 7) / 8);
+            uint32_t sequence;
+            if (!client.Read(reader, sequence))
+                return false;
+
+            peer.Acknowledge(sequence);
+        }
+
+        return true;
+    };
+
+    const auto player = server.Create(0);
+    const auto item = server.Create(1);
+    server.Set(player, 0, 1000);
+    server.Set(player, 1, 0xFFFFFFFF);
+    server.Set(player, 3, 0x123456789ABCDEF0ull);
+    server.Set(item, 0, 7);
+
+    // Nothing is sent before the tick is committed
+    REQUIRE(transfer() == false);
+    server.Commit();
+    REQUIRE(transfer());
+    REQUIRE(!peer.HasPending());
+    REQUIRE(transfer() == false);
+
+    REQUIRE(client.GetObjectCount() == 2);
+    REQUIRE(client.GetType(player) == 0);
+    REQUIRE(client.Get(player, 0) == 1000);
+    REQUIRE(client.Get(player, 1) == 0xFFFFF);
+    REQUIRE(client.Get(player, 2) == 0);
+    REQUIRE(client.Get(player, 3) == 0x123456789ABCDEF0ull);
+    REQUIRE(client.Get(item, 0) == 7);
+
+    GIVEN("Changes")
+    {
+        // Setting the same value is not a change
+        server.Set(player, 0, 1000);
+        server.Commit();
+        REQUIRE(!peer.HasPending());
+
+        server.Set(player, 2, 1);
+        server.Commit();
+
+        Buffer::Writer writer(data, sizeof(data));
+        REQUIRE(server.Write(peer, writer));
+        // Sequence, one record with its 4 bits mask and the value, end marker
+        REQUIRE(writer.GetBitPosition() == 32 + 1 + 2 + 4 + 1 + 8 + 4 + 1 + 1);
+    }
+    GIVEN("Lost updates")
+    {
+        server.Set(player, 0, 1);
+        server.Commit();
+        REQUIRE(transfer(false));
+
+        server.Set(item, 0, 2);
+        server.Commit();
+        REQUIRE(transfer());
+
+        // The first update is resent once a later one is acknowledged
+        REQUIRE(client.Get(player, 0) == 1000);
+        REQUIRE(client.Get(item, 0) == 2);
+        REQUIRE(peer.HasPending());
+        REQUIRE(transfer());
+        REQUIRE(client.Get(player, 0) == 1);
+    }
+    GIVEN("Out of order updates")
+    {
+        server.Set(player, 0, 1);
+        server.Commit();
+
+        Buffer::Writer writer(data, sizeof(data));
+        REQUIRE(server.Write(peer, writer));
+        std::vector<uint8_t> late(data, data + (writer.GetBitPosition() + 7) / 8);
+
+        server.Set(player, 0, 2);
+        server.Commit();
+        REQUIRE(transfer());
+
+        Buffer::Reader reader(late.data(), late.size());
+        uint32_t sequence;
+        REQUIRE(client.Read(reader, sequence) == false);
+        REQUIRE(client.Get(player, 0) == 2);
+    }
+    GIVEN("Destroyed objects")
+    {
+        server.Destroy(item);
+        server.Commit();
+        REQUIRE(transfer());
+        REQUIRE(!client.IsAlive(item));
+        REQUIRE(client.GetObjectCount() == 1);
+
+        // The slot is reused, with a type that has more fields
+        REQUIRE(server.Create(0) == item);
+        server.Set(item, 3, 42);
+        server.Commit();
+        REQUIRE(transfer());
+        REQUIRE(client.GetType(item) == 0);
+        REQUIRE(client.Get(item, 3) == 42);
+
+        // A late peer receives the current state
+        Replication::Peer latePeer(server);
+        REQUIRE(latePeer.HasPending());
+    }
+    GIVEN("More changes than a packet can hold")
+    {
+        std::vector<Replication::ObjectId> objects;
+        for (int i = 0; i < 5000; ++i)
+        {
+            objects.push_back(server.Create(0));
+            server.Set(objects.back(), 0, i);
+            server.Set(objects.back(), 3, i);
+        }
+        server.Commit();
+
+        int packets = 0;
+        while (transfer())
+            ++packets;
+
+        REQUIRE(packets > 1);
+        for (int i = 0; i < 5000; ++i)
+        {
+            REQUIRE(client.Get(objects[i], 0) == (uint64_t)i);
+            REQUIRE(client.Get(objects[i], 3) == (uint64_t)i);
+        }
+
+        // Sparse changes among many objects
+        server.Set(objects[1234], 2, 1);
+        server.Set(objects[4321], 2, 1);
+        server.Commit();
+        REQUIRE(transfer());
+        REQUIRE(client.Get(objects[1234], 2) == 1);
+        REQUIRE(client.Get(objects[4321], 2) == 1);
+        REQUIRE(client.Get(objects[1235], 2) == 0);
+    }
+}
+
+namespace
+{
+    enum class Team : uint8_t { kRed, kBlue };
+
+    RPC_MESSAGE(Ping);
+    RPC_MESSAGE(SpawnEntity, uint32_t, float, float, Team);
+    RPC_MESSAGE(SetInputs, int16_t, bool, double, std::array<uint8_t, 3>);
+
+    using TestProtocol = RpcProtocol<Ping, SpawnEntity, SetInputs>;
+
+    struct TestHandler
+    {
+        void On(Ping) { ++Pings; }
+        void On(SpawnEntity, uint32_t aId, float aX, float aY, Team aTeam)
+        {
+            Ids.push_back(aId);
+            X = aX;
+            Y = aY;
+            LastTeam = aTeam;
+        }
+        void On(SetInputs, int16_t aAxis, bool aFire, double aTime, std::array<uint8_t, 3> aButtons)
+        {
+            Axis = aAxis;
+            Fire = aFire;
+            Time = aTime;
+            Buttons = aButtons;
+        }
+
+        int Pings = 0;
+        std::vector<uint32_t> Ids;
+        float X = 0.f, Y = 0.f;
+        Team LastTeam = Team::kRed;
+        int16_t Axis = 0;
+        bool Fire = false;
+        double Time = 0.0;
+        std::array<uint8_t, 3> Buttons{};
+    };
+}
+
+TEST_CASE("Remote procedure calls", "[network.rpc]")
+{
+    static_assert(Ping::Id == HashString("Ping"));
+    static_assert(SpawnEntity::Bits == 32 + 32 + 32 + 8);
+    static_assert(SetInputs::Bits == 16 + 1 + 64 + 24);
+    static_assert(TestProtocol::IndexBits == 2);
+    static_assert(TestProtocol::IndexOf<SetInputs>() == 2);
+    static_assert(TestProtocol::Fingerprint != RpcProtocol<SpawnEntity, Ping, SetInputs>::Fingerprint);
+
+    Server server;
+    REQUIRE(server.Start(0));
+
+    LoopbackCommunication clientEnd(Endpoint{ "127.0.0.2:1" }, true);
+    LoopbackCommunication serverEnd(Endpoint{ "127.0.0.2:2" }, true);
+    clientEnd.Link(serverEnd);
+    server.Attach(serverEnd);
+
+    Connection client(clientEnd, serverEnd.GetLocalEndpoint());
+    client.Update(Clock::Tick());
+    REQUIRE(server.Update() == 1);
+    auto* pRemote = server.GetConnection(clientEnd.GetLocalEndpoint());
+    REQUIRE(pRemote != nullptr);
+    auto reply = clientEnd.Receive();
+    REQUIRE(client.ProcessPacket(std::move(reply.GetResult().Payload)));
+    REQUIRE(client.IsConnected());
+
+    TestHandler handler;
+    Connection::Message message;
+
+    GIVEN("Small calls")
+    {
+        RpcBatch<TestProtocol> batch(client, 2);
+        REQUIRE(batch.Flush());
+
+        REQUIRE(batch.Call<Ping>());
+        REQUIRE(batch.Call<SpawnEntity>(42, 1.5f, -2.25f, Team::kBlue));
+        REQUIRE(batch.Call<SetInputs>(-300, true, 12345.678, std::array<uint8_t, 3>{ 1, 2, 3 }));
+        REQUIRE(batch.Call<Ping>());
+        REQUIRE(batch.GetPendingCount() == 4);
+        REQUIRE(serverEnd.GetQueuedCount() == 0);
+
+        REQUIRE(batch.Flush());
+        REQUIRE(batch.GetPendingCount() == 0);
+        REQUIRE(server.Update() == 1);
+
+        // A single datagram
+        REQUIRE(pRemote->Receive(message));
+        REQUIRE(message.Channel == 2);
+        REQUIRE(message.GetSize() == (4 * 2 + 104 + 105 + 2 + 7) / 8);
+        REQUIRE(pRemote->Receive(message) == false);
+
+        REQUIRE(TestProtocol::Dispatch(handler, message.GetData(), message.GetSize()));
+        REQUIRE(handler.Pings == 2);
+        REQUIRE(handler.Ids == std::vector<uint32_t>{ 42 });
+        REQUIRE(handler.X == 1.5f);
+        REQUIRE(handler.Y == -2.25f);
+        REQUIRE(handler.LastTeam == Team::kBlue);
+        REQUIRE(handler.Axis == -300);
+        REQUIRE(handler.Fire);
+        REQUIRE(handler.Time == 12345.678);
+        REQUIRE(handler.Buttons == std::array<uint8_t, 3>{ 1, 2, 3 });
+
+        // Truncated batches are rejected
+        REQUIRE(TestProtocol::Dispatch(handler, message.GetData(), 3) == false);
+    }
+    GIVEN("More calls than a datagram holds")
+    {
+        RpcBatch<TestProtocol> batch(client, 2);
+        for (uint32_t i = 0; i < 500; ++i)
+            REQUIRE(batch.Call<SpawnEntity>(i, 0.f, 0.f, Team::kRed));
+        REQUIRE(batch.Flush());
+
+        REQUIRE(server.Update() > 1);
+        while (pRemote->Receive(message))
+            REQUIRE(TestProtocol::Dispatch(handler, message.GetData(), message.GetSize()));
+
+        REQUIRE(handler.Ids.size() == 500);
+        for (uint32_t i = 0; i < 500; ++i)
+            REQUIRE(handler.Ids[i] == i);
+    }
+
+    server.Detach(serverEnd);
+}
+
+TEST_CASE("String interning", "[network.strings]")
+{
+    StringTable sender(8);
+    StringTable receiver(8);
+    REQUIRE(sender.GetIdBits() == 3);
+
+    uint8_t data[Connection::MaxPayloadSize];
+    uint64_t now = Clock::Seconds(10);
+
+    // Sends a string and returns how many bits it took
+    const auto transfer = [&](std::string_view aString, bool aAcknowledge = true)
+    {
+        Buffer::Writer writer(data, sizeof(data));
+        REQUIRE(sender.Write(writer, aString, now));
+
+        Buffer::Reader reader(data, sizeof(data));
+        std::string_view result;
+        REQUIRE(receiver.Read(reader, result));
+        REQUIRE(result == aString);
+        REQUIRE(reader.GetBitPosition() == writer.GetBitPosition());
+
+        if (aAcknowledge && receiver.HasAcknowledgements())
+        {
+            uint8_t acknowledgements[64];
+            Buffer::Writer ackWriter(acknowledgements, sizeof(acknowledgements));
+            REQUIRE(receiver.WriteAcknowledgements(ackWriter));
+            Buffer::Reader ackReader(acknowledgements, sizeof(acknowledgements));
+            REQUIRE(sender.ReadAcknowledgements(ackReader));
+        }
+
+        return writer.GetBitPosition();
+    };
+
+    const std::string name = "models/characters/knight.mesh";
+    const auto definitionBits = 2 + 3 + 8 + 8 + name.size() * 8;
+
+    GIVEN("Repeated strings")
+    {
+        // The definition is sent until acknowledged
+        REQUIRE(transfer(name, false) == definitionBits);
+        REQUIRE(transfer(name) == definitionBits);
+        REQUIRE(transfer(name) == 1 + 3);
+        REQUIRE(transfer(name) == 1 + 3);
+        REQUIRE(transfer("") == 2 + 3 + 8 + 8);
+        REQUIRE(transfer("") == 1 + 3);
+        REQUIRE(sender.GetSize() == 2);
+
+        Buffer::Writer writer(data, 1);
+        REQUIRE(sender.Write(writer, "textures/unknown.png", now) == false);
+        REQUIRE(sender.GetSize() == 2);
+        REQUIRE(sender.Write(writer, std::string(StringTable::MaxLength + 1, 'a'), now) == false);
+    }
+    GIVEN("A full table")
+    {
+        for (int i = 0; i < 8; ++i)
+            transfer("string" + std::to_string(i));
+        transfer("string0");
+        REQUIRE(sender.GetSize() == 8);
+
+        // Every slot was used recently so the string is sent as is
+        REQUIRE(transfer("other") == 2 + 8 + 5 * 8);
+        REQUIRE(transfer("other") == 2 + 8 + 5 * 8);
+
+        // The least recently used one is replaced once it is old enough
+        now += StringTable::ReuseDelay;
+        REQUIRE(transfer("other") == 2 + 3 + 8 + 8 + 5 * 8);
+        REQUIRE(transfer("other") == 1 + 3);
+        REQUIRE(transfer("string0") == 1 + 3);
+        REQUIRE(transfer("string1") > 1 + 3);
+        REQUIRE(sender.GetSize() == 8);
+    }
+    GIVEN("An acknowledgement of an evicted string")
+    {
+        for (int i = 0; i < 8; ++i)
+            transfer("string" + std::to_string(i), false);
+
+        uint8_t stale[64];
+        Buffer::Writer staleWriter(stale, sizeof(stale));
+        REQUIRE(receiver.WriteAcknowledgements(staleWriter));
+        REQUIRE(receiver.HasAcknowledgements() == false);
+
+        now += StringTable::ReuseDelay;
+        transfer("replacement", false);
+
+        // The slot was reused in the meantime, the old acknowledgement doesn't apply to the new string
+        Buffer::Reader staleReader(stale, sizeof(stale));
+        REQUIRE(sender.ReadAcknowledgements(staleReader));
+        REQUIRE(transfer("replacement") > 1 + 3);
+        REQUIRE(transfer("replacement") == 1 + 3);
+    }
+    GIVEN("Many evictions")
+    {
+        StringTable large(64);
+        for (int round = 0; round < 20; ++round)
+        {
+            now += StringTable::ReuseDelay;
+            for (int i = 0; i < 64; ++i)
+            {
+                const auto text = std::to_string(round * 37 + i);
+                Buffer::Writer writer(data, sizeof(data));
+                REQUIRE(large.Write(writer, text, now));
+                REQUIRE(large.GetSize() <= 64);
+            }
+        }
+    }
+}
+
+TEST_CASE("Server statistics", "[network.statistics]")
+{
+    const auto name = "dow_statistics_" + std::to_string(Clock::GetTimestamp());
+
+    GIVEN("A server publishing its counters")
+    {
+        TrackAllocator<StandardAllocator> allocator;
+        auto* pData = allocator.Allocate(1000);
+
+        Server server;
+        REQUIRE(server.Start(0));
+        REQUIRE(server.EnableStatistics(name, &allocator));
+
+        LoopbackCommunication clientEnd(Endpoint{ "127.0.0.2:1" }, true);
+        LoopbackCommunication serverEnd(Endpoint{ "127.0.0.2:2" }, true);
+        clientEnd.Link(serverEnd);
+        server.Attach(serverEnd);
+
+        Connection client(clientEnd, serverEnd.GetLocalEndpoint());
+        client.Update(Clock::Tick());
+        REQUIRE(server.Update() == 1);
+
+        auto reply = clientEnd.Receive();
+        REQUIRE(client.ProcessPacket(std::move(reply.GetResult().Payload)));
+
+        const uint8_t payload[100] = {};
+        REQUIRE(client.Send(0, payload, sizeof(payload)));
+        REQUIRE(client.Send(0, payload, sizeof(payload)));
+        REQUIRE(server.Update() == 2);
+
+        ServerStatistics reader;
+        REQUIRE(reader.Open(name));
+
+        auto pSnapshot = std::make_unique<ServerStatistics::Snapshot>();
+        REQUIRE(reader.Read(*pSnapshot));
+        REQUIRE(pSnapshot->Tick == 2);
+        REQUIRE(pSnapshot->TickInterval > 0);
+        REQUIRE(pSnapshot->MaxTickDuration >= pSnapshot->TickDuration);
+        REQUIRE(pSnapshot->ProcessedPackets == 2);
+        REQUIRE(pSnapshot->AllocatedBytes >= 1000);
+        REQUIRE(pSnapshot->ConnectionCount == 1);
+        REQUIRE(pSnapshot->ListedCount == 1);
+
+        const auto& peer = pSnapshot->Connections[0];
+        REQUIRE(peer.IPv6 == 0);
+        REQUIRE(peer.Address[0] == 127);
+        REQUIRE(peer.Address[3] == 2);
+        REQUIRE(peer.Port == 1);
+        REQUIRE(peer.State == Connection::kConnected);
+        REQUIRE(peer.ReceivedPackets == 3);
+        REQUIRE(peer.ReceivedBytes == client.GetStatistics().SentBytes);
+        REQUIRE(peer.SentPackets == 1);
+        REQUIRE(peer.SentBytes == client.GetStatistics().ReceivedBytes);
+        REQUIRE(client.GetStatistics().SentPackets == 3);
+        REQUIRE(client.GetStatistics().ReceivedPackets == 1);
+        REQUIRE(peer.DroppedPackets == 0);
+
+        // Garbage is counted against the connection
+        REQUIRE(server.GetConnection(clientEnd.GetLocalEndpoint())->ProcessPacket(payload, sizeof(payload)) == false);
+        REQUIRE(server.Update() == 0);
+        REQUIRE(reader.Read(*pSnapshot));
+        REQUIRE(pSnapshot->Tick == 3);
+        REQUIRE(pSnapshot->Connections[0].DroppedPackets == 1);
+
+        server.Detach(serverEnd);
+        allocator.Free(pData);
+    }
+    GIVEN("A reader racing the writer")
+    {
+        ServerStatistics writer;
+        REQUIRE(writer.Create(name));
+
+        ServerStatistics reader;
+        REQUIRE(reader.Open(name));
+
+        std::atomic<bool> done{ false };
+        std::thread thread([&]()
+        {
+            for (uint64_t i = 1; i <= 20000; ++i)
+            {
+                auto& snapshot = writer.Begin();
+                snapshot.Tick = i;
+                for (auto& peer : snapshot.Connections)
+                    peer.SentPackets = i;
+                snapshot.ProcessedPackets = i;
+                writer.End();
+            }
+            done = true;
+        });
+
+        auto pSnapshot = std::make_unique<ServerStatistics::Snapshot>();
+        bool consistent = true;
+        while (!done)
+        {
+            if (!reader.Read(*pSnapshot, 1000))
+                continue;
+
+            consistent &= pSnapshot->ProcessedPackets == pSnapshot->Tick;
+            consistent &= pSnapshot->Connections[0].SentPackets == pSnapshot->Tick;
+            consistent &= pSnapshot->Connections[ServerStatistics::MaxConnections - 1].SentPackets == pSnapshot->Tick;
+        }
+        thread.join();
+
+        REQUIRE(consistent);
+        REQUIRE(reader.Read(*pSnapshot));
+        REQUIRE(pSnapshot->Tick == 20000);
+    }
+}
+
+TEST_CASE("Low latency mode", "[network.lowlatency]")
+{
+    Server server;
+    REQUIRE(server.Start(0));
+
+    // Normal mode sleeps in select, the kernel decides how late it wakes up
+    for (int i = 0; i < 5; ++i)
+        REQUIRE(server.Wait(Clock::Microseconds(200)) == false);
+    REQUIRE(server.GetTimerOvershoot().GetCount() == 5);
+
+    const auto sleepingOvershoot = server.GetTimerOvershoot().GetPercentile(50);
+    server.ResetTimerOvershoot();
+
+    // Pinning applies to the calling thread, keep it away from the test runner
+    std::thread([&]()
+    {
+        Server::LowLatency config;
+        config.Core = 0;
+        // Locking the test process could make later allocations fail under a low memlock limit
+        config.LockMemory = false;
+        // Busy polling is usually refused without privileges, the rest still applies
+        server.EnableLowLatency(config);
+
+        for (int i = 0; i < 5; ++i)
+            REQUIRE(server.Wait(Clock::Microseconds(200)) == false);
+        REQUIRE(server.GetTimerOvershoot().GetCount() == 5);
+        REQUIRE(server.GetTimerOvershoot().GetPercentile(50) <= std::max<uint64_t>(sleepingOvershoot, Clock::Microseconds(20)));
+
+        // Spinning still notices packets
+        Socket client(Endpoint::kIPv4);
+        REQUIRE(client.Bind());
+        Buffer buffer(10);
+        REQUIRE(client.Send(Socket::Packet{ Endpoint("127.0.0.1:" + std::to_string(server.GetPort())), std::move(buffer) }));
+        REQUIRE(server.Wait(Clock::Seconds(1)));
+        REQUIRE(server.GetTimerOvershoot().GetCount() == 5);
+    }).join();
+}
+
+TEST_CASE("Capacity plan", "[network.capacity]")
+{
+    GIVEN("A connection manager with room for two connections")
+    {
+        LoopbackCommunication communication(Endpoint{ "127.0.0.3:1" }, true);
+
+        ConnectionManager manager(2);
+        manager.Add(Connection(communication, Endpoint{ "127.0.0.3:2" }));
+        auto* pFirst = manager.Find(Endpoint{ "127.0.0.3:2" });
+        REQUIRE(pFirst != nullptr);
+
+        // Duplicates are ignored and pointers stay put
+        manager.Add(Connection(communication, Endpoint{ "127.0.0.3:2" }));
+        manager.Add(Connection(communication, Endpoint{ "[::1]:2" }));
+        REQUIRE(manager.GetCount() == 2);
+        REQUIRE(manager.IsFull());
+        REQUIRE(manager.Find(Endpoint{ "127.0.0.3:2" }) == pFirst);
+        REQUIRE(manager.Find(Endpoint{ "[::1]:2" }) != nullptr);
+
+        manager.Add(Connection(communication, Endpoint{ "127.0.0.3:3" }));
+        REQUIRE(manager.GetCount() == 2);
+        REQUIRE(manager.Find(Endpoint{ "127.0.0.3:3" }) == nullptr);
+        REQUIRE(manager.SetCapacity(10) == false);
+    }
+    GIVEN("A server started with a capacity plan")
+    {
+        Server::CapacityPlan plan;
+        plan.MaxConnections = 1;
+        plan.PacketsPerConnection = 16;
+        plan.PrefaultStack = 64 * 1024;
+
+        Server server;
+        REQUIRE(server.Start(0, plan));
+        REQUIRE(server.GetPacketPool() != nullptr);
+        REQUIRE(server.GetPacketPool()->GetBlockCount() == 16);
+
+        LoopbackCommunication clientEnd(Endpoint{ "127.0.0.3:1" }, true);
+        LoopbackCommunication serverEnd(Endpoint{ "127.0.0.3:2" }, true);
+        LoopbackCommunication otherEnd(Endpoint{ "127.0.0.3:3" }, true);
+        clientEnd.Link(serverEnd);
+        server.Attach(serverEnd);
+
+        Connection client(clientEnd, serverEnd.GetLocalEndpoint());
+        client.Update(Clock::Tick());
+        REQUIRE(server.Update() == 1);
+
+        auto reply = clientEnd.Receive();
+        REQUIRE(client.ProcessPacket(std::move(reply.GetResult().Payload)));
+
+        auto* pConnection = server.GetConnection(clientEnd.GetLocalEndpoint());
+        REQUIRE(pConnection != nullptr);
+
+        const auto freeBlocks = server.GetPacketPool()->GetFreeCount();
+        REQUIRE(freeBlocks < 16);
+
+        const uint8_t payload[100] = { 1, 2, 3 };
+        for (int i = 0; i < 4; ++i)
+            REQUIRE(pConnection->ProcessPacket(payload, sizeof(payload)) == false);
+        for (int i = 0; i < 4; ++i)
+            REQUIRE(client.Send(0, payload, sizeof(payload)));
+        REQUIRE(server.Update() == 4);
+
+        Connection::Message message;
+        size_t received = 0;
+        while (pConnection->Receive(message))
+        {
+            REQUIRE(message.GetSize() == sizeof(payload));
+            REQUIRE(message.GetData()[2] == 3);
+            ++received;
+        }
+        REQUIRE(received == 4);
+        message = Connection::Message{};
+
+        // Nothing reached the system allocator and every block came back
+        REQUIRE(server.GetPacketPool()->GetFallbackCount() == 0);
+        REQUIRE(server.GetPacketPool()->GetFreeCount() == freeBlocks);
+
+        // A peer that is not read from keeps at most its share of the pool
+        const auto dropped = pConnection->GetStatistics().DroppedPackets;
+        for (int i = 0; i < 20; ++i)
+            REQUIRE(client.Send(0, payload, sizeof(payload)));
+        server.Update();
+
+        received = 0;
+        while (pConnection->Receive(message))
+            ++received;
+        REQUIRE(received == plan.PacketsPerConnection);
+        REQUIRE(pConnection->GetStatistics().DroppedPackets == dropped + 4);
+        message = Connection::Message{};
+
+        // The plan is full, other peers are turned away
+        otherEnd.Link(serverEnd);
+        Connection other(otherEnd, serverEnd.GetLocalEndpoint());
+        other.Update(Clock::Tick());
+        server.Update();
+        REQUIRE(server.GetConnectionCount() == 1);
+        REQUIRE(server.GetConnection(otherEnd.GetLocalEndpoint()) == nullptr);
+
+        server.Detach(serverEnd);
+    }
+}
+
+TEST_CASE("Client", "[network.client]")
+{
+    Server server;
+    REQUIRE(server.Start(0));
+
+    Endpoint serverEndpoint{ "127.0.0.1" };
+    serverEndpoint.SetPort(server.GetPort());
+
+    Client client;
+    REQUIRE(client.Connect(Endpoint{ "[::1]:1" }) == false);
+    REQUIRE(client.Connect(serverEndpoint));
+    REQUIRE(client.GetState() == Connection::kNegociating);
+
+    // Both ends are driven from this loop, nothing blocks
+    for (int i = 0; i < 100 && !client.IsConnected(); ++i)
+    {
+        server.Wait(Clock::Milliseconds(10));
+        server.Update();
+        client.Wait(Clock::Milliseconds(10));
+        client.Update();
+    }
+
+    REQUIRE(client.IsConnected());
+
+    Endpoint clientEndpoint{ "127.0.0.1" };
+    clientEndpoint.SetPort(client.GetPort());
+    auto* pServerConnection = server.GetConnection(clientEndpoint);
+    REQUIRE(pServerConnection != nullptr);
+
+    Connection::Message message;
+    const uint8_t input[] = { 1, 2, 3, 4 };
+
+    GIVEN("Queued sends")
+    {
+        REQUIRE(client.Send(0, input, sizeof(input)));
+        REQUIRE(client.Send(0, input, sizeof(input)));
+
+        // Nothing leaves before the next tick
+        REQUIRE(server.Wait(Clock::Milliseconds(20)) == false);
+
+        client.Update();
+        REQUIRE(server.Wait(Clock::Seconds(1)));
+        REQUIRE(server.Update() == 2);
+    }
+    GIVEN("Immediate sends")
+    {
+        REQUIRE(client.Send(0, input, 2));
+        REQUIRE(client.SendImmediate(0, input, sizeof(input)));
+
+        // The input is on the wire without waiting for the client's tick, behind what was queued before it
+        REQUIRE(server.Wait(Clock::Seconds(1)));
+        for (int i = 0; i < 100 && server.Update() < 2; ++i)
+            server.Wait(Clock::Milliseconds(10));
+
+        REQUIRE(pServerConnection->Receive(message));
+        REQUIRE(message.GetSize() == 2);
+        REQUIRE(pServerConnection->Receive(message));
+        REQUIRE(message.GetSize() == sizeof(input));
+        REQUIRE(std::memcmp(message.GetData(), input, sizeof(input)) == 0);
+    }
+    GIVEN("Messages from the server")
+    {
+        REQUIRE(pServerConnection->Send(1, input, sizeof(input)));
+        REQUIRE(client.Wait(Clock::Seconds(1)));
+        REQUIRE(client.Update() == 1);
+
+        REQUIRE(client.Receive(message));
+        REQUIRE(message.Channel == 1);
+        REQUIRE(std::memcmp(message.GetData(), input, sizeof(input)) == 0);
+        REQUIRE(client.Receive(message) == false);
+    }
+
+    client.Disconnect();
+    REQUIRE(client.GetState() == Connection::kNone);
+    REQUIRE(client.Send(0, input, sizeof(input)) == false);
+}
+
+TEST_CASE("Snapshot history", "[network.snapshots]")
+{
+    std::vector<uint8_t> state(1000);
+    auto push = [&state](SnapshotHistory& aHistory, uint32_t aTick)
+    {
+        std::fill(std::begin(state), std::end(state), (uint8_t)aTick);
+        return aHistory.Push(aTick, state.data(), state.size());
+    };
+
+    GIVEN("A window of four ticks")
+    {
+        SnapshotHistory history(4, 16);
+        REQUIRE(history.GetLatest() == nullptr);
+
+        for (uint32_t tick = 1; tick <= 4; ++tick)
+            REQUIRE(push(history, tick));
+
+        REQUIRE(push(history, 4) == false);
+        REQUIRE(history.GetSnapshotCount() == 4);
+        REQUIRE(history.GetLatest()->GetTick() == 4);
+        REQUIRE(history.Find(1)->GetData()[0] == 1);
+
+        SnapshotHistory::Baseline baseline(history);
+        REQUIRE(baseline.Get() == nullptr);
+        REQUIRE(baseline.Acknowledge(5) == false);
+        REQUIRE(baseline.Acknowledge(2));
+        REQUIRE(baseline.Get()->GetTick() == 2);
+
+        // Out of order acknowledgements keep the newer baseline
+        REQUIRE(baseline.Acknowledge(1));
+        REQUIRE(baseline.Get()->GetTick() == 2);
+
+        // Tick 1 leaves the window and is freed, tick 2 is kept by the baseline
+        REQUIRE(push(history, 5));
+        REQUIRE(history.Find(1) == nullptr);
+        REQUIRE(push(history, 6));
+        REQUIRE(history.Find(2) == nullptr);
+        REQUIRE(baseline.Get()->GetTick() == 2);
+        REQUIRE(baseline.Get()->GetData()[999] == 2);
+        REQUIRE(history.GetSnapshotCount() == 5);
+        REQUIRE(history.GetUsedMemory() == 5 * state.size());
+
+        REQUIRE(baseline.Acknowledge(2) == true);
+        REQUIRE(baseline.Acknowledge(1) == true);
+        REQUIRE(baseline.Acknowledge(6));
+        REQUIRE(history.GetSnapshotCount() == 4);
+
+        // Skipped ticks free the whole window
+        REQUIRE(push(history, 20));
+        REQUIRE(history.GetSnapshotCount() == 2);
+        REQUIRE(baseline.Get()->GetTick() == 6);
+
+        baseline.Reset();
+        REQUIRE(baseline.Get() == nullptr);
+        REQUIRE(history.GetSnapshotCount() == 1);
+    }
+    GIVEN("Many peers acknowledging with different delays")
+    {
+        constexpr size_t PeerCount = 64;
+        SnapshotHistory history(8, 32);
+
+        std::vector<std::unique_ptr<SnapshotHistory::Baseline>> baselines;
+        for (size_t i = 0; i < PeerCount; ++i)
+            baselines.push_back(std::make_unique<SnapshotHistory::Baseline>(history));
+
+        size_t peak = 0;
+        for (uint32_t tick = 1; tick <= 200; ++tick)
+        {
+            REQUIRE(push(history, tick));
+
+            // Peers are between 1 and 4 ticks behind
+            for (size_t i = 0; i < PeerCount; ++i)
+            {
+                const auto lag = 1 + (uint32_t)(i % 4);
+                if (tick > lag)
+                    REQUIRE(baselines[i]->Acknowledge(tick - lag));
+            }
+
+            peak = std::max(peak, history.GetSnapshotCount());
+        }
+
+        // The window alone, whatever the number of peers
+        REQUIRE(peak <= 8);
+        for (size_t i = 0; i < PeerCount; ++i)
+        {
+            REQUIRE(baselines[i]->Get() != nullptr);
+            REQUIRE(baselines[i]->Get()->GetTick() == 200 - 1 - i % 4);
+        }
+
+        baselines.clear();
+        REQUIRE(history.GetSnapshotCount() == 8);
+    }
+    GIVEN("More baselines than the capacity")
+    {
+        SnapshotHistory history(2, 4);
+
+        SnapshotHistory::Baseline first(history), second(history), third(history);
+        REQUIRE(push(history, 1));
+        REQUIRE(first.Acknowledge(1));
+        REQUIRE(push(history, 2));
+        REQUIRE(second.Acknowledge(2));
+        REQUIRE(push(history, 3));
+        REQUIRE(third.Acknowledge(3));
+        REQUIRE(push(history, 4));
+        REQUIRE(history.GetSnapshotCount() == 4);
+
+        // The oldest baseline is dropped to make room, that peer gets a full state next
+        REQUIRE(push(history, 5));
+        REQUIRE(first.Get() == nullptr);
+        REQUIRE(second.Get()->GetTick() == 2);
+        REQUIRE(history.GetSnapshotCount() == 4);
+
+        REQUIRE(third.Get()->GetTick() == 3);
+        REQUIRE(history.Find(5)->GetData()[0] == 5);
+
+        // Releasing a dropped baseline leaves the slot's new snapshot alone
+        first.Reset();
+        REQUIRE(history.Find(5) != nullptr);
+        REQUIRE(first.Acknowledge(5));
+        REQUIRE(third.Acknowledge(5));
+        REQUIRE(history.GetSnapshotCount() == 3);
+    }
+}
+
+#ifdef __cpp_impl_coroutine
+
+namespace
+{
+    const uint8_t s_login[] = { 'l', 'o', 'g', 'i', 'n' };
+    const uint8_t s_welcome[] = { 'w', 'e', 'l', 'c', 'o', 'm', 'e' };
+    const uint8_t s_ready[] = { 'r', 'e', 'a', 'd', 'y' };
+
+    bool Matches(const Connection::Message& acMessage, const uint8_t* apData, size_t aLength)
+    {
+        return acMessage.GetSize() == aLength && std::memcmp(acMessage.GetData(), apData, aLength) == 0;
+    }
+
+    AsyncTask ServerSession(AsyncLoop& aLoop, Connection& aConnection, size_t& aLoggedIn)
+    {
+        Connection::Message message;
+
+        if (!co_await aLoop.Receive(aConnection, message) || !Matches(message, s_login, sizeof(s_login)))
+            co_return;
+
+        aConnection.Send(0, s_welcome, sizeof(s_welcome));
+
+        if (!co_await aLoop.Receive(aConnection, message) || !Matches(message, s_ready, sizeof(s_ready)))
+            co_return;
+
+        ++aLoggedIn;
+    }
+
+    AsyncTask Acceptor(AsyncLoop& aLoop, Server& aServer, Allocator& aFrames, std::vector<AsyncTask>& aSessions, size_t& aLoggedIn)
+    {
+        for (;;)
+        {
+            auto* pConnection = co_await aLoop.Accept(aServer);
+
+            ScopedAllocator _(&aFrames);
+            aSessions.push_back(ServerSession(aLoop, *pConnection, aLoggedIn));
+        }
+    }
+
+    AsyncTask ClientSession(AsyncLoop& aLoop, Client& aClient, bool& aWelcomed)
+    {
+        if (!co_await aLoop.Handshake(*aClient.GetConnection()))
+            co_return;
+
+        aClient.SendImmediate(0, s_login, sizeof(s_login));
+
+        Connection::Message message;
+        if (!co_await aLoop.Receive(*aClient.GetConnection(), message) || !Matches(message, s_welcome, sizeof(s_welcome)))
+            co_return;
+
+        aWelcomed = true;
+        aClient.SendImmediate(0, s_ready, sizeof(s_ready));
+    }
+}
+
+TEST_CASE("Coroutines", "[network.async]")
+{
+    AsyncLoop loop;
+
+    GIVEN("Login sequences written as coroutines on both ends")
+    {
+        constexpr size_t ClientCount = 8;
+
+        Server server;
+        REQUIRE(server.Start(0));
+
+        Endpoint serverEndpoint{ "127.0.0.1" };
+        serverEndpoint.SetPort(server.GetPort());
+
+        // Every session frame has to fit in a small block
+        PoolAllocator frames(512, ClientCount);
+        std::vector<AsyncTask> sessions;
+        size_t loggedIn = 0;
+
+        auto acceptor = Acceptor(loop, server, frames, sessions, loggedIn);
+        REQUIRE(acceptor.IsValid());
+
+        std::vector<std::unique_ptr<Client>> clients;
+        std::vector<AsyncTask> clientSessions;
+        bool welcomed[ClientCount] = {};
+        for (size_t i = 0; i < ClientCount; ++i)
+        {
+            clients.push_back(std::make_unique<Client>());
+            REQUIRE(clients.back()->Connect(serverEndpoint));
+            clientSessions.push_back(ClientSession(loop, *clients.back(), welcomed[i]));
+        }
+
+        REQUIRE(loop.GetWaitingCount() == ClientCount + 1);
+
+        for (int i = 0; i < 200 && loggedIn < ClientCount; ++i)
+        {
+            server.Wait(Clock::Milliseconds(5));
+            server.Update();
+            for (auto& pClient : clients)
+                pClient->Update();
+
+            loop.Poll();
+        }
+
+        REQUIRE(loggedIn == ClientCount);
+        REQUIRE(sessions.size() == ClientCount);
+        for (size_t i = 0; i < ClientCount; ++i)
+        {
+            REQUIRE(welcomed[i]);
+            REQUIRE(sessions[i].IsDone());
+            REQUIRE(clientSessions[i].IsDone());
+        }
+
+        REQUIRE(frames.GetFallbackCount() == 0);
+        REQUIRE(frames.GetFreeCount() == 0);
+
+        // Only the acceptor is left
+        REQUIRE(acceptor.IsDone() == false);
+        REQUIRE(loop.GetWaitingCount() == 1);
+
+        sessions.clear();
+        REQUIRE(frames.GetFreeCount() == ClientCount);
+    }
+    GIVEN("Conditions and cancellation")
+    {
+        int value = 0;
+        int resumed = 0;
+
+        auto wait = [&](int aTarget) -> AsyncTask
+        {
+            co_await loop.Until([&value, aTarget]() { return value >= aTarget; });
+            ++resumed;
+        };
+
+        auto first = wait(1);
+        auto second = wait(2);
+        auto immediate = wait(0);
+
+        REQUIRE(immediate.IsDone());
+        REQUIRE(resumed == 1);
+        REQUIRE(loop.GetWaitingCount() == 2);
+        REQUIRE(loop.Poll() == 0);
+
+        value = 1;
+        REQUIRE(loop.Poll() == 1);
+        REQUIRE(first.IsDone());
+        REQUIRE(second.IsDone() == false);
+
+        // Destroying a suspended task takes it off the loop
+        {
+            auto discarded = std::move(second);
+            REQUIRE(loop.GetWaitingCount() == 1);
+        }
+        REQUIRE(loop.GetWaitingCount() == 0);
+
+        value = 2;
+        REQUIRE(loop.Poll() == 0);
+        REQUIRE(resumed == 2);
+    }
+}
+
+#endif
+
+TEST_CASE("Endpoint", "[network.endpoint]")
+{
+    GIVEN("An empty endpoint")
+    {
+        Endpoint endpoint;
+        REQUIRE(endpoint.IsValid() == false);
+    }
+    GIVEN("An IPv4")
+    {
+        Endpoint endpoint("127.0.0.1");
+        REQUIRE(endpoint.IsIPv4() == true);
+        REQUIRE(endpoint.GetPort() == 0);
+        REQUIRE(endpoint.GetIPv4()[0] == 127);
+        REQUIRE(endpoint.GetIPv4()[1] == 0);
+        REQUIRE(endpoint.GetIPv4()[2] == 0);
+        REQUIRE(endpoint.GetIPv4()[3] == 1);
+    }
+    GIVEN("An IPv4 with a port")
+    {
+        Endpoint endpoint("127.0.0.1:12345");
+        REQUIRE(endpoint.IsIPv4() == true);
+        REQUIRE(endpoint.GetPort() == 12345);
+        REQUIRE(endpoint.GetIPv4()[0] == 127);
+        REQUIRE(endpoint.GetIPv4()[1] == 0);
+        REQUIRE(endpoint.GetIPv4()[2] == 0);
+        REQUIRE(endpoint.GetIPv4()[3] == 1);
+    }
+    GIVEN("A bad IPv4")
+    {
+        Endpoint endpoint("127.0.1");
+        REQUIRE(endpoint.IsValid() == false);
+        REQUIRE(endpoint.GetPort() == 0);
+    }
+    GIVEN("A bad IP")
+    {
+        Endpoint endpoint("lol");
+        REQUIRE(endpoint.IsValid() == false);
+        REQUIRE(endpoint.GetPort() == 0);
+    }
+    GIVEN("An IPv6")
+    {
+        Endpoint endpoint("[2001:0db8:85a3:0000:0000:8a2e:0370:7334]");
+        REQUIRE(endpoint.IsIPv6() == true);
+        REQUIRE(endpoint.GetPort() == 0);
+        REQUIRE(endpoint.GetIPv6()[0] == 0x2001);
+        REQUIRE(endpoint.GetIPv6()[1] == 0x0db8);
+        REQUIRE(endpoint.GetIPv6()[2] == 0x85a3);
+        REQUIRE(endpoint.GetIPv6()[3] == 0x0000);
+        REQUIRE(endpoint.GetIPv6()[4] == 0x0000);
+        REQUIRE(endpoint.GetIPv6()[5] == 0x8a2e);
+        REQUIRE(endpoint.GetIPv6()[6] == 0x0370);
+        REQUIRE(endpoint.GetIPv6()[7] == 0x7334);
+    }
+    GIVEN("An IPv6 with a port")
+    {
+        Endpoint endpoint("[2001:0db8:85a3:0000:0000:8a2e:0370:7334]:12345");
+        REQUIRE(endpoint.IsIPv6() == true);
+        REQUIRE(endpoint.GetPort() == 12345);
+        REQUIRE(endpoint.GetIPv6()[0] == 0x2001);
+        REQUIRE(endpoint.GetIPv6()[1] == 0x0db8);
+        REQUIRE(endpoint.GetIPv6()[2] == 0x85a3);
+        REQUIRE(endpoint.GetIPv6()[3] == 0x0000);
+        REQUIRE(endpoint.GetIPv6()[4] == 0x0000);
+        REQUIRE(endpoint.GetIPv6()[5] == 0x8a2e);
+        REQUIRE(endpoint.GetIPv6()[6] == 0x0370);
+        REQUIRE(endpoint.GetIPv6()[7] == 0x7334);
+    }
 }
\ No newline at end of file
@@ -0,0 +1,150 @@
+#include "TraceAllocator.h"
+#include "StandardAllocator.h"
+#include "BoundedAllocator.h"
+#include "PoolAllocator.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#elif __linux__
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#else
+static_assert(false, "Not implemented");
+#endif
+
+struct Run
+{
+    TraceAllocator::ReplayResult Result;
+    // Peak resident set of the process that ran the replay, in bytes
+    size_t PeakResident{ 0 };
+    bool Valid{ false };
+};
+
+// Each replay gets its own process where possible so that one allocator's peak does not hide the next one's
+static Run Measure(const std::vector<TraceAllocator::Event>& acEvents, const std::function<std::unique_ptr<Allocator>()>& acFactory)
+{
+    Run run;
+
+#ifdef _WIN32
+    auto pAllocator = acFactory();
+    run.Result = TraceAllocator::Replay(acEvents, *pAllocator);
+
+    PROCESS_MEMORY_COUNTERS counters{};
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        run.PeakResident = counters.PeakWorkingSetSize;
+    run.Valid = true;
+#elif __linux__
+    int fds[2];
+    if (pipe(fds) != 0)
+        return run;
+
+    const auto pid = fork();
+    if (pid < 0)
+    {
+        close(fds[0]);
+        close(fds[1]);
+        return run;
+    }
+
+    if (pid == 0)
+    {
+        close(fds[0]);
+        auto pAllocator = acFactory();
+        const auto result = TraceAllocator::Replay(acEvents, *pAllocator);
+        const auto written = write(fds[1], &result, sizeof(result));
+        _exit(written == sizeof(result) ? 0 : 1);
+    }
+
+    close(fds[1]);
+    run.Valid = read(fds[0], &run.Result, sizeof(run.Result)) == sizeof(run.Result);
+    close(fds[0]);
+
+    int status = 0;
+    rusage usage{};
+    if (wait4(pid, &status, 0, &usage) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+        run.Valid = false;
+
+    run.PeakResident = (size_t)usage.ru_maxrss * 1024;
+#endif
+
+    return run;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " <trace> [pool block size] [bounded allocator limit in bytes]" << std::endl;
+        return 1;
+    }
+
+    std::vector<TraceAllocator::Event> events;
+    if (!TraceAllocator::Load(argv[1], events))
+    {
+        std::cerr << "Failed to load " << argv[1] << std::endl;
+        return 1;
+    }
+
+    // The pool is sized to hold every allocation of the trace alive at once, larger ones fall back
+    size_t live = 0, peakLive = 0, threads = 0;
+    for (auto& event : events)
+    {
+        if (event.Op == TraceAllocator::kAllocate)
+            peakLive = std::max(peakLive, ++live);
+        else if (event.Op == TraceAllocator::kFree)
+            --live;
+
+        threads = std::max<size_t>(threads, event.Thread + 1);
+    }
+
+    const size_t blockSize = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1200;
+
+    // Without a limit the bounded allocator gets the standard allocator's peak, it should never refuse
+    auto reference = Measure(events, []() { return std::make_unique<StandardAllocator>(); });
+    const size_t limit = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : reference.Result.PeakReserved;
+
+    std::printf("%zu events, %zu threads, %zu allocations alive at most\n\n", events.size(), threads, peakLive);
+    std::printf("%-12s %12s %12s %10s %14s %14s %12s %14s\n", "allocator", "time ms", "ns/alloc", "failures", "peak requested", "peak reserved", "overhead %", "peak resident");
+
+    struct Candidate
+    {
+        const char* Name;
+        std::function<std::unique_ptr<Allocator>()> Factory;
+    };
+
+    const Candidate candidates[] =
+    {
+        { "standard", []() { return std::make_unique<StandardAllocator>(); } },
+        { "bounded", [limit]() { return std::make_unique<BoundedAllocator>(limit); } },
+        { "pool", [blockSize, peakLive]() { return std::make_unique<PoolAllocator>(blockSize, peakLive); } },
+    };
+
+    for (auto& candidate : candidates)
+    {
+        const auto run = Measure(events, candidate.Factory);
+        if (!run.Valid)
+        {
+            std::printf("%-12s replay failed\n", candidate.Name);
+            continue;
+        }
+
+        const auto& result = run.Result;
+        const auto overhead = result.PeakRequested ? 100.0 * ((double)result.PeakReserved / result.PeakRequested - 1.0) : 0.0;
+
+        std::printf("%-12s %12.3f %12.1f %10zu %14zu %14zu %12.1f %14zu\n", candidate.Name,
+            result.Duration / 1e6, result.Allocations ? (double)result.Duration / result.Allocations : 0.0,
+            result.Failures, result.PeakRequested, result.PeakReserved, overhead, run.PeakResident);
+    }
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,19 @@
+#include "Log.h"
+#include <iostream>
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " <binary log>" << std::endl;
+        return 1;
+    }
+
+    if (!Log::Decode(argv[1], std::cout))
+    {
+        std::cerr << "Failed to decode " << argv[1] << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,91 @@
+#include "ServerStatistics.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+
+static const char* s_states[] = { "none", "negotiating", "connected" };
+
+static std::string FormatAddress(const ServerStatistics::Peer& acPeer)
+{
+    char buffer[64];
+    if (acPeer.IPv6)
+    {
+        const auto* a = acPeer.Address;
+        std::snprintf(buffer, sizeof(buffer), "[%x:%x:%x:%x:%x:%x:%x:%x]:%u",
+            a[0] << 8 | a[1], a[2] << 8 | a[3], a[4] << 8 | a[5], a[6] << 8 | a[7],
+            a[8] << 8 | a[9], a[10] << 8 | a[11], a[12] << 8 | a[13], a[14] << 8 | a[15], acPeer.Port);
+    }
+    else
+        std::snprintf(buffer, sizeof(buffer), "%u.%u.%u.%u:%u", acPeer.Address[0], acPeer.Address[1], acPeer.Address[2], acPeer.Address[3], acPeer.Port);
+
+    return buffer;
+}
+
+static void Print(const ServerStatistics::Snapshot& acSnapshot)
+{
+    std::printf("tick %llu  interval %.3f ms  duration %.3f ms (max %.3f ms)\n",
+        (unsigned long long)acSnapshot.Tick, acSnapshot.TickInterval / 1e6, acSnapshot.TickDuration / 1e6, acSnapshot.MaxTickDuration / 1e6);
+    std::printf("packets %llu  shed %llu  queued %llu bytes  allocated %llu bytes  connections %u\n",
+        (unsigned long long)acSnapshot.ProcessedPackets, (unsigned long long)acSnapshot.ShedPackets,
+        (unsigned long long)acSnapshot.QueuedBytes, (unsigned long long)acSnapshot.AllocatedBytes, acSnapshot.ConnectionCount);
+
+    if (acSnapshot.ListedCount == 0)
+        return;
+
+    std::printf("%-48s %-12s %10s %12s %14s %12s %14s %10s\n", "remote", "state", "rtt ms", "sent", "sent bytes", "received", "received bytes", "dropped");
+    for (uint32_t i = 0; i < acSnapshot.ListedCount; ++i)
+    {
+        const auto& peer = acSnapshot.Connections[i];
+        std::printf("%-48s %-12s %10.3f %12llu %14llu %12llu %14llu %10llu\n",
+            FormatAddress(peer).c_str(), peer.State < 3 ? s_states[peer.State] : "?", peer.RoundTrip / 1e6,
+            (unsigned long long)peer.SentPackets, (unsigned long long)peer.SentBytes,
+            (unsigned long long)peer.ReceivedPackets, (unsigned long long)peer.ReceivedBytes, (unsigned long long)peer.DroppedPackets);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " <segment name> [refresh interval in ms]" << std::endl;
+        return 1;
+    }
+
+    ServerStatistics statistics;
+    if (!statistics.Open(argv[1]))
+    {
+        std::cerr << "Failed to open " << argv[1] << std::endl;
+        return 1;
+    }
+
+    const auto interval = argc > 2 ? std::atoi(argv[2]) : 0;
+
+    // Too large for the stack
+    auto pSnapshot = std::make_unique<ServerStatistics::Snapshot>();
+    uint64_t lastTick = 0;
+
+    do
+    {
+        if (!statistics.Read(*pSnapshot))
+        {
+            std::cerr << "The server is updating too fast to read a consistent snapshot" << std::endl;
+        }
+        else if (pSnapshot->Tick != lastTick || interval == 0)
+        {
+            lastTick = pSnapshot->Tick;
+            Print(*pSnapshot);
+            std::printf("\n");
+            std::fflush(stdout);
+        }
+
+        if (interval > 0)
+            std::this_thread::sleep_for(std::chrono::milliseconds(interval));
+    }
+    while (interval > 0);
+
+    return 0;
+}
\ No newline at end of file